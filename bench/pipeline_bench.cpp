@@ -0,0 +1,500 @@
+#include "provider_metrics.h"
+#include "settings_service.h"
+#include "srt_corpus.h"
+#include "srt_document.h"
+#include "srt_timing.h"
+#include "stub_provider.h"
+#include "text_to_speech_window.h"
+#include "translator_window.h"
+#include "ui_watchdog.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+constexpr int kSchemaVersion = 1;
+constexpr int kWatchdogIntervalMs = 50;
+constexpr int kDialogPollMs = 20;
+const QString kBenchToken = QStringLiteral("bench-token");
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+qint64 peakResidentBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(Q_OS_MACOS)
+    return static_cast<qint64>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+double percentileMs(const LatencyHistogram &histogram, double percentile)
+{
+    return static_cast<double>(histogram.value_at_percentile(percentile)) / 1000.0;
+}
+
+// Failed requests make the editor show a warning box; nobody is there to
+// click it, so boxes are closed as they appear and counted.
+class DialogDismisser
+{
+public:
+    DialogDismisser()
+    {
+        QObject::connect(&timer_, &QTimer::timeout, [this]() {
+            if (auto *box = qobject_cast<QMessageBox *>(QApplication::activeModalWidget()))
+            {
+                ++dismissed_;
+                box->done(QMessageBox::Ok);
+            }
+        });
+        timer_.start(kDialogPollMs);
+    }
+
+    int take()
+    {
+        return std::exchange(dismissed_, 0);
+    }
+
+private:
+    QTimer timer_;
+    int dismissed_ = 0;
+};
+
+struct WorkflowResult
+{
+    QString name;
+    int rows = 0;
+    int succeeded = 0;
+    bool completed = false;
+    double wallSeconds = 0.0;
+    // From dispatch to the result arriving on the GUI thread.
+    double latencyP50Ms = 0.0;
+    double latencyP95Ms = 0.0;
+    double latencyP99Ms = 0.0;
+    double latencyMaxMs = 0.0;
+    qint64 peakRssBytes = 0;
+    QJsonObject responsiveness;
+    int dialogsDismissed = 0;
+    std::uint64_t stubRequests = 0;
+    std::uint64_t injectedErrors = 0;
+    std::uint64_t injectedThrottles = 0;
+};
+
+// Times one batch from the click that starts it until the window reports
+// that nothing is queued or in flight, with a fresh watchdog on the GUI loop.
+class WorkflowRun
+{
+public:
+    WorkflowRun(const QString &name, int rows, int stallMs, const StubProvider &stub)
+        : stub_(stub),
+          requestsBefore_(stub.requests()),
+          errorsBefore_(stub.injected_errors()),
+          throttlesBefore_(stub.injected_throttles()),
+          watchdog_(std::make_unique<UiWatchdog>(kWatchdogIntervalMs, stallMs))
+    {
+        result_.name = name;
+        result_.rows = rows;
+        startedNs_.fill(-1, rows);
+        clock_.start();
+    }
+
+    void row_started(int row)
+    {
+        if (row >= 0 && row < startedNs_.size())
+        {
+            startedNs_[row] = clock_.nsecsElapsed();
+        }
+    }
+
+    void row_finished(int row, bool succeeded)
+    {
+        if (row >= 0 && row < startedNs_.size() && startedNs_.at(row) >= 0)
+        {
+            rowLatency_.record((clock_.nsecsElapsed() - startedNs_.at(row)) / 1000);
+        }
+        if (succeeded)
+        {
+            ++result_.succeeded;
+        }
+    }
+
+    // Runs the event loop until finished is emitted or timeoutMs passes.
+    // start connects the window's batch signal to the loop and clicks the
+    // button that starts the batch.
+    bool wait(const std::function<void(QEventLoop *)> &start, int timeoutMs, DialogDismisser *dialogs)
+    {
+        QEventLoop loop;
+        start(&loop);
+        QTimer::singleShot(timeoutMs, &loop, [&loop]() { loop.exit(1); });
+        result_.completed = loop.exec() == 0;
+
+        result_.wallSeconds = static_cast<double>(clock_.nsecsElapsed()) / 1e9;
+        result_.latencyP50Ms = percentileMs(rowLatency_, 50.0);
+        result_.latencyP95Ms = percentileMs(rowLatency_, 95.0);
+        result_.latencyP99Ms = percentileMs(rowLatency_, 99.0);
+        result_.latencyMaxMs = static_cast<double>(rowLatency_.max()) / 1000.0;
+        result_.peakRssBytes = peakResidentBytes();
+        result_.responsiveness = QJsonDocument::fromJson(watchdog_->report_json()).object();
+        result_.dialogsDismissed = dialogs->take();
+        result_.stubRequests = stub_.requests() - requestsBefore_;
+        result_.injectedErrors = stub_.injected_errors() - errorsBefore_;
+        result_.injectedThrottles = stub_.injected_throttles() - throttlesBefore_;
+        watchdog_.reset();
+        return result_.completed;
+    }
+
+    const WorkflowResult &result() const
+    {
+        return result_;
+    }
+
+private:
+    const StubProvider &stub_;
+    const std::uint64_t requestsBefore_;
+    const std::uint64_t errorsBefore_;
+    const std::uint64_t throttlesBefore_;
+    std::unique_ptr<UiWatchdog> watchdog_;
+    QElapsedTimer clock_;
+    QVector<qint64> startedNs_;
+    LatencyHistogram rowLatency_; // microseconds
+    WorkflowResult result_;
+};
+
+WorkflowResult runTranslation(const QStringList &sources,
+                              QStringList *translations,
+                              int stallMs,
+                              int timeoutMs,
+                              const StubProvider &stub,
+                              DialogDismisser *dialogs)
+{
+    TranslatorWindow window;
+    window.setSourceTexts(sources);
+    window.findChild<QLineEdit *>(QStringLiteral("srcLang"))->setText(QStringLiteral("English"));
+    window.findChild<QLineEdit *>(QStringLiteral("targetLang"))->setText(QStringLiteral("Vietnamese"));
+
+    WorkflowRun run(QStringLiteral("translate"), sources.size(), stallMs, stub);
+    QObject::connect(&window, &TranslatorWindow::translationStarted, [&run](int row) { run.row_started(row); });
+    // A failed request leaves the source text in place, so successes are
+    // counted from the targets once the batch is done.
+    QObject::connect(&window, &TranslatorWindow::translationFinished, [&run](int row) { run.row_finished(row, false); });
+
+    run.wait([&window](QEventLoop *loop) {
+        QObject::connect(&window, &TranslatorWindow::batchFinished, loop, &QEventLoop::quit);
+        window.findChild<QPushButton *>(QStringLiteral("btnTranslateAll"))->click();
+    }, timeoutMs, dialogs);
+
+    *translations = window.targetTexts();
+    WorkflowResult result = run.result();
+    for (int row = 0; row < sources.size(); ++row)
+    {
+        const QString target = translations->value(row);
+        if (!target.isEmpty() && target != sources.at(row))
+        {
+            ++result.succeeded;
+        }
+        else
+        {
+            (*translations)[row] = sources.at(row);
+        }
+    }
+    return result;
+}
+
+WorkflowResult runSpeech(const QVector<SrtCue> &cues,
+                         const QStringList &texts,
+                         int stallMs,
+                         int timeoutMs,
+                         const StubProvider &stub,
+                         DialogDismisser *dialogs)
+{
+    QVector<TextToSpeechWindow::Entry> entries;
+    entries.reserve(cues.size());
+    for (int row = 0; row < cues.size(); ++row)
+    {
+        const SrtCue &cue = cues.at(row);
+        TextToSpeechWindow::Entry entry;
+        entry.text = texts.value(row, cue.text);
+        entry.duration = SrtTiming::compute_duration_string(cue.start, cue.end);
+        entry.startMs = SrtTiming::parse_srt_timestamp(cue.start);
+        entry.slotMs = SrtTiming::parse_srt_timestamp(cue.end) - entry.startMs;
+        entries.append(entry);
+    }
+
+    TextToSpeechWindow window;
+    window.set_entries(entries);
+
+    WorkflowRun run(QStringLiteral("tts"), entries.size(), stallMs, stub);
+    QObject::connect(&window, &TextToSpeechWindow::conversion_started, [&run](int row) { run.row_started(row); });
+    QObject::connect(&window, &TextToSpeechWindow::conversion_finished, [&run](int row, bool succeeded) {
+        run.row_finished(row, succeeded);
+    });
+
+    run.wait([&window](QEventLoop *loop) {
+        QObject::connect(&window, &TextToSpeechWindow::batch_finished, loop, &QEventLoop::quit);
+        window.findChild<QPushButton *>(QStringLiteral("btnConvertAll"))->click();
+    }, timeoutMs, dialogs);
+
+    return run.result();
+}
+
+void printResult(const WorkflowResult &result)
+{
+    const QJsonObject lag = result.responsiveness.value(QStringLiteral("lagMs")).toObject();
+    out() << Qt::endl << result.name << (result.completed ? "" : "  (TIMED OUT)") << Qt::endl;
+    out() << QStringLiteral("  rows            %1 ok / %2").arg(result.succeeded).arg(result.rows) << Qt::endl;
+    out() << QStringLiteral("  throughput      %1 rows/s over %2 s")
+                 .arg(result.rows / std::max(result.wallSeconds, 1e-9), 0, 'f', 2)
+                 .arg(result.wallSeconds, 0, 'f', 2)
+          << Qt::endl;
+    out() << QStringLiteral("  row latency     p50 %1 ms, p95 %2 ms, p99 %3 ms, max %4 ms")
+                 .arg(result.latencyP50Ms, 0, 'f', 1)
+                 .arg(result.latencyP95Ms, 0, 'f', 1)
+                 .arg(result.latencyP99Ms, 0, 'f', 1)
+                 .arg(result.latencyMaxMs, 0, 'f', 1)
+          << Qt::endl;
+    out() << QStringLiteral("  GUI stalls      %1 totalling %2 ms, longest %3 ms, loop lag p99 %4 ms")
+                 .arg(result.responsiveness.value(QStringLiteral("stallCount")).toInt())
+                 .arg(result.responsiveness.value(QStringLiteral("stalledMs")).toInt())
+                 .arg(result.responsiveness.value(QStringLiteral("longestStallMs")).toInt())
+                 .arg(lag.value(QStringLiteral("p99")).toDouble(), 0, 'f', 1)
+          << Qt::endl;
+    out() << QStringLiteral("  peak RSS        %1 MiB").arg(result.peakRssBytes / (1024.0 * 1024.0), 0, 'f', 1) << Qt::endl;
+    out() << QStringLiteral("  provider        %1 requests, %2 injected errors, %3 throttled, %4 dialogs dismissed")
+                 .arg(result.stubRequests)
+                 .arg(result.injectedErrors)
+                 .arg(result.injectedThrottles)
+                 .arg(result.dialogsDismissed)
+          << Qt::endl;
+}
+
+QJsonObject toJson(const WorkflowResult &result)
+{
+    return QJsonObject{
+        {QStringLiteral("name"), result.name},
+        {QStringLiteral("completed"), result.completed},
+        {QStringLiteral("rows"), result.rows},
+        {QStringLiteral("succeeded"), result.succeeded},
+        {QStringLiteral("wallSeconds"), result.wallSeconds},
+        {QStringLiteral("rowsPerSecond"), result.rows / std::max(result.wallSeconds, 1e-9)},
+        {QStringLiteral("rowLatencyMs"), QJsonObject{{QStringLiteral("p50"), result.latencyP50Ms},
+                                                     {QStringLiteral("p95"), result.latencyP95Ms},
+                                                     {QStringLiteral("p99"), result.latencyP99Ms},
+                                                     {QStringLiteral("max"), result.latencyMaxMs}}},
+        {QStringLiteral("peakRssBytes"), result.peakRssBytes},
+        {QStringLiteral("gui"), QJsonObject{{QStringLiteral("stallCount"), result.responsiveness.value(QStringLiteral("stallCount"))},
+                                            {QStringLiteral("stalledMs"), result.responsiveness.value(QStringLiteral("stalledMs"))},
+                                            {QStringLiteral("longestStallMs"), result.responsiveness.value(QStringLiteral("longestStallMs"))},
+                                            {QStringLiteral("lagMs"), result.responsiveness.value(QStringLiteral("lagMs"))},
+                                            {QStringLiteral("byScope"), result.responsiveness.value(QStringLiteral("byScope"))}}},
+        {QStringLiteral("dialogsDismissed"), result.dialogsDismissed},
+        {QStringLiteral("provider"), QJsonObject{{QStringLiteral("requests"), static_cast<qint64>(result.stubRequests)},
+                                                 {QStringLiteral("injectedErrors"), static_cast<qint64>(result.injectedErrors)},
+                                                 {QStringLiteral("injectedThrottles"), static_cast<qint64>(result.injectedThrottles)}}}};
+}
+
+bool writeJson(const QString &path, const QJsonObject &root)
+{
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (path == QLatin1String("-"))
+    {
+        out() << json << Qt::flush;
+        return true;
+    }
+
+    QSaveFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(json) == json.size() && file.commit();
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication application(argc, argv);
+    // A settings file, clip cache and catalog of its own, so a run never
+    // touches the editor's configuration.
+    QCoreApplication::setOrganizationName(QStringLiteral("haidanghth910"));
+    QCoreApplication::setApplicationName(QStringLiteral("srt_pipeline_bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Times Translate All and Convert All against a local stand-in provider."));
+    parser.addHelpOption();
+    const QCommandLineOption rowsOption(QStringLiteral("rows"), QStringLiteral("Subtitle rows to process (default 200)."), QStringLiteral("count"), QStringLiteral("200"));
+    const QCommandLineOption workflowOption(QStringLiteral("workflow"), QStringLiteral("translate, tts or both (default both; tts then speaks the translations)."), QStringLiteral("name"), QStringLiteral("both"));
+    const QCommandLineOption translatorOption(QStringLiteral("translator"), QStringLiteral("OpenAI or \"Github Model\" (default OpenAI)."), QStringLiteral("provider"), QStringLiteral("OpenAI"));
+    const QCommandLineOption speechOption(QStringLiteral("speech"), QStringLiteral("OpenAI or ElevenLabs (default OpenAI)."), QStringLiteral("provider"), QStringLiteral("OpenAI"));
+    const QCommandLineOption latencyOption(QStringLiteral("latency-ms"), QStringLiteral("Mean provider response time (default 250)."), QStringLiteral("ms"), QStringLiteral("250"));
+    const QCommandLineOption jitterOption(QStringLiteral("jitter-ms"), QStringLiteral("Uniform spread around the latency (default 100)."), QStringLiteral("ms"), QStringLiteral("100"));
+    const QCommandLineOption errorRateOption(QStringLiteral("error-rate"), QStringLiteral("Share of requests answered with HTTP 500 (default 0)."), QStringLiteral("fraction"), QStringLiteral("0"));
+    const QCommandLineOption throttleRateOption(QStringLiteral("throttle-rate"), QStringLiteral("Share of requests answered with HTTP 429 (default 0)."), QStringLiteral("fraction"), QStringLiteral("0"));
+    const QCommandLineOption speechRateOption(QStringLiteral("speech-ms-per-char"), QStringLiteral("Length of synthesized audio per character (default 60)."), QStringLiteral("ms"), QStringLiteral("60"));
+    const QCommandLineOption stallOption(QStringLiteral("stall-ms"), QStringLiteral("GUI loop delay counted as a stall (default 100)."), QStringLiteral("ms"), QStringLiteral("100"));
+    const QCommandLineOption timeoutOption(QStringLiteral("timeout-s"), QStringLiteral("Give up on a workflow after this long (default 600)."), QStringLiteral("seconds"), QStringLiteral("600"));
+    const QCommandLineOption warmCacheOption(QStringLiteral("warm-cache"), QStringLiteral("Keep the clip cache from earlier runs instead of starting cold."));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed for the corpus and the injected failures (default 1)."), QStringLiteral("number"), QStringLiteral("1"));
+    const QCommandLineOption jsonOption(QStringLiteral("json"), QStringLiteral("Write results as JSON to <file> (\"-\" for stdout)."), QStringLiteral("file"));
+    parser.addOptions({rowsOption, workflowOption, translatorOption, speechOption, latencyOption, jitterOption,
+                       errorRateOption, throttleRateOption, speechRateOption, stallOption, timeoutOption,
+                       warmCacheOption, seedOption, jsonOption});
+    parser.process(application);
+
+    const QString workflow = parser.value(workflowOption).toLower();
+    const bool runTranslate = workflow == QLatin1String("translate") || workflow == QLatin1String("both");
+    const bool runTts = workflow == QLatin1String("tts") || workflow == QLatin1String("both");
+    if (!runTranslate && !runTts)
+    {
+        out() << "unknown workflow " << workflow << Qt::endl;
+        return 1;
+    }
+
+    StubProvider::Options stubOptions;
+    stubOptions.latencyMs = parser.value(latencyOption).toInt();
+    stubOptions.jitterMs = parser.value(jitterOption).toInt();
+    stubOptions.errorRate = std::clamp(parser.value(errorRateOption).toDouble(), 0.0, 1.0);
+    stubOptions.throttleRate = std::clamp(parser.value(throttleRateOption).toDouble(), 0.0, 1.0);
+    stubOptions.speechMsPerChar = std::max(parser.value(speechRateOption).toInt(), 1);
+    stubOptions.seed = parser.value(seedOption).toUInt();
+
+    StubProvider stub(stubOptions);
+    QString errorMessage;
+    if (!stub.start(&errorMessage))
+    {
+        out() << "cannot start the stand-in provider: " << errorMessage << Qt::endl;
+        return 1;
+    }
+
+    QTemporaryDir outputDir;
+    if (!outputDir.isValid())
+    {
+        out() << "cannot create a temporary directory" << Qt::endl;
+        return 1;
+    }
+    if (!parser.isSet(warmCacheOption))
+    {
+        QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+    }
+
+    // Every provider points at the stand-in; clips are WAV, the format the
+    // stand-in produces.
+    SettingsService &settings = SettingsService::instance();
+    settings.clear();
+    settings.set_value(QStringLiteral("endpoints/openai"), stub.base_url() + QStringLiteral("/v1"));
+    settings.set_value(QStringLiteral("endpoints/github"), stub.base_url());
+    settings.set_value(QStringLiteral("endpoints/elevenlabs"), stub.base_url() + QStringLiteral("/v1"));
+    settings.set_value(QStringLiteral("ai/lang/provider"), parser.value(translatorOption));
+    settings.set_value(QStringLiteral("ai/lang/apiKey"), kBenchToken);
+    settings.set_value(QStringLiteral("ai/audio/provider"), parser.value(speechOption));
+    settings.set_value(QStringLiteral("ai/audio/apiKey"), kBenchToken);
+    settings.set_value(QStringLiteral("tts/general/output_format"), QStringLiteral("wav"));
+    settings.set_value(QStringLiteral("tts/general/output_directory"), outputDir.path());
+
+    SrtCorpus::Options corpus;
+    corpus.cueCount = std::max(parser.value(rowsOption).toInt(), 1);
+    corpus.seed = stubOptions.seed;
+    const QVector<SrtCue> cues = SrtDocument::parse(SrtCorpus::generate(corpus));
+    QStringList texts;
+    for (const SrtCue &cue : cues)
+    {
+        texts.append(cue.text);
+    }
+
+    const int stallMs = std::max(parser.value(stallOption).toInt(), kWatchdogIntervalMs);
+    const int timeoutMs = std::max(parser.value(timeoutOption).toInt(), 1) * 1000;
+    DialogDismisser dialogs;
+    QVector<WorkflowResult> results;
+
+    out() << "stand-in provider at " << stub.base_url() << ", " << cues.size() << " rows" << Qt::endl;
+    if (runTranslate)
+    {
+        QStringList translations;
+        results.append(runTranslation(texts, &translations, stallMs, timeoutMs, stub, &dialogs));
+        printResult(results.last());
+        texts = translations;
+    }
+    if (runTts)
+    {
+        results.append(runSpeech(cues, texts, stallMs, timeoutMs, stub, &dialogs));
+        printResult(results.last());
+    }
+
+    if (parser.isSet(jsonOption))
+    {
+        QJsonArray workflows;
+        for (const WorkflowResult &result : results)
+        {
+            workflows.append(toJson(result));
+        }
+        const QJsonObject options{{QStringLiteral("rows"), cues.size()},
+                                  {QStringLiteral("translator"), parser.value(translatorOption)},
+                                  {QStringLiteral("speech"), parser.value(speechOption)},
+                                  {QStringLiteral("latencyMs"), stubOptions.latencyMs},
+                                  {QStringLiteral("jitterMs"), stubOptions.jitterMs},
+                                  {QStringLiteral("errorRate"), stubOptions.errorRate},
+                                  {QStringLiteral("throttleRate"), stubOptions.throttleRate},
+                                  {QStringLiteral("warmCache"), parser.isSet(warmCacheOption)},
+                                  {QStringLiteral("seed"), static_cast<qint64>(stubOptions.seed)}};
+        const QJsonObject root{{QStringLiteral("schema"), kSchemaVersion},
+                               {QStringLiteral("createdAt"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+                               {QStringLiteral("options"), options},
+                               {QStringLiteral("workflows"), workflows}};
+        if (!writeJson(parser.value(jsonOption), root))
+        {
+            out() << "cannot write " << parser.value(jsonOption) << Qt::endl;
+            return 1;
+        }
+    }
+
+    stub.stop();
+    const bool allCompleted = std::all_of(results.cbegin(), results.cend(), [](const WorkflowResult &result) {
+        return result.completed;
+    });
+    return allCompleted ? 0 : 2;
+}
@@ -0,0 +1,479 @@
+#include "srt_corpus.h"
+#include "srt_document.h"
+#include "srt_timing.h"
+#include "subtitle_table.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTableWidget>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+
+namespace
+{
+constexpr int kSchemaVersion = 1;
+constexpr int kMicroInputCount = 4096;
+
+// Results are folded into this so the optimizer cannot drop the work.
+volatile qint64 blackHole = 0;
+
+struct BenchConfig
+{
+    qint64 minTimeNs = 300LL * 1000 * 1000;
+    int samples = 11;
+    QString filter;
+};
+
+struct BenchResult
+{
+    QString name;
+    qint64 iterations = 0; // per sample
+    int samples = 0;
+    double medianNs = 0.0;
+    double minNs = 0.0;
+    double p90Ns = 0.0;
+    qint64 itemsPerOp = 0;
+    qint64 bytesPerOp = 0;
+};
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+// Calibrates an iteration count so each sample takes about
+// minTime / samples, then reports per-operation times over the samples.
+BenchResult measure(const BenchConfig &config,
+                    const QString &name,
+                    qint64 itemsPerOp,
+                    qint64 bytesPerOp,
+                    const std::function<void()> &operation)
+{
+    QElapsedTimer timer;
+    timer.start();
+    operation(); // warm-up, also the calibration probe
+    const qint64 probeNs = std::max<qint64>(timer.nsecsElapsed(), 1);
+
+    const qint64 sampleTargetNs = std::max<qint64>(config.minTimeNs / config.samples, 1);
+    const qint64 iterations = std::max<qint64>(1, sampleTargetNs / probeNs);
+
+    QVector<double> perOp;
+    perOp.reserve(config.samples);
+    for (int sample = 0; sample < config.samples; ++sample)
+    {
+        timer.restart();
+        for (qint64 i = 0; i < iterations; ++i)
+        {
+            operation();
+        }
+        perOp.append(static_cast<double>(timer.nsecsElapsed()) / static_cast<double>(iterations));
+    }
+    std::sort(perOp.begin(), perOp.end());
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.samples = config.samples;
+    result.medianNs = perOp.at(perOp.size() / 2);
+    result.minNs = perOp.first();
+    result.p90Ns = perOp.at(std::min<int>(perOp.size() - 1, static_cast<int>(perOp.size() * 9 / 10)));
+    result.itemsPerOp = itemsPerOp;
+    result.bytesPerOp = bytesPerOp;
+    return result;
+}
+
+QString formatNs(double ns)
+{
+    if (ns < 1e3)
+    {
+        return QStringLiteral("%1 ns").arg(ns, 0, 'f', 1);
+    }
+    if (ns < 1e6)
+    {
+        return QStringLiteral("%1 us").arg(ns / 1e3, 0, 'f', 2);
+    }
+    if (ns < 1e9)
+    {
+        return QStringLiteral("%1 ms").arg(ns / 1e6, 0, 'f', 2);
+    }
+    return QStringLiteral("%1 s").arg(ns / 1e9, 0, 'f', 3);
+}
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(const BenchConfig &config)
+        : config_(config)
+    {
+    }
+
+    void run(const QString &name, qint64 itemsPerOp, qint64 bytesPerOp, const std::function<void()> &operation)
+    {
+        if (!config_.filter.isEmpty() && !name.contains(config_.filter))
+        {
+            return;
+        }
+
+        const BenchResult result = measure(config_, name, itemsPerOp, bytesPerOp, operation);
+        out() << QStringLiteral("%1 %2  (min %3, p90 %4)")
+                     .arg(result.name, -48)
+                     .arg(formatNs(result.medianNs), 12)
+                     .arg(formatNs(result.minNs), formatNs(result.p90Ns))
+              << Qt::endl;
+        results_.append(result);
+    }
+
+    const QVector<BenchResult> &results() const
+    {
+        return results_;
+    }
+
+private:
+    BenchConfig config_;
+    QVector<BenchResult> results_;
+};
+
+void runTimingBenchmarks(BenchRunner &runner)
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<qint64> anyTime(0, SrtTiming::kMillisecondsPerDay - 1);
+    std::uniform_int_distribution<qint64> shortSpan(0, 10 * 1000);
+
+    QVector<QString> timestamps;
+    QVector<QString> ends;
+    QVector<qint64> milliseconds;
+    QVector<QString> durations;
+    for (int i = 0; i < kMicroInputCount; ++i)
+    {
+        const qint64 start = anyTime(random);
+        const qint64 span = shortSpan(random);
+        milliseconds.append(start);
+        timestamps.append(SrtTiming::milliseconds_to_srt(start));
+        ends.append(SrtTiming::milliseconds_to_srt(start + span));
+
+        // The shapes the TTS window and users actually type.
+        switch (i % 4)
+        {
+        case 0:
+            durations.append(SrtTiming::milliseconds_to_srt(span).replace(QLatin1Char(','), QLatin1Char('.')));
+            break;
+        case 1:
+            durations.append(SrtTiming::milliseconds_to_srt(span).mid(3));
+            break;
+        case 2:
+            durations.append(QStringLiteral("%1.%2s").arg(span / 1000).arg(span % 1000 / 10));
+            break;
+        default:
+            durations.append(QStringLiteral("%1 s").arg(span / 1000));
+            break;
+        }
+    }
+
+    int next = 0;
+    auto advance = [&next]() {
+        next = (next + 1) % kMicroInputCount;
+        return next;
+    };
+
+    runner.run(QStringLiteral("timing/parse_srt_timestamp"), 1, 0, [&]() {
+        blackHole = blackHole + SrtTiming::parse_srt_timestamp(timestamps.at(advance()));
+    });
+    runner.run(QStringLiteral("timing/parse_flexible_duration"), 1, 0, [&]() {
+        blackHole = blackHole + SrtTiming::parse_flexible_duration(durations.at(advance()));
+    });
+    runner.run(QStringLiteral("timing/milliseconds_to_srt"), 1, 0, [&]() {
+        blackHole = blackHole + SrtTiming::milliseconds_to_srt(milliseconds.at(advance())).size();
+    });
+    runner.run(QStringLiteral("timing/compute_duration_string"), 1, 0, [&]() {
+        const int index = advance();
+        blackHole = blackHole + SrtTiming::compute_duration_string(timestamps.at(index), ends.at(index)).size();
+    });
+}
+
+void runDocumentBenchmarks(BenchRunner &runner, const QVector<int> &sizes, const QString &workDir)
+{
+    for (const int size : sizes)
+    {
+        for (const SrtCorpus::Script script : {SrtCorpus::Script::Ascii, SrtCorpus::Script::Multibyte})
+        {
+            for (const bool crlf : {false, true})
+            {
+                SrtCorpus::Options options;
+                options.cueCount = size;
+                options.crlf = crlf;
+                options.script = script;
+
+                const QString label = SrtCorpus::describe(options);
+                const QString content = SrtCorpus::generate(options);
+                const QByteArray encoded = content.toUtf8();
+                const QVector<SrtCue> cues = SrtDocument::parse(content);
+
+                const QString inputPath = QDir(workDir).filePath(label + QStringLiteral(".srt"));
+                const QString outputPath = QDir(workDir).filePath(label + QStringLiteral(".out.srt"));
+                QFile input(inputPath);
+                if (!input.open(QIODevice::WriteOnly) || input.write(encoded) != encoded.size())
+                {
+                    out() << "cannot write " << inputPath << Qt::endl;
+                    continue;
+                }
+                input.close();
+
+                const qint64 bytes = encoded.size();
+                runner.run(QStringLiteral("document/parse/") + label, size, bytes, [&]() {
+                    blackHole = blackHole + SrtDocument::parse(content).size();
+                });
+                runner.run(QStringLiteral("document/load/") + label, size, bytes, [&]() {
+                    QVector<SrtCue> loaded;
+                    SrtDocument::read_file(inputPath, &loaded, nullptr);
+                    blackHole = blackHole + loaded.size();
+                });
+                runner.run(QStringLiteral("document/serialize/") + label, size, bytes, [&]() {
+                    blackHole = blackHole + SrtDocument::serialize(cues).size();
+                });
+                runner.run(QStringLiteral("document/save/") + label, size, bytes, [&]() {
+                    blackHole = blackHole + (SrtDocument::write_file(outputPath, cues, nullptr) ? 1 : 0);
+                });
+
+                // The table never sees line endings, so one variant is enough.
+                if (crlf)
+                {
+                    QTableWidget table(0, 4);
+                    runner.run(QStringLiteral("table/populate/") + label, size, 0, [&]() {
+                        SubtitleTable::populate(&table, cues);
+                        blackHole = blackHole + table.rowCount();
+                    });
+                }
+            }
+        }
+    }
+}
+
+QJsonObject toJson(const QVector<BenchResult> &results)
+{
+    QJsonArray list;
+    for (const BenchResult &result : results)
+    {
+        QJsonObject entry{{QStringLiteral("name"), result.name},
+                          {QStringLiteral("iterations"), result.iterations},
+                          {QStringLiteral("samples"), result.samples},
+                          {QStringLiteral("medianNs"), result.medianNs},
+                          {QStringLiteral("minNs"), result.minNs},
+                          {QStringLiteral("p90Ns"), result.p90Ns}};
+        if (result.itemsPerOp > 0)
+        {
+            entry.insert(QStringLiteral("itemsPerSecond"), result.itemsPerOp * 1e9 / result.medianNs);
+        }
+        if (result.bytesPerOp > 0)
+        {
+            entry.insert(QStringLiteral("bytesPerSecond"), result.bytesPerOp * 1e9 / result.medianNs);
+        }
+        list.append(entry);
+    }
+
+    return QJsonObject{{QStringLiteral("schema"), kSchemaVersion},
+                       {QStringLiteral("createdAt"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+                       {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+                       {QStringLiteral("results"), list}};
+}
+
+bool writeJson(const QString &path, const QJsonObject &root)
+{
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (path == QLatin1String("-"))
+    {
+        out() << json << Qt::flush;
+        return true;
+    }
+
+    QSaveFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(json) == json.size() && file.commit();
+}
+
+// Compares medians with a stored run. Returns the number of benchmarks that
+// got slower by more than thresholdPercent, or -1 if the baseline is unusable.
+int compareWithBaseline(const QVector<BenchResult> &results, const QString &baselinePath, double thresholdPercent)
+{
+    QFile file(baselinePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        out() << "cannot read baseline " << baselinePath << ": " << file.errorString() << Qt::endl;
+        return -1;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("schema")).toInt() != kSchemaVersion)
+    {
+        out() << "baseline " << baselinePath << " has an unsupported schema" << Qt::endl;
+        return -1;
+    }
+
+    QHash<QString, double> baseline;
+    for (const QJsonValue &value : root.value(QStringLiteral("results")).toArray())
+    {
+        const QJsonObject entry = value.toObject();
+        baseline.insert(entry.value(QStringLiteral("name")).toString(), entry.value(QStringLiteral("medianNs")).toDouble());
+    }
+
+    out() << Qt::endl << "Compared with " << baselinePath << " (threshold " << thresholdPercent << "%)" << Qt::endl;
+    int regressions = 0;
+    for (const BenchResult &result : results)
+    {
+        const double before = baseline.value(result.name, 0.0);
+        if (before <= 0.0)
+        {
+            out() << QStringLiteral("  %1 new").arg(result.name, -48) << Qt::endl;
+            continue;
+        }
+
+        const double change = (result.medianNs - before) / before * 100.0;
+        QString verdict;
+        if (change > thresholdPercent)
+        {
+            verdict = QStringLiteral("REGRESSION");
+            ++regressions;
+        }
+        else if (change < -thresholdPercent)
+        {
+            verdict = QStringLiteral("improved");
+        }
+        out() << QStringLiteral("  %1 %2 -> %3  %4%5%  %6")
+                     .arg(result.name, -48)
+                     .arg(formatNs(before), 12)
+                     .arg(formatNs(result.medianNs), 12)
+                     .arg(change >= 0.0 ? QStringLiteral("+") : QString())
+                     .arg(change, 0, 'f', 1)
+                     .arg(verdict)
+              << Qt::endl;
+    }
+    return regressions;
+}
+
+bool generateCorpus(const QString &directory, const QVector<int> &sizes)
+{
+    if (!QDir().mkpath(directory))
+    {
+        return false;
+    }
+
+    for (const int size : sizes)
+    {
+        for (const SrtCorpus::Script script : {SrtCorpus::Script::Ascii, SrtCorpus::Script::Multibyte})
+        {
+            for (const bool crlf : {false, true})
+            {
+                SrtCorpus::Options options;
+                options.cueCount = size;
+                options.crlf = crlf;
+                options.script = script;
+
+                QSaveFile file(QDir(directory).filePath(SrtCorpus::describe(options) + QStringLiteral(".srt")));
+                const QByteArray encoded = SrtCorpus::generate(options).toUtf8();
+                if (!file.open(QIODevice::WriteOnly) || file.write(encoded) != encoded.size() || !file.commit())
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Table population needs widgets but never a display.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication application(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("srt_bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmarks for SRT timing, document and table code."));
+    parser.addHelpOption();
+    const QCommandLineOption jsonOption(QStringLiteral("json"), QStringLiteral("Write results as JSON to <file> (\"-\" for stdout)."), QStringLiteral("file"));
+    const QCommandLineOption baselineOption(QStringLiteral("baseline"), QStringLiteral("Compare medians with a previous --json run."), QStringLiteral("file"));
+    const QCommandLineOption thresholdOption(QStringLiteral("threshold"), QStringLiteral("Slowdown in percent reported as a regression (default 10)."), QStringLiteral("percent"), QStringLiteral("10"));
+    const QCommandLineOption filterOption(QStringLiteral("filter"), QStringLiteral("Only run benchmarks whose name contains <text>."), QStringLiteral("text"));
+    const QCommandLineOption minTimeOption(QStringLiteral("min-time"), QStringLiteral("Measured time per benchmark in ms (default 300)."), QStringLiteral("ms"), QStringLiteral("300"));
+    const QCommandLineOption samplesOption(QStringLiteral("samples"), QStringLiteral("Samples per benchmark (default 11)."), QStringLiteral("count"), QStringLiteral("11"));
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"), QStringLiteral("Comma-separated cue counts for document benchmarks (default 100,1000,10000)."), QStringLiteral("list"), QStringLiteral("100,1000,10000"));
+    const QCommandLineOption generateOption(QStringLiteral("generate-corpus"), QStringLiteral("Write the synthetic corpus to <dir> and exit."), QStringLiteral("dir"));
+    parser.addOptions({jsonOption, baselineOption, thresholdOption, filterOption, minTimeOption, samplesOption, sizesOption, generateOption});
+    parser.process(application);
+
+    QVector<int> sizes;
+    for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), Qt::SkipEmptyParts))
+    {
+        const int count = size.trimmed().toInt();
+        if (count > 0)
+        {
+            sizes.append(count);
+        }
+    }
+
+    if (parser.isSet(generateOption))
+    {
+        const QString directory = parser.value(generateOption);
+        if (!generateCorpus(directory, sizes))
+        {
+            out() << "cannot write corpus to " << directory << Qt::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    BenchConfig config;
+    config.minTimeNs = std::max(1LL, parser.value(minTimeOption).toLongLong()) * 1000 * 1000;
+    config.samples = std::max(1, parser.value(samplesOption).toInt());
+    config.filter = parser.value(filterOption);
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid())
+    {
+        out() << "cannot create a temporary directory" << Qt::endl;
+        return 1;
+    }
+
+    BenchRunner runner(config);
+    runTimingBenchmarks(runner);
+    runDocumentBenchmarks(runner, sizes, workDir.path());
+
+    if (parser.isSet(jsonOption) && !writeJson(parser.value(jsonOption), toJson(runner.results())))
+    {
+        out() << "cannot write " << parser.value(jsonOption) << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet(baselineOption))
+    {
+        const int regressions = compareWithBaseline(runner.results(),
+                                                    parser.value(baselineOption),
+                                                    parser.value(thresholdOption).toDouble());
+        if (regressions < 0)
+        {
+            return 1;
+        }
+        if (regressions > 0)
+        {
+            out() << regressions << " benchmark(s) regressed" << Qt::endl;
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "srt_corpus.h"
+
+#include "srt_timing.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+const QStringList &asciiWords()
+{
+    static const QStringList words = {
+        QStringLiteral("the"), QStringLiteral("quick"), QStringLiteral("brown"), QStringLiteral("fox"),
+        QStringLiteral("jumps"), QStringLiteral("over"), QStringLiteral("lazy"), QStringLiteral("dog"),
+        QStringLiteral("subtitle"), QStringLiteral("timing"), QStringLiteral("careful"), QStringLiteral("listen"),
+        QStringLiteral("where"), QStringLiteral("are"), QStringLiteral("you"), QStringLiteral("going"),
+        QStringLiteral("tonight?"), QStringLiteral("I"), QStringLiteral("don't"), QStringLiteral("know."),
+        QStringLiteral("Wait!"), QStringLiteral("<i>music</i>"), QStringLiteral("[laughs]"), QStringLiteral("okay,")};
+    return words;
+}
+
+const QStringList &multibyteWords()
+{
+    static const QStringList words = {
+        QStringLiteral("xin"), QStringLiteral("chào"), QStringLiteral("Việt"), QStringLiteral("Nam"),
+        QStringLiteral("người"), QStringLiteral("được"), QStringLiteral("phụ"), QStringLiteral("đề"),
+        QStringLiteral("こんにちは"), QStringLiteral("字幕"), QStringLiteral("時間"), QStringLiteral("世界"),
+        QStringLiteral("привет"), QStringLiteral("мир"), QStringLiteral("café"), QStringLiteral("naïve"),
+        QStringLiteral("😀"), QStringLiteral("🎬"), QStringLiteral("hello"), QStringLiteral("world"),
+        QStringLiteral("안녕하세요"), QStringLiteral("سلام"), QStringLiteral("Straße"), QStringLiteral("¿qué?")};
+    return words;
+}
+} // namespace
+
+QString SrtCorpus::generate(const Options &options)
+{
+    std::mt19937 random(options.seed);
+    std::uniform_int_distribution<int> gapMs(0, 1500);
+    std::uniform_int_distribution<int> lengthMs(700, 6000);
+    std::uniform_int_distribution<int> lineCount(1, std::max(options.maxLinesPerCue, 1));
+    std::uniform_int_distribution<int> wordCount(1, std::max(options.maxWordsPerLine, 1));
+
+    const QStringList &words = options.script == Script::Multibyte ? multibyteWords() : asciiWords();
+    std::uniform_int_distribution<int> wordIndex(0, static_cast<int>(words.size()) - 1);
+    const QString newline = options.crlf ? QStringLiteral("\r\n") : QStringLiteral("\n");
+
+    QString output;
+    if (options.byteOrderMark)
+    {
+        output += QChar(0xFEFF);
+    }
+
+    qint64 cursorMs = 0;
+    for (int cue = 1; cue <= options.cueCount; ++cue)
+    {
+        cursorMs += gapMs(random);
+        const qint64 startMs = cursorMs;
+        cursorMs += lengthMs(random);
+
+        output += QString::number(cue) + newline;
+        output += SrtTiming::milliseconds_to_srt(startMs) + QStringLiteral(" --> ") +
+                  SrtTiming::milliseconds_to_srt(cursorMs) + newline;
+
+        const int lines = lineCount(random);
+        for (int line = 0; line < lines; ++line)
+        {
+            const int count = wordCount(random);
+            for (int word = 0; word < count; ++word)
+            {
+                if (word > 0)
+                {
+                    output += QLatin1Char(' ');
+                }
+                output += words.at(wordIndex(random));
+            }
+            output += newline;
+        }
+        output += newline;
+    }
+    return output;
+}
+
+QString SrtCorpus::describe(const Options &options)
+{
+    return QStringLiteral("%1cues-%2-%3")
+        .arg(options.cueCount)
+        .arg(options.crlf ? QStringLiteral("crlf") : QStringLiteral("lf"))
+        .arg(options.script == Script::Multibyte ? QStringLiteral("multibyte") : QStringLiteral("ascii"));
+}
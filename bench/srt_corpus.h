@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef __SRT_CORPUS_H__
+#define __SRT_CORPUS_H__
+
+#include <QString>
+
+// Deterministic synthetic SRT files for benchmarking. The same options and
+// seed always produce the same document, so runs stay comparable.
+class SrtCorpus
+{
+public:
+    enum class Script
+    {
+        Ascii,
+        // Mix of Latin with diacritics, CJK, Cyrillic and emoji, so UTF-8
+        // decoding sees 2-, 3- and 4-byte sequences.
+        Multibyte
+    };
+
+    struct Options
+    {
+        int cueCount = 1000;
+        bool crlf = true;
+        Script script = Script::Ascii;
+        int maxLinesPerCue = 2;
+        int maxWordsPerLine = 9;
+        bool byteOrderMark = false;
+        unsigned seed = 1;
+    };
+
+    static QString generate(const Options &options);
+    // Short label such as "1000cues-crlf-multibyte" used in benchmark names.
+    static QString describe(const Options &options);
+};
+
+#endif
@@ -0,0 +1,312 @@
+#include "stub_provider.h"
+
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int kSpeechSampleRate = 24000; // matches the PCM rate the editor asks for
+constexpr int kMinSpeechMs = 200;
+constexpr double kToneHz = 220.0;
+constexpr double kToneAmplitude = 0.3;
+constexpr double kPi = 3.14159265358979323846;
+
+QByteArray jsonBody(const QJsonObject &object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return QByteArrayLiteral("OK");
+    case 400:
+        return QByteArrayLiteral("Bad Request");
+    case 404:
+        return QByteArrayLiteral("Not Found");
+    case 429:
+        return QByteArrayLiteral("Too Many Requests");
+    default:
+        return QByteArrayLiteral("Internal Server Error");
+    }
+}
+} // namespace
+
+StubProvider::StubProvider(const Options &options)
+    : options_(options), random_(options.seed)
+{
+    thread_.setObjectName(QStringLiteral("stub-provider"));
+}
+
+StubProvider::~StubProvider()
+{
+    stop();
+}
+
+bool StubProvider::start(QString *errorMessage)
+{
+    thread_.start();
+    context_ = new QObject;
+    context_->moveToThread(&thread_);
+
+    bool listening = false;
+    QString listenError;
+    QMetaObject::invokeMethod(
+        context_,
+        [this, &listening, &listenError]() {
+            server_ = new QTcpServer(context_);
+            QObject::connect(server_, &QTcpServer::newConnection, context_, [this]() { accept_pending(); });
+            listening = server_->listen(QHostAddress::LocalHost, 0);
+            if (listening)
+            {
+                port_ = server_->serverPort();
+            }
+            else
+            {
+                listenError = server_->errorString();
+            }
+        },
+        Qt::BlockingQueuedConnection);
+
+    if (!listening)
+    {
+        stop();
+        if (errorMessage)
+        {
+            *errorMessage = listenError;
+        }
+        return false;
+    }
+    return true;
+}
+
+void StubProvider::stop()
+{
+    if (!thread_.isRunning())
+    {
+        return;
+    }
+
+    // Deferred deletes still run when the thread finishes, so the server and
+    // its sockets are torn down on the thread that owns them.
+    QObject *context = context_;
+    QMetaObject::invokeMethod(context, [context]() { context->deleteLater(); }, Qt::BlockingQueuedConnection);
+    context_ = nullptr;
+    server_ = nullptr;
+    thread_.quit();
+    thread_.wait();
+}
+
+QString StubProvider::base_url() const
+{
+    return QStringLiteral("http://127.0.0.1:%1").arg(port_);
+}
+
+void StubProvider::accept_pending()
+{
+    while (QTcpSocket *socket = server_->nextPendingConnection())
+    {
+        QObject::connect(socket, &QTcpSocket::readyRead, context_, [this, socket]() { read_request(socket); });
+        QObject::connect(socket, &QTcpSocket::disconnected, context_, [this, socket]() {
+            pending_.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void StubProvider::read_request(QTcpSocket *socket)
+{
+    QByteArray &buffer = pending_[socket];
+    buffer += socket->readAll();
+
+    const int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+    {
+        return;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    qint64 contentLength = 0;
+    bool expectsContinue = false;
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        const QByteArray line = lines.at(i).trimmed();
+        const int colon = line.indexOf(':');
+        if (colon <= 0)
+        {
+            continue;
+        }
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        if (name == "content-length")
+        {
+            contentLength = value.toLongLong();
+        }
+        else if (name == "expect" && value.toLower() == "100-continue")
+        {
+            expectsContinue = true;
+        }
+    }
+
+    const qint64 bodyStart = headerEnd + 4;
+    if (buffer.size() - bodyStart < contentLength)
+    {
+        if (expectsContinue && !socket->property("continued").toBool())
+        {
+            socket->setProperty("continued", true);
+            socket->write("HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        return;
+    }
+
+    Request request;
+    request.method = requestLine.value(0);
+    request.path = requestLine.value(1);
+    request.body = buffer.mid(static_cast<int>(bodyStart), static_cast<int>(contentLength));
+    pending_.remove(socket);
+    requests_.fetch_add(1, std::memory_order_relaxed);
+
+    // The reply is parked on a timer, so slow responses overlap the way they
+    // would against a real provider.
+    const QByteArray response = serialize(route(request));
+    QTimer::singleShot(next_delay_ms(), socket, [socket, response]() {
+        socket->write(response);
+        socket->disconnectFromHost();
+    });
+}
+
+StubProvider::Reply StubProvider::route(const Request &request)
+{
+    const int query = request.path.indexOf('?');
+    const QByteArray path = query < 0 ? request.path : request.path.left(query);
+
+    if (request.method == "POST")
+    {
+        // Only work requests fail; catalog lookups stay reliable so every run
+        // starts from the same state.
+        const double roll = std::uniform_real_distribution<double>(0.0, 1.0)(random_);
+        if (roll < options_.throttleRate)
+        {
+            injectedThrottles_.fetch_add(1, std::memory_order_relaxed);
+            return {429, QByteArrayLiteral("application/json"),
+                    jsonBody({{QStringLiteral("error"), QJsonObject{{QStringLiteral("message"), QStringLiteral("Rate limit reached")}}}})};
+        }
+        if (roll < options_.throttleRate + options_.errorRate)
+        {
+            injectedErrors_.fetch_add(1, std::memory_order_relaxed);
+            return {500, QByteArrayLiteral("application/json"),
+                    jsonBody({{QStringLiteral("error"), QJsonObject{{QStringLiteral("message"), QStringLiteral("Injected failure")}}}})};
+        }
+
+        if (path.endsWith("/chat/completions"))
+        {
+            return chat_completion(request.body);
+        }
+        if (path.endsWith("/audio/speech"))
+        {
+            return speech(request.body, QStringLiteral("input"));
+        }
+        if (path.contains("/text-to-speech/"))
+        {
+            return speech(request.body, QStringLiteral("text"));
+        }
+    }
+    else if (request.method == "GET")
+    {
+        if (path.endsWith("/catalog/models"))
+        {
+            const QJsonArray models{QJsonObject{{QStringLiteral("id"), QStringLiteral("openai/gpt-4o-mini")},
+                                                {QStringLiteral("supported_output_modalities"), QJsonArray{QStringLiteral("text")}}}};
+            return {200, QByteArrayLiteral("application/json"), QJsonDocument(models).toJson(QJsonDocument::Compact)};
+        }
+        if (path.endsWith("/models"))
+        {
+            // One body serves both the OpenAI and the ElevenLabs model lists.
+            return {200, QByteArrayLiteral("application/json"),
+                    jsonBody({{QStringLiteral("data"), QJsonArray{QJsonObject{{QStringLiteral("id"), QStringLiteral("gpt-4o-mini")}}}},
+                              {QStringLiteral("models"), QJsonArray{QJsonObject{{QStringLiteral("model_id"), QStringLiteral("eleven_turbo_v2")}}}}})};
+        }
+        if (path.endsWith("/voices"))
+        {
+            return {200, QByteArrayLiteral("application/json"),
+                    jsonBody({{QStringLiteral("voices"), QJsonArray{QJsonObject{{QStringLiteral("voice_id"), QStringLiteral("stub-voice")}}}}})};
+        }
+    }
+
+    return {404, QByteArrayLiteral("application/json"),
+            jsonBody({{QStringLiteral("error"), QJsonObject{{QStringLiteral("message"), QStringLiteral("Unknown endpoint")}}}})};
+}
+
+StubProvider::Reply StubProvider::chat_completion(const QByteArray &body) const
+{
+    const QJsonArray messages = QJsonDocument::fromJson(body).object().value(QStringLiteral("messages")).toArray();
+    if (messages.isEmpty())
+    {
+        return {400, QByteArrayLiteral("application/json"), jsonBody({{QStringLiteral("error"), QStringLiteral("no messages")}})};
+    }
+
+    // The editor's prompt is one instruction line followed by the text.
+    const QString prompt = messages.last().toObject().value(QStringLiteral("content")).toString();
+    const QString text = prompt.section(QLatin1Char('\n'), 1);
+    const QString translated = QStringLiteral("(translated) ") + text;
+
+    const QJsonObject message{{QStringLiteral("role"), QStringLiteral("assistant")},
+                              {QStringLiteral("content"), translated}};
+    const QJsonObject usage{{QStringLiteral("prompt_tokens"), prompt.size() / 4 + 1},
+                            {QStringLiteral("completion_tokens"), translated.size() / 4 + 1}};
+    return {200, QByteArrayLiteral("application/json"),
+            jsonBody({{QStringLiteral("choices"), QJsonArray{QJsonObject{{QStringLiteral("index"), 0},
+                                                                         {QStringLiteral("message"), message}}}},
+                      {QStringLiteral("usage"), usage}})};
+}
+
+StubProvider::Reply StubProvider::speech(const QByteArray &body, const QString &textField) const
+{
+    const QString text = QJsonDocument::fromJson(body).object().value(textField).toString();
+    if (text.isEmpty())
+    {
+        return {400, QByteArrayLiteral("application/json"), jsonBody({{QStringLiteral("error"), QStringLiteral("no text")}})};
+    }
+
+    // Raw 16-bit mono PCM, which the editor wraps into WAV. A tone rather
+    // than silence, so trimming and loudness stages do real work.
+    const int durationMs = std::max(kMinSpeechMs, static_cast<int>(text.size()) * options_.speechMsPerChar);
+    const int samples = static_cast<int>(static_cast<qint64>(kSpeechSampleRate) * durationMs / 1000);
+    QByteArray pcm(samples * 2, Qt::Uninitialized);
+    for (int i = 0; i < samples; ++i)
+    {
+        const double value = kToneAmplitude * std::sin(2.0 * kPi * kToneHz * i / kSpeechSampleRate);
+        const auto sample = static_cast<qint16>(std::lround(value * 32767.0));
+        pcm[2 * i] = static_cast<char>(sample & 0xff);
+        pcm[2 * i + 1] = static_cast<char>((sample >> 8) & 0xff);
+    }
+    return {200, QByteArrayLiteral("audio/pcm"), pcm};
+}
+
+int StubProvider::next_delay_ms()
+{
+    const int jitter = std::max(options_.jitterMs, 0);
+    const int offset = jitter > 0 ? std::uniform_int_distribution<int>(-jitter, jitter)(random_) : 0;
+    return std::max(options_.latencyMs + offset, 0);
+}
+
+QByteArray StubProvider::serialize(const Reply &reply)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(reply.status) + ' ' + reasonPhrase(reply.status) + "\r\n";
+    response += "Content-Type: " + reply.contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(reply.body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += reply.body;
+    return response;
+}
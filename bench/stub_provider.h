@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef __STUB_PROVIDER_H__
+#define __STUB_PROVIDER_H__
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+class QTcpServer;
+class QTcpSocket;
+
+// A local HTTP/1.1 server that answers the OpenAI, GitHub Models and
+// ElevenLabs requests the editor makes, so whole workflows can be timed
+// without network access or API keys. Replies are delayed by a configurable
+// latency and a share of them fail, to mimic a loaded provider.
+//
+// The server runs on a thread of its own, so its work never shows up as GUI
+// stalls in the process being measured.
+class StubProvider
+{
+public:
+    struct Options
+    {
+        int latencyMs = 250;
+        int jitterMs = 100; // uniform, +/- around latencyMs
+        double errorRate = 0.0; // HTTP 500
+        double throttleRate = 0.0; // HTTP 429
+        int speechMsPerChar = 60; // length of the synthesized clip
+        unsigned seed = 1;
+    };
+
+    explicit StubProvider(const Options &options);
+    ~StubProvider();
+
+    // Listens on a free loopback port.
+    bool start(QString *errorMessage);
+    void stop();
+
+    // http://127.0.0.1:<port>, without a trailing slash.
+    QString base_url() const;
+
+    std::uint64_t requests() const
+    {
+        return requests_.load(std::memory_order_relaxed);
+    }
+    std::uint64_t injected_errors() const
+    {
+        return injectedErrors_.load(std::memory_order_relaxed);
+    }
+    std::uint64_t injected_throttles() const
+    {
+        return injectedThrottles_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Request
+    {
+        QByteArray method;
+        QByteArray path;
+        QByteArray body;
+    };
+
+    struct Reply
+    {
+        int status = 200;
+        QByteArray contentType;
+        QByteArray body;
+    };
+
+    // Everything below runs on the server thread.
+    void accept_pending();
+    void read_request(QTcpSocket *socket);
+    Reply route(const Request &request);
+    Reply chat_completion(const QByteArray &body) const;
+    Reply speech(const QByteArray &body, const QString &textField) const;
+    int next_delay_ms();
+    static QByteArray serialize(const Reply &reply);
+
+    const Options options_;
+    QThread thread_;
+    QObject *context_ = nullptr;
+    QTcpServer *server_ = nullptr;
+    quint16 port_ = 0;
+    QHash<QTcpSocket *, QByteArray> pending_;
+    std::mt19937 random_;
+
+    std::atomic<std::uint64_t> requests_{0};
+    std::atomic<std::uint64_t> injectedErrors_{0};
+    std::atomic<std::uint64_t> injectedThrottles_{0};
+};
+
+#endif
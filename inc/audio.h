@@ -9,6 +9,7 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -19,6 +20,10 @@
 
 #include <curl/curl.h>
 
+#include "provider_metrics.h"
+
+#include <algorithm>
+#include <cmath>
 #include <mutex>
 #include <vector>
 
@@ -34,14 +39,27 @@ public:
     ~Audio();
 
     void elevenlabs_text_to_speech(QString text, std::string filePath, std::string token);
-    void elevenlabs_text_to_speech(QString text, std::string filePath, QString voice, QString model, std::string token);
-    QList<QString> elevenlabs_get_voices(const QString &token);
-    QList<QString> elevenlabs_get_models(const QString &token);
+    // speed is a playback-rate multiplier; 1.0 leaves the provider default.
+    void elevenlabs_text_to_speech(QString text, std::string filePath, QString voice, QString model, std::string token, double speed = 1.0);
+    // silent suppresses the error dialogs, for background catalog refreshes.
+    QList<QString> elevenlabs_get_voices(const QString &token, bool silent = false);
+    QList<QString> elevenlabs_get_models(const QString &token, bool silent = false);
     
     void openai_text_to_speech(QString text, std::string filePath, std::string token);
-    void openai_text_to_speech(QString text, std::string filePath, QString voice, QString model, std::string token);
+    void openai_text_to_speech(QString text, std::string filePath, QString voice, QString model, std::string token, double speed = 1.0);
     
+    // Offline synthesis through the local engine pool; always writes WAV.
+    void local_text_to_speech(QString text, std::string filePath, double speed = 1.0);
+
+    // The extension of the clip a provider produces for the requested output
+    // type; the provider functions negotiate the encoding from the file path.
+    static QString output_extension(const QString &provider, const QString &requested);
+
     double get_audio_duration_seconds(const std::string &filePath);
+
+    // The metrics series a speech provider's requests are recorded under;
+    // empty for the local engine, which sends none.
+    static MetricLabels metric_labels(const QString &provider, const QString &token);
 };
 
 #endif
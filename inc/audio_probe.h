@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef __AUDIO_PROBE_H__
+#define __AUDIO_PROBE_H__
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+// Reads clip durations straight from container headers (RIFF for WAV,
+// Xing/VBRI/LAME or a frame-header walk for MP3) without a full tag parser.
+// Results are cached per path and invalidated when size or mtime change.
+class AudioProbe
+{
+public:
+    struct Mp3Frame
+    {
+        int version = 0; // 1 = MPEG-1, 2 = MPEG-2, 3 = MPEG-2.5
+        int layer = 0;   // 1, 2 or 3
+        int bitrateKbps = 0;
+        int sampleRate = 0;
+        int samplesPerFrame = 0;
+        int length = 0;
+        bool mono = false;
+    };
+
+    // Returns the duration in seconds, or a negative value when the file is
+    // not a format the probe understands.
+    static double probe_duration(const QString &filePath);
+
+    // Probes every path in parallel; unknown formats map to a negative value.
+    static QHash<QString, double> probe_durations(const QStringList &filePaths);
+
+    static double probe_mp3(const unsigned char *data, qint64 size);
+    static double probe_wav(const unsigned char *data, qint64 size);
+
+    // Frame-level helpers shared with the MP3 concatenation path.
+    static bool parse_mp3_header(const unsigned char *header, Mp3Frame *frame);
+    static qint64 find_first_mp3_frame(const unsigned char *data, qint64 size, Mp3Frame *frame);
+    static bool is_mp3_info_frame(const unsigned char *data, qint64 size, qint64 frameOffset, const Mp3Frame &frame);
+};
+
+#endif
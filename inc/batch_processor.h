@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef __BATCH_PROCESSOR_H__
+#define __BATCH_PROCESSOR_H__
+
+#include "speech_renderer.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+#include <string>
+
+// Runs one command over many SRT files without any widget. Files are opened
+// as workers reach them and written as soon as their last cue is done, and
+// every file shares one cap on concurrent work, so a batch of thousands of
+// files never has more than `jobs` provider requests in flight.
+class BatchProcessor
+{
+public:
+    enum class Command
+    {
+        Normalize,
+        Retime,
+        Translate,
+        Speak,
+        // Translate, speak the translation, then save both.
+        Pipeline
+    };
+
+    struct Input
+    {
+        QString path;
+        // Where the output goes below the output directory.
+        QString relativePath;
+    };
+
+    struct Options
+    {
+        Command command = Command::Normalize;
+        int jobs = 1;
+        // Ignored when inPlace is set.
+        QString outputDirectory;
+        bool inPlace = false;
+
+        // Retime: start * scale + offsetMs, for both timestamps of a cue.
+        qint64 offsetMs = 0;
+        double scale = 1.0;
+
+        QString translateProvider;
+        std::string sourceLanguage;
+        std::string targetLanguage;
+        QString translateToken;
+
+        // Every setting but the text, path and slot, which come from the cue.
+        // Clips go to <output>/<name without .srt>/NNNN.<clipExtension>.
+        SpeechJob speech;
+        QString clipExtension;
+        // Also place the clips on one track next to the clip directory.
+        bool mixTrack = false;
+
+        // Pipeline stages; at least one must be on.
+        bool pipelineTranslate = true;
+        bool pipelineSpeak = true;
+
+        // Extra attempts for a cue whose request failed.
+        int retries = 0;
+        // Keep per-cue progress in <output>.checkpoint.json, resume from it,
+        // and skip files a previous run completed with the same settings.
+        bool checkpoints = false;
+    };
+
+    struct FileResult
+    {
+        QString inputPath;
+        QString outputPath;
+        int cues = 0;
+        int failedCues = 0;
+        // Cues whose work was taken from a checkpoint.
+        int resumedCues = 0;
+        int retries = 0;
+        // Completed by an earlier run; nothing was redone.
+        bool skipped = false;
+        qint64 elapsedMs = 0;
+        QString error;
+
+        bool ok() const
+        {
+            return error.isEmpty() && failedCues == 0;
+        }
+    };
+
+    // Called from worker threads, one call at a time.
+    using ProgressCallback = std::function<void(const FileResult &result, int filesDone, int filesTotal)>;
+
+    // Expands directories to the .srt files inside them, sorted by path.
+    // Paths that do not exist are appended to missing.
+    static QVector<Input> collect_inputs(const QStringList &paths, bool recursive, QStringList *missing);
+    // One path per line, relative to the manifest's directory; blank lines
+    // and lines starting with '#' are ignored. Directories are expanded like
+    // collect_inputs() does, keeping the layout below the manifest.
+    static bool read_manifest(const QString &manifestPath,
+                              bool recursive,
+                              QVector<Input> *inputs,
+                              QStringList *missing,
+                              QString *errorMessage);
+
+    // Results are in the order of inputs.
+    static QVector<FileResult> run(const QVector<Input> &inputs,
+                                   const Options &options,
+                                   const ProgressCallback &progress = {});
+
+    // Totals, provider request counts and one entry per file, as JSON.
+    static bool write_report(const QString &path,
+                             const QVector<FileResult> &results,
+                             const Options &options,
+                             qint64 elapsedMs,
+                             QString *errorMessage);
+};
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#ifndef __EXECUTOR_H__
+#define __EXECUTOR_H__
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QPointer>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Shared flag a submitter flips to abandon work it no longer needs. Copies
+// refer to the same flag. Tasks that have not started when it is cancelled
+// are dropped; running tasks may poll is_cancelled() to stop early.
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void cancel();
+    bool is_cancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// Application-wide work-stealing pool for background work. Every worker owns
+// a deque per priority; tasks submitted from a worker stay on its own deque,
+// others are spread round-robin, and idle workers steal from the back of
+// their peers' deques. Higher priorities are drained, locally and by
+// stealing, before any lower priority is looked at.
+class Executor
+{
+public:
+    enum class Priority
+    {
+        High,
+        Normal,
+        Low
+    };
+
+    using Task = std::function<void()>;
+
+    static Executor &instance();
+    // Pool for provider requests, which spend their time in curl or in the
+    // scheduler's 429 back-off rather than on a CPU. Kept apart from
+    // instance() so a stalled provider never holds the workers that parse,
+    // index and mix.
+    static Executor &io();
+
+    explicit Executor(int threadCount);
+    ~Executor();
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    void submit(Task task, Priority priority = Priority::Normal, CancellationToken token = {});
+    int thread_count() const;
+
+private:
+    static constexpr int kPriorityCount = 3;
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> queues[kPriorityCount];
+    };
+
+    bool take(int self, Task *task);
+    void worker_loop(int index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<unsigned> nextWorker_{0};
+
+    // sleepMutex_ guards the wake-up condition; pending_ counts queued tasks.
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    int pending_ = 0;
+    bool stopping_ = false;
+};
+
+// Runs fn on the GUI thread, unless context has been destroyed by then.
+// Create the QPointer on the GUI thread (typically when submitting the task
+// that will call this), so workers never touch a dying object.
+template <typename T, typename Fn>
+void postToGui(const QPointer<T> &context, Fn fn)
+{
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(),
+        [context, fn]() {
+            if (context)
+            {
+                fn();
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+#endif
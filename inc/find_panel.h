@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef __FIND_PANEL_H__
+#define __FIND_PANEL_H__
+
+#include "executor.h"
+#include "text_index.h"
+#include "ui_find_panel.h"
+
+#include <QSet>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+#include <memory>
+
+namespace Ui
+{
+    class FindPanel;
+}
+
+// Find bar under the subtitle table. Searches the text column through a
+// TextIndex that follows cell edits row by row and is rebuilt on the
+// executor after rows are added, removed or reloaded. Hits are highlighted
+// by a delegate when their cells are painted, so a million hits cost nothing
+// until they scroll into view.
+class FindPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FindPanel(QTableWidget *table, QWidget *parent = nullptr);
+    ~FindPanel() override;
+
+    // Shows the panel and focuses the search field.
+    void activate();
+    void find_next();
+    void find_previous();
+
+    bool is_hit(int row) const;
+    bool is_current_hit(int row) const;
+
+private:
+    std::unique_ptr<Ui::FindPanel> ui;
+    QTableWidget *table_;
+    QTimer searchTimer_;
+    // Edits are applied to the index once control returns to the event
+    // loop, so a batch edit can fall back to one rebuild.
+    QTimer editTimer_;
+    QSet<int> pendingEdits_;
+
+    TextIndex index_;
+    bool indexStale_ = true;
+    bool indexing_ = false;
+    // Bumped whenever rows move, so a build started before is thrown away.
+    int indexGeneration_ = 0;
+    // Rows edited while a build was running, re-read once it lands.
+    QSet<int> editedDuringBuild_;
+    CancellationToken indexCancel_;
+
+    // The query being shown, or none while the panel is closed.
+    std::unique_ptr<TextIndex::Matcher> matcher_;
+    QVector<int> hits_;
+    int currentHit_ = -1;
+
+    void schedule_search();
+    void search();
+    void rebuild_index();
+    void rows_moved();
+    void cells_changed(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles);
+    void flush_edits();
+    void update_row(int row);
+    void select_hit(int hit);
+    void close_panel();
+    void update_match_label();
+    QString cell_text(int row) const;
+};
+
+#endif
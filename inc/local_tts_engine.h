@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef __LOCAL_TTS_ENGINE_H__
+#define __LOCAL_TTS_ENGINE_H__
+
+#include <QString>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Offline speech synthesis through a pool of long-lived Piper processes.
+// Each worker thread owns one engine started with --json-input. Requests are
+// written to its stdin as JSON lines, and the engine echoes the path of every
+// clip it finishes on stdout, so the voice model is loaded once per worker
+// instead of once per clip.
+class LocalTtsEngine
+{
+public:
+    struct Config
+    {
+        QString executable;
+        QString model;
+        int workers = 2;
+        double lengthScale = 1.0;
+
+        bool operator==(const Config &other) const;
+        bool operator!=(const Config &other) const { return !(*this == other); }
+    };
+
+    static LocalTtsEngine &instance();
+
+    LocalTtsEngine() = default;
+    ~LocalTtsEngine();
+
+    LocalTtsEngine(const LocalTtsEngine &) = delete;
+    LocalTtsEngine &operator=(const LocalTtsEngine &) = delete;
+
+    // Writes a WAV clip for text to outputPath, blocking until it is done.
+    // Safe to call from several threads; the pool is (re)started whenever
+    // config differs from the running one.
+    bool synthesize(const QString &text, const QString &outputPath, const Config &config, QString *errorMessage);
+
+    // Stops every engine process. Pending requests fail.
+    void shutdown();
+
+private:
+    struct Result
+    {
+        bool ok = false;
+        QString error;
+    };
+
+    struct Job
+    {
+        QString text;
+        QString outputPath;
+        // The settings it was submitted under; a pool started for others
+        // must not speak it.
+        Config config;
+        std::promise<Result> result;
+    };
+
+    void start(const Config &config);
+    void stop();
+    // Call with queueMutex_ held.
+    void fail_jobs_locked(const Config &keep, const QString &error);
+    void worker_loop(Config config);
+
+    // lifecycleMutex_ serializes pool restarts; queueMutex_ guards the queue.
+    std::mutex lifecycleMutex_;
+    std::mutex queueMutex_;
+    std::condition_variable wake_;
+    std::deque<Job> queue_;
+    std::vector<std::thread> workers_;
+    Config config_;
+    bool stopping_ = false;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#pragma once
+
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+enum class LogLevel : std::uint8_t
+{
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+// One captured log call. Arguments are stored raw and only formatted on the
+// sink thread, so a call costs a level check, a clock read and a copy into
+// the calling thread's ring. The category and format must be string
+// literals; "{}" placeholders in the format are filled in order.
+struct LogRecord
+{
+    static constexpr int kMaxArgs = 6;
+    static constexpr int kTextCapacity = 160;
+
+    enum class ArgType : std::uint8_t
+    {
+        Signed,
+        Unsigned,
+        Double,
+        Text
+    };
+
+    struct Arg
+    {
+        ArgType type = ArgType::Signed;
+        std::uint16_t textOffset = 0;
+        std::uint16_t textLength = 0;
+        union
+        {
+            std::int64_t i;
+            std::uint64_t u;
+            double d;
+        };
+    };
+
+    std::int64_t timestampMs = 0;
+    const char *category = nullptr;
+    const char *format = nullptr;
+    LogLevel level = LogLevel::Info;
+    std::uint8_t argCount = 0;
+    std::uint16_t textUsed = 0;
+    Arg args[kMaxArgs];
+    char text[kTextCapacity];
+
+    template <typename T>
+    void append(const T &value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            append_text(value ? "true" : "false", value ? 4 : 5);
+        }
+        else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                Arg *arg = next(ArgType::Signed);
+                if (arg)
+                {
+                    arg->i = static_cast<std::int64_t>(value);
+                }
+            }
+            else
+            {
+                Arg *arg = next(ArgType::Unsigned);
+                if (arg)
+                {
+                    arg->u = static_cast<std::uint64_t>(value);
+                }
+            }
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            Arg *arg = next(ArgType::Double);
+            if (arg)
+            {
+                arg->d = static_cast<double>(value);
+            }
+        }
+        else if constexpr (std::is_same_v<T, QString>)
+        {
+            const QByteArray utf8 = value.left(kTextCapacity).toUtf8();
+            append_text(utf8.constData(), static_cast<size_t>(utf8.size()));
+        }
+        else if constexpr (std::is_same_v<T, QByteArray>)
+        {
+            append_text(value.constData(), static_cast<size_t>(value.size()));
+        }
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            append_text(value.data(), value.size());
+        }
+        else if constexpr (std::is_convertible_v<T, const char *>)
+        {
+            const char *string = value;
+            append_text(string, string ? std::strlen(string) : 0);
+        }
+        else
+        {
+            static_assert(std::is_arithmetic_v<T>, "Unsupported log argument type");
+        }
+    }
+
+private:
+    Arg *next(ArgType type)
+    {
+        if (argCount >= kMaxArgs)
+        {
+            return nullptr;
+        }
+        Arg *arg = &args[argCount++];
+        arg->type = type;
+        return arg;
+    }
+
+    // Text arguments share one inline buffer and are truncated to fit.
+    void append_text(const char *data, size_t length)
+    {
+        Arg *arg = next(ArgType::Text);
+        if (!arg)
+        {
+            return;
+        }
+        const size_t room = static_cast<size_t>(kTextCapacity - textUsed);
+        const size_t take = length < room ? length : room;
+        if (take > 0)
+        {
+            std::memcpy(text + textUsed, data, take);
+        }
+        arg->textOffset = textUsed;
+        arg->textLength = static_cast<std::uint16_t>(take);
+        textUsed = static_cast<std::uint16_t>(textUsed + take);
+    }
+};
+
+// Structured logger. Each thread writes into its own single-producer ring;
+// a background sink drains the rings, formats the records and appends them
+// to a size-rotated log file. A full ring drops the record (and counts it)
+// instead of blocking the caller.
+class Logger
+{
+public:
+    static bool enabled(LogLevel level)
+    {
+        return static_cast<int>(level) >= minimumLevel_.load(std::memory_order_relaxed);
+    }
+
+    static void set_level(LogLevel level);
+    static LogLevel level_from_string(const QString &name, LogLevel fallback);
+
+    template <typename... Args>
+    static void write(LogLevel level, const char *category, const char *format, const Args &...args)
+    {
+        LogRecord record;
+        record.timestampMs = now_ms();
+        record.level = level;
+        record.category = category;
+        record.format = format;
+        (record.append(args), ...);
+        submit(record);
+    }
+
+    // Starts the background sink writing to path. When the file grows past
+    // maxBytes it is renamed to path.1 (older ones shift up, keeping
+    // maxFiles) and a fresh file is started.
+    static bool start(const QString &path, qint64 maxBytes, int maxFiles, QString *errorMessage);
+    // Starts the background sink writing records at or above minimum to
+    // stderr, for tools run without a log file.
+    static void start_console(LogLevel minimum);
+    // Drains every ring and stops the sink. Later records stay unwritten.
+    static void stop();
+    static std::uint64_t dropped();
+
+private:
+    static std::int64_t now_ms();
+    static void submit(const LogRecord &record);
+
+    static inline std::atomic<int> minimumLevel_{static_cast<int>(LogLevel::Info)};
+};
+
+#define SRT_LOG(level, category, ...)                    \
+    do                                                   \
+    {                                                    \
+        if (Logger::enabled(level))                      \
+        {                                                \
+            Logger::write(level, category, __VA_ARGS__); \
+        }                                                \
+    } while (false)
+
+#define SRT_LOG_TRACE(category, ...) SRT_LOG(LogLevel::Trace, category, __VA_ARGS__)
+#define SRT_LOG_DEBUG(category, ...) SRT_LOG(LogLevel::Debug, category, __VA_ARGS__)
+#define SRT_LOG_INFO(category, ...) SRT_LOG(LogLevel::Info, category, __VA_ARGS__)
+#define SRT_LOG_WARN(category, ...) SRT_LOG(LogLevel::Warn, category, __VA_ARGS__)
+#define SRT_LOG_ERROR(category, ...) SRT_LOG(LogLevel::Error, category, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef __LOUDNESS_H__
+#define __LOUDNESS_H__
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+// EBU R128 / ITU-R BS.1770-4 measurement and loudness normalization. Only
+// WAV clips can be processed; other formats would need a decoder.
+class Loudness
+{
+public:
+    struct Measurement
+    {
+        bool valid = false;
+        double integratedLufs = 0.0;
+        double truePeakDbtp = 0.0;
+    };
+
+    struct Report
+    {
+        int adjusted = 0;
+        int skipped = 0;
+        int failed = 0;
+    };
+
+    // Integrated loudness (K-weighted, gated) and 4x oversampled true peak.
+    static Measurement measure(const std::vector<float> &samples, int channels, int sampleRate);
+    static Measurement measure_file(const QString &path);
+    static QHash<QString, Measurement> measure_files(const QStringList &paths);
+
+    // Gain in dB that brings a clip to targetLufs without its true peak
+    // exceeding ceilingDbtp.
+    static double gain_for_target(const Measurement &measurement, double targetLufs, double ceilingDbtp);
+
+    // Brings every clip to targetLufs, measuring and rewriting them in
+    // parallel. Clips that are not WAV, or are silent, are skipped.
+    static Report normalize_files(const QStringList &paths, double targetLufs, double ceilingDbtp);
+    static bool normalize_file(const QString &path, double targetLufs, double ceilingDbtp);
+};
+
+#endif
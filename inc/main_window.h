@@ -8,7 +8,10 @@
 #include <QDesktopServices>
 #include "translator_window.h"
 #include "settings_window.h"
+#include "metrics_window.h"
 #include "text_to_speech_window.h"
+#include "find_panel.h"
+#include "text_transform_window.h"
 #include <QDir>
 #include <algorithm>
 #include <QFile>
@@ -20,12 +23,15 @@
 #include <QTableWidgetItem>
 #include <QTextStream>
 #include <QTime>
+#include <QUndoStack>
 #include <QtGlobal>
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #include <QStringConverter>
 #endif
 #include "settings.h"
 #include "configure.h"
+#include "executor.h"
+#include "srt_document.h"
 #include "ui_main_window.h"
 
 namespace Ui
@@ -48,6 +54,10 @@ private:
     QString baseWindowTitle_;
     QString currentProjectPath_;
     Settings settings;
+    CancellationToken loadCancel_;
+    FindPanel *findPanel_ = nullptr;
+    // Batch text edits only; loading a file or removing rows clears it.
+    QUndoStack undoStack_;
 
     void init_settings();
     void new_project();
@@ -55,12 +65,21 @@ private:
     void save_project();
     void save_as_project();
     void open_settings_window();
-    bool load_project_from_file(const QString &file_path);
-    bool save_project_to_file(const QString &file_path);
+    void open_metrics_window();
+    // Both run on the shared executor and report back on the GUI thread.
+    void load_project_from_file(const QString &file_path);
+    void save_project_to_file(const QString &file_path);
+    void populate_table(const QVector<SrtCue> &cues);
     void add_subtitle();
     void remove_subtitle();
     void open_translator_window();
+    void open_text_transform_window();
     void open_portfolio_website();
     void open_text_to_speech_window();
+    // Translates and speaks every row in one pass; each row is spoken as
+    // soon as its translation arrives.
+    void open_dubbing_window();
+    QVector<TextToSpeechWindow::Entry> text_to_speech_entries() const;
+    void apply_text_to_speech_entry(int row, const TextToSpeechWindow::Entry &entry);
     void show_software_info();
 };
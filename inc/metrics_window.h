@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QDialog>
+#include <QTimer>
+#include <memory>
+
+#include "ui_metrics_window.h"
+
+namespace Ui
+{
+    class MetricsWindow;
+}
+
+// Live view of ProviderMetrics: one row per provider, endpoint and API key,
+// refreshed once a second while the dialog is open.
+class MetricsWindow : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsWindow(QWidget *parent = nullptr);
+    ~MetricsWindow() override;
+
+private:
+    std::unique_ptr<Ui::MetricsWindow> ui;
+    QTimer refreshTimer;
+
+    void refresh_table();
+    void reset_metrics();
+    void export_metrics();
+};
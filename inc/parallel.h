@@ -0,0 +1,76 @@
+#pragma once
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include "executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+// Runs fn(index) for every index in [0, count) on the shared executor and
+// blocks until every call has returned. Indices are handed out dynamically,
+// so uneven per-item costs still balance across threads, and the calling
+// thread works through indices too, so nested calls from executor tasks
+// cannot deadlock. maxThreads caps the number of threads for work bound by
+// something other than the CPU, such as requests to a rate-limited service,
+// which should also pass Executor::io() as the executor.
+template <typename Fn>
+void parallelFor(int count, Fn &&fn, int maxThreads = 0, Executor &executor = Executor::instance())
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    const int threadLimit = maxThreads > 0 ? maxThreads : executor.thread_count() + 1;
+    const int workerCount = std::min(count, threadLimit);
+    if (workerCount == 1)
+    {
+        for (int index = 0; index < count; ++index)
+        {
+            fn(index);
+        }
+        return;
+    }
+
+    // Helpers that start after every index is taken only touch the shared
+    // state, never fn, so they may outlive this call safely.
+    struct State
+    {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    auto *body = &fn;
+
+    auto drain = [state, body, count]() {
+        int completed = 0;
+        for (int index = state->next.fetch_add(1); index < count; index = state->next.fetch_add(1))
+        {
+            (*body)(index);
+            ++completed;
+        }
+        if (completed > 0 && state->done.fetch_add(completed) + completed == count)
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished.notify_all();
+        }
+    };
+
+    for (int i = 1; i < workerCount; ++i)
+    {
+        executor.submit(drain, Executor::Priority::High);
+    }
+    drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() { return state->done.load() == count; });
+}
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef __PROVIDER_CATALOG_H__
+#define __PROVIDER_CATALOG_H__
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+// On-disk cache of the model and voice lists providers publish. Dialogs fill
+// their combo boxes from cached() immediately and call refresh(), which
+// fetches on the shared executor when the entry is missing or older than
+// the TTL and emits updated() on the GUI thread once fresh data arrives.
+class ProviderCatalog : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Runs on a worker thread; must not touch widgets. An empty list counts
+    // as a failed fetch and keeps the previous entry.
+    using Fetcher = std::function<QStringList()>;
+
+    static ProviderCatalog &instance();
+
+    // Entries are per account, so switching API keys never shows another
+    // account's custom voices. Only a digest of the token is stored.
+    static QString make_key(const QString &provider, const QString &kind, const QString &token);
+
+    ProviderCatalog(const QString &filePath, qint64 ttlSeconds);
+    ~ProviderCatalog() override;
+
+    QStringList cached(const QString &key) const;
+    bool is_fresh(const QString &key) const;
+    void refresh(const QString &key, Fetcher fetcher, bool force = false);
+
+signals:
+    void updated(const QString &key, const QStringList &items);
+
+private:
+    struct Entry
+    {
+        QStringList items;
+        qint64 fetchedAt = 0;
+    };
+
+    void store(const QString &key, const QStringList &items);
+    void load();
+    void save() const;
+
+    QString filePath_;
+    qint64 ttlSeconds_ = 0;
+    QHash<QString, Entry> entries_;
+    QSet<QString> inFlight_;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef __PROVIDER_ENDPOINTS_H__
+#define __PROVIDER_ENDPOINTS_H__
+
+#include <QByteArray>
+#include <QString>
+
+// Base URLs of the hosted provider APIs. Setting "endpoints/<provider>"
+// replaces a default, which points requests at a proxy, a compatible
+// self-hosted server or a local stand-in provider.
+class ProviderEndpoints
+{
+public:
+    // provider is "openai", "github" or "elevenlabs".
+    static QString default_base_url(const QString &provider);
+    static QString base_url(const QString &provider);
+
+    // The base URL joined with path, which may carry a query string.
+    static QByteArray url(const QString &provider, const QString &path);
+};
+
+#endif
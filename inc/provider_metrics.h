@@ -0,0 +1,121 @@
+#pragma once
+
+#ifndef __PROVIDER_METRICS_H__
+#define __PROVIDER_METRICS_H__
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <curl/curl.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Log-linear latency histogram in the spirit of HdrHistogram: values below
+// 64 us are exact, larger ones land in one of 32 sub-buckets per power of
+// two, so every reported percentile is within about 3% of the true value.
+// Recording is a handful of relaxed atomic adds and never allocates.
+class LatencyHistogram
+{
+public:
+    void record(std::int64_t micros);
+    void reset();
+
+    std::uint64_t count() const;
+    std::int64_t sum() const;
+    std::int64_t max() const;
+    // Upper bound of the bucket holding the given percentile (0-100).
+    std::int64_t value_at_percentile(double percentile) const;
+
+    static int bucket_index(std::int64_t micros);
+    static std::int64_t bucket_upper_bound(int index);
+
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kBucketCount = 1024; // covers up to 2^36 us (~19 h)
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::int64_t> sum_{0};
+    std::atomic<std::int64_t> max_{0};
+};
+
+// Identifies one metric series. key is a short digest of the API token,
+// never the token itself, so exports can be shared safely.
+struct MetricLabels
+{
+    QString provider;
+    QString endpoint;
+    QString key;
+};
+
+// Process-wide request counters and latency histograms for every provider
+// HTTP call, keyed by provider, endpoint and API key. Any thread may record;
+// the metrics window and the Prometheus export read consistent-enough
+// snapshots without stopping the recorders.
+class ProviderMetrics
+{
+public:
+    struct Series
+    {
+        std::atomic<std::uint64_t> requests{0};
+        std::atomic<std::uint64_t> failures{0};
+        std::atomic<std::uint64_t> throttled{0};
+        std::atomic<std::uint64_t> retries{0};
+        std::atomic<std::uint64_t> bytesSent{0};
+        std::atomic<std::uint64_t> bytesReceived{0};
+        std::atomic<std::uint64_t> promptTokens{0};
+        std::atomic<std::uint64_t> completionTokens{0};
+        LatencyHistogram latency;
+    };
+
+    struct SeriesSnapshot
+    {
+        MetricLabels labels;
+        std::uint64_t requests = 0;
+        std::uint64_t failures = 0;
+        std::uint64_t throttled = 0;
+        std::uint64_t retries = 0;
+        std::uint64_t bytesSent = 0;
+        std::uint64_t bytesReceived = 0;
+        std::uint64_t promptTokens = 0;
+        std::uint64_t completionTokens = 0;
+        std::int64_t p50Us = 0;
+        std::int64_t p90Us = 0;
+        std::int64_t p99Us = 0;
+        std::int64_t maxUs = 0;
+        std::int64_t sumUs = 0;
+    };
+
+    static ProviderMetrics &instance();
+
+    static MetricLabels labels(const QString &provider, const QString &endpoint, const QString &token);
+
+    // Records one finished transfer from the handle's own timing and size
+    // counters. Call after curl_easy_perform and before curl_easy_cleanup.
+    void record_curl(const MetricLabels &labels, CURL *curl, CURLcode code);
+    void add_tokens(const MetricLabels &labels, std::uint64_t prompt, std::uint64_t completion);
+    void add_retry(const MetricLabels &labels);
+
+    QVector<SeriesSnapshot> snapshot() const;
+    void reset();
+
+    // Prometheus text exposition format, suitable for the node_exporter
+    // textfile collector.
+    QByteArray to_prometheus() const;
+    bool write_prometheus_file(const QString &path, QString *errorMessage) const;
+
+private:
+    std::shared_ptr<Series> series(const MetricLabels &labels);
+
+    mutable std::mutex mutex_;
+    QHash<QString, MetricLabels> labels_;
+    QHash<QString, std::shared_ptr<Series>> series_;
+};
+
+#endif
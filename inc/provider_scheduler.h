@@ -0,0 +1,105 @@
+#pragma once
+
+#ifndef __PROVIDER_SCHEDULER_H__
+#define __PROVIDER_SCHEDULER_H__
+
+#include <QHash>
+#include <QString>
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+// Process-wide admission control for provider requests. Every translation
+// and speech request takes a permit first, so the editor windows and a
+// command-line batch over thousands of files share one set of limits per
+// provider. Also owns the curl share handle through which those requests
+// reuse TLS sessions and DNS lookups.
+//
+// Limits come from "limits/<provider>/requests_per_minute" and
+// "limits/<provider>/max_concurrent" unless set_limits() overrides them;
+// zero or missing means no limit.
+class ProviderScheduler
+{
+public:
+    struct Limits
+    {
+        double requestsPerMinute = 0.0;
+        int maxConcurrent = 0;
+    };
+
+    // Holds one concurrency slot until destroyed.
+    class Permit
+    {
+    public:
+        Permit(Permit &&other) noexcept;
+        ~Permit();
+
+        Permit(const Permit &) = delete;
+        Permit &operator=(const Permit &) = delete;
+        Permit &operator=(Permit &&) = delete;
+
+        // Reports how the request ended. An HTTP 429 pauses the provider for
+        // a growing back-off; any other answer resets it.
+        void complete(CURL *curl) const;
+
+    private:
+        friend class ProviderScheduler;
+        Permit(ProviderScheduler *scheduler, QString provider);
+
+        ProviderScheduler *scheduler_ = nullptr;
+        QString provider_;
+    };
+
+    static ProviderScheduler &instance();
+
+    ~ProviderScheduler();
+
+    ProviderScheduler(const ProviderScheduler &) = delete;
+    ProviderScheduler &operator=(const ProviderScheduler &) = delete;
+
+    // provider is "openai", "github" or "elevenlabs". Blocks until the
+    // provider has a free slot, a request token and is not backing off.
+    Permit acquire(const QString &provider);
+
+    void set_limits(const QString &provider, const Limits &limits);
+    Limits limits(const QString &provider) const;
+
+    // Attaches the shared DNS and TLS session caches to an easy handle.
+    void share_caches(CURL *curl);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct State
+    {
+        Limits limits;
+        bool overridden = false;
+        int inFlight = 0;
+        double tokens = 1.0;
+        Clock::time_point refilledAt = Clock::now();
+        Clock::time_point pausedUntil;
+        int backoffMs = 0;
+    };
+
+    ProviderScheduler();
+
+    State &state_locked(const QString &provider);
+    void release(const QString &provider);
+    void report(const QString &provider, long httpStatus);
+
+    static void lock_share(CURL *handle, curl_lock_data data, curl_lock_access access, void *userData);
+    static void unlock_share(CURL *handle, curl_lock_data data, void *userData);
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    QHash<QString, std::shared_ptr<State>> states_;
+
+    CURLSH *share_ = nullptr;
+    std::mutex shareMutexes_[CURL_LOCK_DATA_LAST];
+};
+
+#endif
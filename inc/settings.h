@@ -1,20 +1,17 @@
 #ifndef __SETTINGS_H__
 #define __SETTINGS_H__
 
-#include <QSettings>
 #include <QString>
 #include <QStringList>
 #include <QVariant>
 
+// Lightweight view of the process-wide SettingsService. Instances hold no
+// data of their own, so every window, and any worker thread, reads the same
+// snapshot without parsing the settings file again.
 class Settings
 {
 public:
-    Settings();
-    Settings(const QString &organization, const QString &application);
-    Settings(QSettings::Format format,
-             QSettings::Scope scope,
-             const QString &organization,
-             const QString &application);
+    Settings() = default;
     ~Settings() = default;
 
     QVariant value(const QString &key, const QVariant &defaultValue = {}) const;
@@ -26,11 +23,17 @@ public:
     void beginGroup(const QString &prefix);
     void endGroup();
     void clear();
+    // Schedules a write of pending changes after a short debounce, so a
+    // burst of edits rewrites the file once.
     void sync();
+    // Writes pending changes now, for values that must not be lost.
+    void flush();
     QString fileName() const;
 
 private:
-    QSettings settings_;
+    QString qualified(const QString &key) const;
+
+    QStringList groups_;
 };
 
 #endif // __SETTINGS_H__
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef __SETTINGS_SERVICE_H__
+#define __SETTINGS_SERVICE_H__
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSettings>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+
+#include <memory>
+#include <mutex>
+
+// The single owner of the application's QSettings. The file is parsed once;
+// readers get an immutable snapshot that writers replace wholesale
+// (read-copy-update), so worker threads never touch a GUI-thread object and
+// never wait for file I/O. Writes are coalesced and flushed after a short
+// debounce, on flush(), or on shutdown.
+class SettingsService : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Snapshot = QHash<QString, QVariant>;
+
+    static SettingsService &instance();
+
+    ~SettingsService() override;
+
+    // The current snapshot. It stays valid, and unchanged, for as long as
+    // the caller holds it.
+    std::shared_ptr<const Snapshot> snapshot() const;
+    QVariant value(const QString &key, const QVariant &defaultValue = {}) const;
+
+    // Safe from any thread.
+    void set_value(const QString &key, const QVariant &value);
+    // Removes key and every key below it.
+    void remove(const QString &key);
+    void clear();
+
+    void schedule_flush();
+    void flush();
+    QString file_name() const;
+
+signals:
+    // Emitted from the writing thread; queued to receivers on other threads.
+    void changed(const QString &key);
+
+private:
+    SettingsService();
+
+    void publish(std::shared_ptr<const Snapshot> next);
+
+    // Accessed only through std::atomic_load / std::atomic_store.
+    std::shared_ptr<const Snapshot> snapshot_;
+
+    // writeMutex_ serializes writers and guards store_ and dirtyKeys_.
+    std::mutex writeMutex_;
+    QSettings store_;
+    QSet<QString> dirtyKeys_;
+    // A child, so moveToThread() takes it along to the GUI thread.
+    QTimer *flushTimer_ = nullptr;
+};
+
+#endif
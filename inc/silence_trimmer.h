@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef __SILENCE_TRIMMER_H__
+#define __SILENCE_TRIMMER_H__
+
+#include <QString>
+
+#include <vector>
+
+// Removes the leading and trailing silence providers pad clips with, so the
+// measured duration covers the speech only. Detection is energy based: a clip
+// is scanned in 10 ms windows and speech starts at the first window whose
+// level reaches the threshold. WAV clips only.
+class SilenceTrimmer
+{
+public:
+    struct Result
+    {
+        bool ok = false;
+        double leadingSeconds = 0.0;
+        double trailingSeconds = 0.0;
+        double speechSeconds = 0.0;
+    };
+
+    // Frame range [*begin, *end) that holds speech, widened by a short guard
+    // so consonant onsets and decays survive. Returns false for clips that
+    // never reach thresholdDb (dBFS).
+    static bool find_speech(const std::vector<float> &samples,
+                            int channels,
+                            int sampleRate,
+                            double thresholdDb,
+                            qint64 *begin,
+                            qint64 *end);
+
+    // Rewrites a WAV clip without its edge silence.
+    static Result trim_file(const QString &path, double thresholdDb);
+};
+
+#endif
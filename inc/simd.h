@@ -0,0 +1,135 @@
+#pragma once
+
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SRT_EDITOR_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SRT_EDITOR_SIMD_NEON 1
+#endif
+
+// Float kernels shared by the audio stages. Each has an SSE and a NEON path
+// with a scalar tail, and falls back to plain loops elsewhere. Unaligned
+// loads are used throughout so callers can pass any offset into a buffer.
+
+// sum(a[i] * b[i])
+inline float dotProduct(const float *a, const float *b, int n)
+{
+    int i = 0;
+    float sum = 0.0f;
+#if defined(SRT_EDITOR_SIMD_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(SRT_EDITOR_SIMD_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    const float32x4_t acc = vaddq_f32(acc0, acc1);
+    sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+#endif
+    for (; i < n; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+inline float sumOfSquares(const float *a, int n)
+{
+    return dotProduct(a, a, n);
+}
+
+// dst[i] += src[i] * window[i]
+inline void windowedAdd(float *dst, const float *src, const float *window, int n)
+{
+    int i = 0;
+#if defined(SRT_EDITOR_SIMD_SSE)
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 product = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(window + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), product));
+    }
+#elif defined(SRT_EDITOR_SIMD_NEON)
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), vld1q_f32(window + i)));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        dst[i] += src[i] * window[i];
+    }
+}
+
+// data[i] *= gain
+inline void scaleInPlace(float *data, long long n, float gain)
+{
+    long long i = 0;
+#if defined(SRT_EDITOR_SIMD_SSE)
+    const __m128 factor = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), factor));
+    }
+#elif defined(SRT_EDITOR_SIMD_NEON)
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), gain));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        data[i] *= gain;
+    }
+}
+
+// max(|data[i]|)
+inline float peakAbs(const float *data, long long n)
+{
+    long long i = 0;
+    float peak = 0.0f;
+#if defined(SRT_EDITOR_SIMD_SSE)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+    {
+        acc = _mm_max_ps(acc, _mm_andnot_ps(signMask, _mm_loadu_ps(data + i)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(SRT_EDITOR_SIMD_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4)
+    {
+        acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(data + i)));
+    }
+    peak = std::max(std::max(vgetq_lane_f32(acc, 0), vgetq_lane_f32(acc, 1)),
+                    std::max(vgetq_lane_f32(acc, 2), vgetq_lane_f32(acc, 3)));
+#endif
+    for (; i < n; ++i)
+    {
+        peak = std::max(peak, std::fabs(data[i]));
+    }
+    return peak;
+}
+
+#endif
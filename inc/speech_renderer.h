@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef __SPEECH_RENDERER_H__
+#define __SPEECH_RENDERER_H__
+
+#include "tts_cache.h"
+
+#include <QString>
+
+// One clip to synthesize, with every setting captured up front so it can be
+// rendered on any thread without touching a widget.
+struct SpeechJob
+{
+    QString text;
+    QString provider;
+    QString voice;
+    QString model;
+    QString token;
+    QString filePath;
+    double speed = 1.0;
+    TtsCache::Key cacheKey;
+    bool trimSilence = false;
+    double trimThresholdDb = 0.0;
+    qint64 slotMs = -1;
+    bool fitToSlot = false;
+    double maxStretchRatio = 1.0;
+    bool normalizeLoudness = false;
+    double targetLufs = 0.0;
+};
+
+// The speech pipeline shared by the TTS window and the command-line tool:
+// clip cache, provider request, then silence trimming, slot fitting and
+// loudness normalization.
+class SpeechRenderer
+{
+public:
+    // Headroom kept below full scale when raising quiet clips.
+    static constexpr double kTruePeakCeilingDbtp = -1.0;
+
+    static bool is_local_provider(const QString &provider);
+    // "Local", "OpenAI" or "ElevenLabs", compared case-insensitively.
+    static bool is_supported_provider(const QString &provider);
+
+    // Writes job.filePath and returns the clip length in seconds, or -1 if
+    // no clip was produced.
+    static double render(const SpeechJob &job);
+
+private:
+    static double finalize(const SpeechJob &job, double durationSeconds);
+};
+
+#endif
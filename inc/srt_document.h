@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef __SRT_DOCUMENT_H__
+#define __SRT_DOCUMENT_H__
+
+#include <QString>
+#include <QVector>
+
+struct SrtCue
+{
+    QString start;
+    QString end;
+    QString text;
+};
+
+// Widget-free SRT reading and writing, safe to run on worker threads.
+class SrtDocument
+{
+public:
+    // Blocks without a valid "start --> end" line are skipped. Accepts LF
+    // and CRLF line endings and a UTF-8 byte order mark.
+    static QVector<SrtCue> parse(const QString &content);
+    // CRLF line endings, cues numbered from 1; cues without both timestamps
+    // are left out.
+    static QString serialize(const QVector<SrtCue> &cues);
+
+    static bool read_file(const QString &path, QVector<SrtCue> *cues, QString *errorMessage);
+    // Replaces the file atomically, so a failed save never truncates it.
+    static bool write_file(const QString &path, const QVector<SrtCue> &cues, QString *errorMessage);
+};
+
+#endif
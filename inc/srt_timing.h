@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef __SRT_TIMING_H__
+#define __SRT_TIMING_H__
+
+#include <QString>
+#include <QtGlobal>
+
+// Conversions between SRT timestamps ("HH:MM:SS,mmm") and milliseconds.
+// Every parser returns -1 for input it does not recognise.
+class SrtTiming
+{
+public:
+    static constexpr qint64 kMillisecondsPerDay = 24LL * 60 * 60 * 1000;
+
+    static qint64 parse_srt_timestamp(const QString &value);
+    // Also accepts "HH:MM:SS.mmm", "MM:SS,mmm" and plain seconds such as
+    // "12.5s", which is how the TTS window reports clip lengths.
+    static qint64 parse_flexible_duration(const QString &value);
+    // Empty for negative input.
+    static QString milliseconds_to_srt(qint64 msecs);
+
+    // end - start as a timestamp. An end before the start is taken to wrap
+    // past midnight.
+    static QString compute_duration_string(const QString &start, const QString &end);
+    static QString add_duration_to_timestamp(const QString &start, const QString &duration);
+    static QString normalize_duration_from_tts(const QString &rawDuration);
+    // (timestamp * factor) + offsetMs, clamped at zero. Empty for input that
+    // is not an SRT timestamp.
+    static QString retime_timestamp(const QString &timestamp, qint64 offsetMs, double factor = 1.0);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#ifndef __SUBTITLE_TABLE_H__
+#define __SUBTITLE_TABLE_H__
+
+#include "srt_document.h"
+
+#include <QTableWidget>
+#include <QVector>
+
+// Layout of the editor's subtitle table and filling it from parsed cues.
+class SubtitleTable
+{
+public:
+    enum Column
+    {
+        StartColumn = 0,
+        EndColumn = 1,
+        DurationColumn = 2,
+        TextColumn = 3
+    };
+
+    // Replaces every row of table with one row per cue.
+    static void populate(QTableWidget *table, const QVector<SrtCue> &cues);
+};
+
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#ifndef __TEXT_CHUNKER_H__
+#define __TEXT_CHUNKER_H__
+
+#include <QString>
+#include <QStringList>
+
+// Splits narration into pieces a speech provider accepts in one request.
+// Cuts prefer sentence ends, then clause punctuation, then word breaks, so
+// every chunk still reads naturally on its own.
+class TextChunker
+{
+public:
+    // Every returned chunk is at most maxChars long. Text that fits is
+    // returned as a single chunk.
+    static QStringList split(const QString &text, int maxChars);
+
+    // Like split(), but long text is spread over chunks of about
+    // targetChars so they can be synthesized concurrently.
+    static QStringList split_balanced(const QString &text, int targetChars, int maxChars);
+};
+
+#endif
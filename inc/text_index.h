@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef __TEXT_INDEX_H__
+#define __TEXT_INDEX_H__
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Trigram index over the subtitle text column. A query is reduced to the
+// trigrams every match must contain, and only rows holding all of them are
+// checked against the query itself, so finding a name in a million cues
+// touches a handful of rows. Trigrams are taken over case-folded UTF-16, which
+// serves case-sensitive queries too: their matches are a subset.
+//
+// Not thread-safe; the owner serializes edits and searches. find() spreads
+// its verification over the shared executor.
+class TextIndex
+{
+public:
+    enum class Mode
+    {
+        Substring,
+        Regex
+    };
+
+    struct Query
+    {
+        QString pattern;
+        Mode mode = Mode::Substring;
+        bool caseSensitive = false;
+    };
+
+    // A query compiled once for checking many rows.
+    class Matcher
+    {
+    public:
+        explicit Matcher(const Query &query);
+
+        const Query &query() const;
+        bool is_valid() const;
+        QString error() const;
+        bool matches(const QString &text) const;
+
+    private:
+        Query query_;
+        QRegularExpression regex_;
+    };
+
+    // Replaces the whole index, building per-chunk postings on the executor.
+    void reset(const QStringList &texts);
+    // Re-indexes one row after its text changed.
+    void set_text(int row, const QString &text);
+
+    int size() const;
+    QString text(int row) const;
+
+    // Rows matching matcher's query in ascending order.
+    QVector<int> find(const Matcher &matcher) const;
+
+    // Literal runs every match of a regular expression must contain, or none
+    // when the pattern is too dynamic to tell.
+    static QStringList required_literals(const QString &pattern);
+
+private:
+    using Trigram = quint64;
+
+    static QVector<Trigram> trigrams(const QString &text);
+    QVector<int> candidates(const Query &query, bool *all_rows) const;
+
+    QStringList texts_;
+    // Rows containing each trigram, ascending.
+    QHash<Trigram, QVector<int>> postings_;
+};
+
+#endif
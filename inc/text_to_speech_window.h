@@ -4,13 +4,20 @@
 #define __TEXT_TO_SPEECH_H__
 
 #include "ui_text_to_speech_window.h"
+#include "executor.h"
+#include "loudness.h"
 #include "settings.h"
+#include "speech_renderer.h"
+#include "tts_cache.h"
 #include <QDialog>
 #include <QWidget>
+#include <QHash>
 #include <QList>
+#include <QSet>
 #include <QString>
 #include <QVector>
 #include <memory>
+#include <string>
 
 namespace Ui
 {
@@ -26,6 +33,8 @@ private:
     QList<QString> openaiModels = {"tts-1", "tts-1-hd", "gpt-4o-mini-tts"};
     QList<QString> openaiVoices = { "alloy", "ash", "ballad", "coral", "echo", "fable", "onyx", "nova", "sage", "shimmer", "verse" };
     Settings settings;
+    QVector<qint64> startTimes_;
+    QVector<qint64> slotDurations_;
     QString outputDirectory_;
     QString defaultOutputDirButtonText_;
 
@@ -35,8 +44,46 @@ public:
         QString text;
         QString duration;
         QString filePath;
+        qint64 startMs = -1;
+        qint64 slotMs = -1;
     };
 
+    // Set for dubbing: each row is translated first and spoken as soon as
+    // its translation arrives.
+    struct Translation
+    {
+        QString provider;
+        QString token;
+        std::string sourceLanguage;
+        std::string targetLanguage;
+    };
+
+private:
+    // A clip request for one row, captured on the GUI thread so the work
+    // itself runs on the executor without touching any widget.
+    struct ConversionJob : SpeechJob
+    {
+        int row = -1;
+    };
+
+    QVector<ConversionJob> conversionQueue_;
+    int conversionsInFlight_ = 0;
+    CancellationToken conversionCancel_;
+    QSet<QString> reservedOutputPaths_;
+
+    // The translation stage of a dub runs beside the conversions, under its
+    // own cap, and feeds each translated row into conversionQueue_.
+    Translation translation_;
+    QList<int> translationQueue_;
+    int translationsInFlight_ = 0;
+    // A dub whose translations all fail reports the problem once.
+    bool translationErrorShown_ = false;
+    QSet<int> translatedRows_;
+
+    // Clip lengths are probed on the executor after set_entries(); a probe
+    // started for an older set of rows is ignored when it lands.
+    int clipProbeGeneration_ = 0;
+
 private:
     void init_general_settings();
     void init_openai_settings();
@@ -45,11 +92,29 @@ private:
     void refresh_output_directory_button();
     void select_output_directory();
     bool ensure_output_directory_selected();
-    QString generate_output_file_path(const QString &text, int row) const;
+    QString generate_output_file_path(const QString &text, int row);
+    TtsCache::Key make_cache_key(const QString &text,
+                                 const QString &provider,
+                                 const QString &voice,
+                                 const QString &model) const;
     void update_table_cell(int row, int column, const QString &value);
     QString format_duration(double seconds) const;
+    bool is_dubbing() const;
+    bool check_speech_provider();
+    bool prepare_conversion(int row, bool warn_if_text_missing, ConversionJob *job);
+    void start_conversion(const ConversionJob &job, Executor::Priority priority);
+    void start_queued_conversions();
+    void finish_conversion(const ConversionJob &job, double seconds);
+    void start_translation(int row, Executor::Priority priority);
+    void finish_translation(int row, const QString &translated, const QString &error);
+    void finish_batch_if_idle();
+    void set_row_busy(int row, bool busy);
     void convert_row(int row, bool warn_if_text_missing = true);
     void convert_all_rows();
+    void export_track();
+    void apply_clip_durations(int generation, const QHash<QString, double> &durations);
+    void normalize_all_clips();
+    void finish_normalization(const Loudness::Report &report, int clipCount, double targetLufs);
     int row_for_button(const QWidget *button) const;
 
 public:
@@ -58,7 +123,17 @@ public:
 
     void set_entries(const QVector<Entry> &entries);
     QVector<Entry> entries() const;
+    Entry entry(int row) const;
+    void set_translation(const Translation &translation);
 
+signals:
+    void conversion_started(int row);
+    void conversion_finished(int row, bool succeeded);
+    // Dubbing only: the row's text now holds its translation, or the
+    // translation failed and the row will not be spoken.
+    void row_translated(int row, bool succeeded);
+    // No row is queued or in flight any more.
+    void batch_finished();
 };
 
 #endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef __TEXT_TRANSFORM_H__
+#define __TEXT_TRANSFORM_H__
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// An ordered list of find/replace and case rules compiled once and run over
+// the subtitle text column in parallel on the shared executor.
+class TextTransform
+{
+public:
+    enum class Kind
+    {
+        Literal,
+        Regex,
+        // Case rules map the spans their pattern matches, or the whole text
+        // when the pattern is empty.
+        Upper,
+        Lower,
+        Sentence
+    };
+
+    struct Rule
+    {
+        Kind kind = Kind::Literal;
+        QString find;
+        QString replace;
+        bool caseSensitive = true;
+        bool enabled = true;
+    };
+
+    struct Preset
+    {
+        QString name;
+        Rule rule;
+    };
+
+    struct Change
+    {
+        int row = -1;
+        QString before;
+        QString after;
+    };
+
+    explicit TextTransform(const QVector<Rule> &rules);
+
+    bool is_valid() const;
+    // Names the first rule that failed to compile.
+    QString error() const;
+
+    QString apply(const QString &text) const;
+    // Rows whose text the rules change, in row order.
+    QVector<Change> run(const QStringList &texts) const;
+
+    static QVector<Preset> presets();
+    static QString kind_name(Kind kind);
+    static Kind kind_from_name(const QString &name);
+    static QByteArray to_json(const QVector<Rule> &rules);
+    static QVector<Rule> from_json(const QByteArray &json);
+
+private:
+    struct Step
+    {
+        Rule rule;
+        QRegularExpression regex;
+    };
+
+    QVector<Step> steps_;
+    QString error_;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef __TEXT_TRANSFORM_WINDOW_H__
+#define __TEXT_TRANSFORM_WINDOW_H__
+
+#include "settings.h"
+#include "text_transform.h"
+#include "ui_text_transform_window.h"
+
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+namespace Ui
+{
+    class TextTransformWindow;
+}
+
+// Edits the cleanup rules, previews what they change and hands the changes
+// back to the editor, which applies them as one undo step.
+class TextTransformWindow : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit TextTransformWindow(QWidget *parent = nullptr);
+    ~TextTransformWindow() override;
+
+    void set_texts(const QStringList &texts);
+    // Valid once the dialog was accepted.
+    QVector<TextTransform::Change> changes() const;
+
+private:
+    std::unique_ptr<Ui::TextTransformWindow> ui;
+    Settings settings;
+    QStringList texts_;
+    QVector<TextTransform::Change> changes_;
+    bool previewCurrent_ = false;
+
+    void add_rule_row(const TextTransform::Rule &rule);
+    void add_rule();
+    void remove_rule();
+    void add_preset();
+    QVector<TextTransform::Rule> rules() const;
+    void save_rules();
+    void rules_edited();
+    bool compute_changes();
+    void preview();
+    void apply();
+};
+
+#endif
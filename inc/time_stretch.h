@@ -0,0 +1,26 @@
+#pragma once
+
+#ifndef __TIME_STRETCH_H__
+#define __TIME_STRETCH_H__
+
+#include <QString>
+
+#include <vector>
+
+// Pitch-preserving time-scale modification (WSOLA). Each output hop copies
+// the input segment that best continues the previous one, found by
+// cross-correlation, so speech keeps its pitch and formants.
+class TimeStretch
+{
+public:
+    // ratio is output length / input length: 0.8 plays 25% faster.
+    static std::vector<float> wsola(const std::vector<float> &input, int channels, int sampleRate, double ratio);
+
+    // Stretches a WAV clip in place towards targetSeconds, limiting the
+    // change to [1 / maxRatio, maxRatio]. Returns false for clips that are
+    // not WAV or could not be rewritten; *resultSeconds receives the new
+    // length.
+    static bool fit_clip(const QString &path, double targetSeconds, double maxRatio, double *resultSeconds);
+};
+
+#endif
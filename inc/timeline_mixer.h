@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef __TIMELINE_MIXER_H__
+#define __TIMELINE_MIXER_H__
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+// Assembles per-cue clips into one continuous track, placing every clip at
+// its subtitle start time and filling the gaps with silence. Only one clip is
+// held in memory at a time, so a feature-length program mixes in bounded RAM.
+class TimelineMixer
+{
+public:
+    struct Cue
+    {
+        qint64 startMs = 0;
+        QString clipPath;
+    };
+
+    struct Report
+    {
+        int placed = 0;
+        int skipped = 0;
+        qint64 overlapMs = 0;
+        QString error;
+    };
+
+    // Called after each cue; returning false cancels the mixdown.
+    using ProgressCallback = std::function<bool(int done, int total)>;
+
+    // Decodes WAV clips and mixes them sample-accurately into a 16-bit WAV.
+    // Clips in other sample rates or channel layouts are converted to the
+    // format of the first clip.
+    static bool mix_to_wav(QVector<Cue> cues,
+                           const QString &outputPath,
+                           Report *report,
+                           const ProgressCallback &progress = {});
+
+    // Concatenates MP3 frames without re-encoding, inserting silent frames to
+    // reach each start time. Placement is accurate to one frame (~26 ms), and
+    // a clip that runs into the next cue delays it instead of overlapping.
+    static bool concat_mp3(QVector<Cue> cues,
+                           const QString &outputPath,
+                           Report *report,
+                           const ProgressCallback &progress = {});
+
+    // Joins clips back to back into one clip of the same type. MP3 frames are
+    // concatenated as they are; WAV clips are crossfaded over crossfadeMs so
+    // the seams do not click. Other containers (Ogg, ADTS) are appended whole.
+    static bool join_clips(const QStringList &clipPaths,
+                           const QString &outputPath,
+                           int crossfadeMs,
+                           QString *errorMessage);
+};
+
+#endif
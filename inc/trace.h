@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+// Scoped timing spans for the editor's hot paths. Every thread records into
+// its own fixed-size ring (oldest spans are overwritten), so recording never
+// takes a lock; export copies the rings into Chrome trace JSON, which
+// chrome://tracing and ui.perfetto.dev open directly.
+//
+// Span timings are recorded only when SRT_EDITOR_ENABLE_TRACING is defined
+// (the CMake option of the same name). Every build still publishes the
+// innermost open scope of each thread, which costs one atomic exchange, so
+// the UI watchdog can say what the GUI thread was doing when it stalled.
+// Span names must be string literals.
+class Trace
+{
+public:
+    static bool enabled();
+    static std::int64_t now_ns();
+    static void record(const char *name, std::int64_t startNs, std::int64_t endNs);
+    // Labels the calling thread in exported traces.
+    static void set_thread_name(const QString &name);
+    static bool write_chrome_json(const QString &path, QString *errorMessage);
+
+    // Innermost open scope on the calling thread. The returned slot lives as
+    // long as the thread and may be read from any other thread.
+    static const std::atomic<const char *> *active_scope_slot();
+    static const char *enter_scope(const char *name);
+    static void leave_scope(const char *previous);
+};
+
+class TraceMarker
+{
+public:
+    explicit TraceMarker(const char *name)
+        : previous_(Trace::enter_scope(name))
+    {
+    }
+
+    ~TraceMarker()
+    {
+        Trace::leave_scope(previous_);
+    }
+
+    TraceMarker(const TraceMarker &) = delete;
+    TraceMarker &operator=(const TraceMarker &) = delete;
+
+private:
+    const char *previous_;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : marker_(name), name_(name), startNs_(Trace::now_ns())
+    {
+    }
+
+    ~TraceSpan()
+    {
+        Trace::record(name_, startNs_, Trace::now_ns());
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    TraceMarker marker_;
+    const char *name_;
+    std::int64_t startNs_;
+};
+
+#define SRT_TRACE_CONCAT_INNER(a, b) a##b
+#define SRT_TRACE_CONCAT(a, b) SRT_TRACE_CONCAT_INNER(a, b)
+
+#ifdef SRT_EDITOR_ENABLE_TRACING
+#define SRT_TRACE_SCOPE(name) const TraceSpan SRT_TRACE_CONCAT(srtTraceSpan, __LINE__)(name)
+#define SRT_TRACE_THREAD_NAME(name) Trace::set_thread_name(name)
+#else
+#define SRT_TRACE_SCOPE(name) const TraceMarker SRT_TRACE_CONCAT(srtTraceMarker, __LINE__)(name)
+#define SRT_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
+
+#endif
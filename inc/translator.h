@@ -15,6 +15,8 @@
 
 #include <curl/curl.h>
 
+#include "provider_metrics.h"
+
 #include <cstdlib>
 #include <string>
 #include <mutex>
@@ -27,10 +29,22 @@ public:
     Translator(/* args */);
     ~Translator();
 
-    QString translate_by_github_model(QString input, std::string src_lang, std::string target_lang, const QString &token);
-    QString translate_by_openai(QString input, std::string src_lang, std::string target_lang, const QString &token);
-    QString translate_by_gemini(QString input, std::string src_lang, std::string target_lang, const QString &token);
-    QString translate_by_google_translate(QString input, std::string src_lang, std::string target_lang, const QString &token);
+    // Dispatches on the provider name shown in Settings; anything unknown
+    // falls through to Google Translate. Safe to call from any thread. On
+    // failure the input comes back unchanged and *error says why; an empty
+    // *error means the result is a translation, even one equal to the input
+    // (names, numbers, "OK"). Nothing is shown in a dialog.
+    QString translate(const QString &provider, QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error = nullptr);
+
+    // The metrics series a provider's requests are recorded under, so a
+    // caller that retries can count its retries there. Empty for providers
+    // that send no request.
+    static MetricLabels metric_labels(const QString &provider, const QString &token);
+
+    QString translate_by_github_model(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error = nullptr);
+    QString translate_by_openai(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error = nullptr);
+    QString translate_by_gemini(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error = nullptr);
+    QString translate_by_google_translate(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error = nullptr);
 };
 
 #endif
@@ -3,6 +3,7 @@
 #include <QDialog>
 #include <memory>
 
+#include "executor.h"
 #include "settings.h"
 #include "ui_translator_window.h"
 #include "translator.h"
@@ -37,14 +38,41 @@ public:
     void setSourceTexts(const QStringList &sourceTexts);
     QStringList targetTexts() const;
 
+signals:
+    void translationStarted(int row);
+    void translationFinished(int row);
+    // No row is queued or in flight any more.
+    void batchFinished();
+
 private slots:
     void refreshModelList(const QString &service);
     void handleTranslateButton();
     void translateAll();
+    void applyCatalogUpdate(const QString &key, const QStringList &models);
 
 private:
+    // Captured on the GUI thread; translation itself runs on the executor.
+    struct TranslationRequest
+    {
+        QString provider;
+        QString token;
+        std::string sourceLanguage;
+        std::string targetLanguage;
+    };
+
     bool validateLanguageInputs();
+    bool prepareTranslation(TranslationRequest *request);
+    static QString translateText(const TranslationRequest &request, const QString &sourceText, QString *error);
+    void startTranslation(int row, const TranslationRequest &request, Executor::Priority priority);
+    void finishTranslation(int row, const QString &translated, const QString &error);
+
     std::unique_ptr<Ui::TranslatorWindow> ui;
+    QString modelCatalogKey;
     Settings settings;
-    Translator translator;
+    TranslationRequest batchRequest;
+    QList<int> pendingRows;
+    int translationsInFlight = 0;
+    // A batch that fails on every row reports the problem once.
+    bool translationErrorShown = false;
+    CancellationToken translationCancel;
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef __TTS_CACHE_H__
+#define __TTS_CACHE_H__
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+
+#include <mutex>
+
+// Content-addressed store of synthesized clips. Clips are keyed by a hash of
+// everything that influences the generated audio, so identical requests are
+// served from disk instead of being re-synthesized (and re-billed).
+class TtsCache
+{
+public:
+    struct Key
+    {
+        QString text;
+        QString provider;
+        QString voice;
+        QString model;
+        QString outputFormat;
+        int speed = 100;
+        QJsonObject voiceSettings;
+
+        QString digest() const;
+    };
+
+    static TtsCache &instance();
+
+    TtsCache(const QString &directory, qint64 maxBytes);
+    ~TtsCache();
+
+    bool fetch(const Key &key, const QString &destinationPath, double *durationSeconds);
+    bool store(const Key &key, const QString &sourcePath, double durationSeconds);
+    void set_max_size(qint64 maxBytes);
+    QString directory() const;
+    // Writes the index if anything changed since the last write. Stores
+    // flush it only every few seconds, so call this when a batch ends.
+    void save();
+
+private:
+    struct Record
+    {
+        QString fileName;
+        qint64 size = 0;
+        QByteArray contentHash;
+        double durationSeconds = 0.0;
+        qint64 lastUsed = 0;
+    };
+
+    void load();
+    void save_locked();
+    void evict_to_fit();
+    void drop(const QString &digest);
+    bool verify(const Record &record) const;
+
+    QString directory_;
+    qint64 maxBytes_ = 0;
+    qint64 totalBytes_ = 0;
+    bool dirty_ = false;
+    QElapsedTimer sinceSave_;
+    QHash<QString, Record> records_;
+    mutable std::mutex mutex_;
+};
+
+#endif
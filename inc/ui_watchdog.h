@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef __UI_WATCHDOG_H__
+#define __UI_WATCHDOG_H__
+
+#include "provider_metrics.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Measures GUI event-loop latency for the whole session. A precise timer on
+// the GUI thread beats every interval and records how late each beat ran;
+// a beat later than the stall threshold is logged as a stall. A monitor
+// thread samples the GUI thread's innermost trace scope while a stall is in
+// progress, so each stall names the code that blocked the loop.
+class UiWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stall
+    {
+        qint64 startedAtMs = 0; // wall clock
+        qint64 durationMs = 0;
+        QString scope;
+    };
+
+    // Must be constructed on the GUI thread.
+    UiWatchdog(int intervalMs, int stallThresholdMs, QObject *parent = nullptr);
+    ~UiWatchdog() override;
+
+    // Session summary as JSON: lag percentiles, stall totals, stalls grouped
+    // by scope and the individual stalls.
+    QByteArray report_json() const;
+    bool write_report(const QString &path, QString *errorMessage) const;
+
+private:
+    void beat();
+    void monitor_loop();
+
+    static constexpr int kMaxStallsKept = 1000;
+
+    const int intervalMs_;
+    const int stallThresholdMs_;
+    QTimer timer_;
+    QElapsedTimer session_;
+    qint64 expectedBeatNs_ = 0;
+
+    LatencyHistogram lag_;
+    QVector<Stall> stalls_;
+    qint64 stallCount_ = 0;
+    qint64 stalledMs_ = 0;
+
+    const std::atomic<const char *> *guiScope_ = nullptr;
+    std::atomic<std::int64_t> lastBeatNs_{0};
+    std::atomic<const char *> stallScope_{nullptr};
+
+    std::mutex monitorMutex_;
+    std::condition_variable monitorWake_;
+    bool stopping_ = false;
+    std::thread monitor_;
+};
+
+#endif
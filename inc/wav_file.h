@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef __WAV_FILE_H__
+#define __WAV_FILE_H__
+
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QString>
+
+#include <vector>
+
+struct WavFormat
+{
+    int sampleRate = 0;
+    int channels = 0;
+    int bitsPerSample = 16;
+    bool isFloat = false;
+
+    int bytes_per_frame() const { return channels * ((bitsPerSample + 7) / 8); }
+};
+
+// Streams interleaved samples out of a RIFF/WAVE file as floats in [-1, 1].
+// Integer PCM (8/16/24/32-bit), IEEE float and WAVE_FORMAT_EXTENSIBLE are
+// understood.
+class WavReader
+{
+public:
+    bool open(const QString &path);
+    void close();
+
+    const WavFormat &format() const { return format_; }
+    qint64 frame_count() const;
+    qint64 read(float *out, qint64 maxFrames);
+    bool seek_frame(qint64 frame);
+
+private:
+    QFile file_;
+    WavFormat format_;
+    qint64 dataOffset_ = 0;
+    qint64 dataBytes_ = 0;
+    qint64 position_ = 0;
+    std::vector<char> scratch_;
+};
+
+// Writes 16-bit PCM incrementally into a temporary file; commit() patches the
+// RIFF sizes and atomically replaces the destination.
+class WavWriter
+{
+public:
+    bool open(const QString &path, const WavFormat &format);
+    bool write(const float *samples, qint64 frameCount);
+    bool write_silence(qint64 frameCount);
+    bool commit();
+    void cancel();
+
+    const WavFormat &format() const { return format_; }
+    qint64 frames_written() const { return framesWritten_; }
+
+private:
+    bool write_header(qint64 dataBytes);
+
+    QSaveFile file_;
+    WavFormat format_;
+    qint64 framesWritten_ = 0;
+    std::vector<qint16> scratch_;
+};
+
+class WavFile
+{
+public:
+    static bool read(const QString &path, WavFormat *format, std::vector<float> *samples);
+    static bool write(const QString &path, const WavFormat &format, const std::vector<float> &samples);
+    static bool is_wav(const QString &path);
+
+    // Canonical 44-byte header for 16-bit PCM with dataBytes of samples.
+    static QByteArray pcm16_header(const WavFormat &format, qint64 dataBytes);
+};
+
+#endif
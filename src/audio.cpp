@@ -1,8 +1,70 @@
 #include "audio.h"
+#include "audio_probe.h"
+#include "executor.h"
+#include "local_tts_engine.h"
+#include "logger.h"
+#include "parallel.h"
+#include "provider_endpoints.h"
+#include "provider_metrics.h"
+#include "provider_scheduler.h"
 #include "settings.h"
+#include "text_chunker.h"
+#include "timeline_mixer.h"
+#include "trace.h"
+#include "wav_file.h"
+
+#include <QApplication>
+#include <QThread>
 
 namespace
 {
+// Speech requests also run on executor threads, but dialogs may only be
+// shown from the GUI thread; messages from elsewhere are posted there.
+void notifyUser(QMessageBox::Icon icon, const QString &title, const QString &text)
+{
+    const auto show = [icon, title, text]() {
+        if (icon == QMessageBox::Information)
+        {
+            QMessageBox::information(nullptr, title, text);
+        }
+        else
+        {
+            QMessageBox::warning(nullptr, title, text);
+        }
+    };
+
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app && !qobject_cast<QApplication *>(app))
+    {
+        // Headless (the command-line tool): nothing can show a dialog.
+        if (icon == QMessageBox::Information)
+        {
+            SRT_LOG_INFO("audio", "{}: {}", title, text);
+        }
+        else
+        {
+            SRT_LOG_WARN("audio", "{}: {}", title, text);
+        }
+        return;
+    }
+    if (!app || QThread::currentThread() == app->thread())
+    {
+        show();
+        return;
+    }
+    postToGui(QPointer<QCoreApplication>(app), show);
+}
+
+void warnUser(const QString &title, const QString &text)
+{
+    notifyUser(QMessageBox::Warning, title, text);
+}
+
+void informUser(const QString &title, const QString &text)
+{
+    notifyUser(QMessageBox::Information, title, text);
+}
+
 size_t writeBinaryCallback(void *contents, size_t size, size_t nmemb, void *userp)
 {
     const size_t totalSize = size * nmemb;
@@ -17,41 +79,169 @@ size_t writeBinaryCallback(void *contents, size_t size, size_t nmemb, void *user
     return totalSize;
 }
 
-void ensureCurlInitialized()
-{
-    static std::once_flag curlInitFlag;
-    std::call_once(curlInitFlag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
-}
+// Responses are spooled to disk in fixed-size blocks so a clip never has to
+// fit in memory and the first bytes land on disk while synthesis continues.
+constexpr size_t kStreamBlockSize = 64 * 1024;
+constexpr size_t kMaxErrorBodySize = 4 * 1024;
 
-bool writeBufferToFile(const std::string &filePath, const std::vector<unsigned char> &buffer)
+struct StreamingFileSink
 {
-    if (filePath.empty() || buffer.empty())
+    explicit StreamingFileSink(const QString &path)
+        : file(path)
     {
-        return false;
+        block.reserve(kStreamBlockSize);
     }
 
-    const QString qFilePath = QString::fromStdString(filePath);
-    const QFileInfo fileInfo(qFilePath);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists())
+    QSaveFile file;
+    std::vector<char> block;
+    QByteArray errorBody;
+    // Set for raw PCM responses: the body is wrapped in a WAV header whose
+    // sizes are patched once the stream ends.
+    WavFormat pcmFormat;
+    CURL *curl = nullptr;
+    long httpStatus = 0;
+    bool statusChecked = false;
+    bool opened = false;
+    bool writeFailed = false;
+    qint64 bytesWritten = 0;
+
+    bool open()
+    {
+        if (opened)
+        {
+            return true;
+        }
+
+        QDir dir = QFileInfo(file.fileName()).dir();
+        if (!dir.exists() && !dir.mkpath(QStringLiteral(".")))
+        {
+            return false;
+        }
+
+        opened = file.open(QIODevice::WriteOnly);
+        if (opened && pcmFormat.sampleRate > 0)
+        {
+            const QByteArray header = WavFile::pcm16_header(pcmFormat, 0);
+            writeFailed = file.write(header) != header.size();
+        }
+        return opened && !writeFailed;
+    }
+
+    bool flushBlock()
+    {
+        if (block.empty())
+        {
+            return true;
+        }
+
+        const qint64 expected = static_cast<qint64>(block.size());
+        const qint64 written = file.write(block.data(), expected);
+        block.clear();
+        if (written != expected)
+        {
+            return false;
+        }
+
+        bytesWritten += written;
+        return true;
+    }
+
+    bool append(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            // Large chunks bypass the staging block once it is drained, so
+            // writes always happen in whole blocks until the final flush.
+            if (block.empty() && size >= kStreamBlockSize)
+            {
+                const size_t direct = size - (size % kStreamBlockSize);
+                const qint64 written = file.write(data, static_cast<qint64>(direct));
+                if (written != static_cast<qint64>(direct))
+                {
+                    return false;
+                }
+                bytesWritten += written;
+                data += direct;
+                size -= direct;
+                continue;
+            }
+
+            const size_t room = kStreamBlockSize - block.size();
+            const size_t take = std::min(room, size);
+            block.insert(block.end(), data, data + take);
+            data += take;
+            size -= take;
+
+            if (block.size() == kStreamBlockSize && !flushBlock())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool finish()
     {
-        if (!dir.mkpath(QStringLiteral(".")))
+        if (!opened || writeFailed || !flushBlock())
         {
+            file.cancelWriting();
             return false;
         }
+        if (pcmFormat.sampleRate > 0)
+        {
+            const qint64 dataBytes = bytesWritten - bytesWritten % pcmFormat.bytes_per_frame();
+            const QByteArray header = WavFile::pcm16_header(pcmFormat, dataBytes);
+            if (!file.seek(0) || file.write(header) != header.size())
+            {
+                file.cancelWriting();
+                return false;
+            }
+        }
+        return bytesWritten > 0 && file.commit();
     }
+};
 
-    QFile file(qFilePath);
-    if (!file.open(QIODevice::WriteOnly))
+size_t writeStreamingCallback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    const size_t totalSize = size * nmemb;
+    if (totalSize == 0 || userp == nullptr)
     {
-        return false;
+        return 0;
     }
 
-    const qint64 written = file.write(reinterpret_cast<const char *>(buffer.data()),
-                                      static_cast<qint64>(buffer.size()));
-    file.close();
+    auto *sink = static_cast<StreamingFileSink *>(userp);
+    if (!sink->statusChecked)
+    {
+        curl_easy_getinfo(sink->curl, CURLINFO_RESPONSE_CODE, &sink->httpStatus);
+        sink->statusChecked = true;
+    }
 
-    return written == static_cast<qint64>(buffer.size());
+    const auto *data = static_cast<const char *>(contents);
+    if (sink->httpStatus >= 400)
+    {
+        // Keep a bounded copy of the error body instead of writing it as audio.
+        const size_t stored = static_cast<size_t>(sink->errorBody.size());
+        if (stored < kMaxErrorBodySize)
+        {
+            const size_t take = std::min(kMaxErrorBodySize - stored, totalSize);
+            sink->errorBody.append(data, static_cast<int>(take));
+        }
+        return totalSize;
+    }
+
+    if (!sink->open() || !sink->append(data, totalSize))
+    {
+        sink->writeFailed = true;
+        return 0;
+    }
+
+    return totalSize;
+}
+
+void ensureCurlInitialized()
+{
+    static std::once_flag curlInitFlag;
+    std::call_once(curlInitFlag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
 }
 
 QString describeCurlFailure(CURLcode code, long httpStatus)
@@ -68,7 +258,265 @@ QString describeCurlFailure(CURLcode code, long httpStatus)
     return message;
 }
 
-QByteArray performElevenLabsJsonGet(const QByteArray &url,
+enum class SpeechRequestError
+{
+    None,
+    Initialization,
+    Network,
+    Save
+};
+
+// Negotiated response encoding. Formats without a provider-side WAV
+// container are requested as raw 16-bit mono PCM and wrapped locally.
+struct SpeechFormat
+{
+    QString extension;
+    int pcmSampleRate = 0;
+};
+
+constexpr int kPcmSampleRate = 24000;
+
+SpeechFormat speechFormatForPath(const std::string &filePath)
+{
+    SpeechFormat format;
+    format.extension = QFileInfo(QString::fromStdString(filePath)).suffix().toLower();
+    if (format.extension == QLatin1String("wav"))
+    {
+        format.pcmSampleRate = kPcmSampleRate;
+    }
+    return format;
+}
+
+QByteArray acceptHeaderFor(const SpeechFormat &format)
+{
+    if (format.pcmSampleRate > 0)
+    {
+        return QByteArrayLiteral("Accept: audio/pcm");
+    }
+    if (format.extension == QLatin1String("opus"))
+    {
+        return QByteArrayLiteral("Accept: audio/ogg");
+    }
+    if (format.extension == QLatin1String("aac"))
+    {
+        return QByteArrayLiteral("Accept: audio/aac");
+    }
+    return QByteArrayLiteral("Accept: audio/mpeg");
+}
+
+SpeechRequestError performStreamingSpeechRequest(const QByteArray &url,
+                                                 const QList<QByteArray> &headerLines,
+                                                 const QByteArray &body,
+                                                 const std::string &filePath,
+                                                 int pcmSampleRate,
+                                                 const MetricLabels &metricLabels,
+                                                 QString *errorMessage)
+{
+    if (filePath.empty())
+    {
+        return SpeechRequestError::Save;
+    }
+
+    ensureCurlInitialized();
+
+    CURL *curl = curl_easy_init();
+    if (!curl)
+    {
+        return SpeechRequestError::Initialization;
+    }
+
+    struct curl_slist *headers = nullptr;
+    for (const QByteArray &line : headerLines)
+    {
+        headers = curl_slist_append(headers, line.constData());
+    }
+
+    StreamingFileSink sink(QString::fromStdString(filePath));
+    sink.curl = curl;
+    if (pcmSampleRate > 0)
+    {
+        sink.pcmFormat.sampleRate = pcmSampleRate;
+        sink.pcmFormat.channels = 1;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.constData());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.constData());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeStreamingCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+    curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, static_cast<long>(kStreamBlockSize));
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 15L);
+    // Long narration can legitimately stream for minutes; abort on stalls
+    // rather than on total duration.
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 600L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
+
+    CURLcode res = CURLE_OK;
+    // Shares the per-provider limits with translation and every other clip.
+    ProviderScheduler &scheduler = ProviderScheduler::instance();
+    scheduler.share_caches(curl);
+    {
+        const ProviderScheduler::Permit permit = scheduler.acquire(metricLabels.provider);
+        SRT_TRACE_SCOPE("Audio::speech_request");
+        res = curl_easy_perform(curl);
+        permit.complete(curl);
+    }
+    ProviderMetrics::instance().record_curl(metricLabels, curl, res);
+    long httpStatus = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+
+    if (headers)
+    {
+        curl_slist_free_all(headers);
+    }
+    curl_easy_cleanup(curl);
+
+    if (sink.writeFailed)
+    {
+        sink.file.cancelWriting();
+        return SpeechRequestError::Save;
+    }
+
+    if (res != CURLE_OK || httpStatus >= 400)
+    {
+        sink.file.cancelWriting();
+        if (errorMessage)
+        {
+            *errorMessage = describeCurlFailure(res, httpStatus);
+            const QString detail = QString::fromUtf8(sink.errorBody).trimmed();
+            if (!detail.isEmpty())
+            {
+                *errorMessage += QStringLiteral("\n\n") + detail.left(512);
+            }
+        }
+        return SpeechRequestError::Network;
+    }
+
+    if (!sink.opened)
+    {
+        // An empty body is reported like any other failed request.
+        if (errorMessage)
+        {
+            *errorMessage = describeCurlFailure(res, httpStatus);
+        }
+        return SpeechRequestError::Network;
+    }
+
+    if (!sink.finish())
+    {
+        return SpeechRequestError::Save;
+    }
+
+    return SpeechRequestError::None;
+}
+
+// Per-request input limits, in characters.
+constexpr int kOpenAIMaxInputChars = 4096;
+constexpr int kElevenLabsMaxInputChars = 5000;
+// Longer text is split into chunks of about this size and synthesized
+// concurrently, which cuts latency well before a hard limit is reached.
+constexpr int kParallelChunkChars = 1000;
+constexpr int kMaxConcurrentChunkRequests = 4;
+constexpr int kChunkCrossfadeMs = 15;
+
+// Synthesizes one request per body concurrently into part files next to
+// filePath, then joins the parts in order into filePath.
+SpeechRequestError performChunkedSpeechRequest(const QByteArray &url,
+                                               const QList<QByteArray> &headerLines,
+                                               const QList<QByteArray> &bodies,
+                                               const std::string &filePath,
+                                               int pcmSampleRate,
+                                               const MetricLabels &metricLabels,
+                                               QString *errorMessage)
+{
+    if (bodies.size() == 1)
+    {
+        return performStreamingSpeechRequest(url, headerLines, bodies.first(), filePath, pcmSampleRate, metricLabels, errorMessage);
+    }
+
+    // curl_global_init is not thread-safe; run it before the workers start.
+    ensureCurlInitialized();
+
+    const QFileInfo target(QString::fromStdString(filePath));
+    QStringList partPaths;
+    for (int i = 0; i < bodies.size(); ++i)
+    {
+        partPaths.append(target.dir().filePath(
+            QStringLiteral("%1.part%2.%3").arg(target.completeBaseName()).arg(i).arg(target.suffix())));
+    }
+
+    const int count = static_cast<int>(bodies.size());
+    std::vector<SpeechRequestError> errors(static_cast<size_t>(count), SpeechRequestError::None);
+    std::vector<QString> messages(static_cast<size_t>(count));
+    parallelFor(
+        count,
+        [&](int index) {
+            errors[static_cast<size_t>(index)] = performStreamingSpeechRequest(url,
+                                                                               headerLines,
+                                                                               bodies.at(index),
+                                                                               partPaths.at(index).toStdString(),
+                                                                               pcmSampleRate,
+                                                                               metricLabels,
+                                                                               &messages[static_cast<size_t>(index)]);
+        },
+        kMaxConcurrentChunkRequests,
+        Executor::io());
+
+    auto removeParts = [&partPaths]() {
+        for (const QString &path : partPaths)
+        {
+            QFile::remove(path);
+        }
+    };
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (errors[static_cast<size_t>(i)] != SpeechRequestError::None)
+        {
+            removeParts();
+            if (errorMessage)
+            {
+                *errorMessage = messages[static_cast<size_t>(i)];
+            }
+            return errors[static_cast<size_t>(i)];
+        }
+    }
+
+    const bool joined = TimelineMixer::join_clips(partPaths, target.filePath(), kChunkCrossfadeMs, errorMessage);
+    removeParts();
+    return joined ? SpeechRequestError::None : SpeechRequestError::Save;
+}
+
+void reportSpeechRequestError(SpeechRequestError error,
+                              const QString &provider,
+                              const QString &networkMessage,
+                              const std::string &filePath)
+{
+    switch (error)
+    {
+    case SpeechRequestError::None:
+        break;
+    case SpeechRequestError::Initialization:
+        warnUser(QObject::tr("Failed to initialize"),
+                 QObject::tr("Unable to initialize network stack for %1 request.").arg(provider));
+        break;
+    case SpeechRequestError::Network:
+        warnUser(QObject::tr("Conversion failed"),
+                 networkMessage);
+        break;
+    case SpeechRequestError::Save:
+        warnUser(QObject::tr("Save failed"),
+                 QObject::tr("Unable to write synthesized speech to %1.")
+                     .arg(QString::fromStdString(filePath)));
+        break;
+    }
+}
+
+QByteArray performElevenLabsJsonGet(const QString &path,
                                     const QString &token,
                                     bool silent,
                                     const QString &errorTitle,
@@ -90,6 +538,7 @@ QByteArray performElevenLabsJsonGet(const QByteArray &url,
     headers = curl_slist_append(headers, "Accept: application/json");
     headers = curl_slist_append(headers, authHeader.c_str());
 
+    const QByteArray url = ProviderEndpoints::url(QStringLiteral("elevenlabs"), path);
     curl_easy_setopt(curl, CURLOPT_URL, url.constData());
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
@@ -98,7 +547,12 @@ QByteArray performElevenLabsJsonGet(const QByteArray &url,
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
 
-    const CURLcode res = curl_easy_perform(curl);
+    CURLcode res = CURLE_OK;
+    {
+        SRT_TRACE_SCOPE("Audio::elevenlabs_catalog_request");
+        res = curl_easy_perform(curl);
+    }
+    ProviderMetrics::instance().record_curl(ProviderMetrics::labels(QStringLiteral("elevenlabs"), path, token), curl, res);
     long httpStatus = 0;
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
     if (outStatus)
@@ -118,9 +572,8 @@ QByteArray performElevenLabsJsonGet(const QByteArray &url,
 
     if (!silent && (res != CURLE_OK || httpStatus >= 400))
     {
-        QMessageBox::warning(nullptr,
-                             errorTitle,
-                             describeCurlFailure(res, httpStatus));
+        warnUser(errorTitle,
+                 describeCurlFailure(res, httpStatus));
         return {};
     }
 
@@ -168,32 +621,30 @@ void Audio::elevenlabs_text_to_speech(QString text,
                                       std::string filePath,
                                       QString voice,
                                       QString model,
-                                      std::string token)
+                                      std::string token,
+                                      double speed)
 {
     const QString trimmedText = text.trimmed();
     if (trimmedText.isEmpty())
     {
-        QMessageBox::information(nullptr,
-                                 QObject::tr("Nothing to convert"),
-                                 QObject::tr("Please provide text before requesting speech synthesis."));
+        informUser(QObject::tr("Nothing to convert"),
+                   QObject::tr("Please provide text before requesting speech synthesis."));
         return;
     }
 
     const QString trimmedToken = QString::fromStdString(token).trimmed();
     if (trimmedToken.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("An ElevenLabs API key is required to generate speech."));
+        warnUser(QObject::tr("Missing API key"),
+                 QObject::tr("An ElevenLabs API key is required to generate speech."));
         return;
     }
 
     QString voiceId = voice.trimmed();
     if (voiceId.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing voice"),
-                             QObject::tr("Please provide a valid ElevenLabs voice identifier."));
+        warnUser(QObject::tr("Missing voice"),
+                 QObject::tr("Please provide a valid ElevenLabs voice identifier."));
         return;
     }
 
@@ -203,84 +654,85 @@ void Audio::elevenlabs_text_to_speech(QString text,
         modelId = QStringLiteral("eleven_turbo_v2");
     }
 
-    ensureCurlInitialized();
-
-    CURL *curl = curl_easy_init();
-    if (!curl)
+    const SpeechFormat format = speechFormatForPath(filePath);
+    QString outputFormat = QStringLiteral("mp3_44100_128");
+    if (format.pcmSampleRate > 0)
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Failed to initialize"),
-                             QObject::tr("Unable to initialize network stack for ElevenLabs request."));
-        return;
+        outputFormat = QStringLiteral("pcm_%1").arg(format.pcmSampleRate);
+    }
+    else if (format.extension == QLatin1String("opus"))
+    {
+        outputFormat = QStringLiteral("opus_48000_64");
     }
 
-    std::vector<unsigned char> audioBuffer;
-    struct curl_slist *headers = nullptr;
-
-    const std::string authHeader = "xi-api-key: " + trimmedToken.toStdString();
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Accept: audio/mpeg");
-    headers = curl_slist_append(headers, authHeader.c_str());
+    QList<QByteArray> headers;
+    headers << QByteArrayLiteral("Content-Type: application/json");
+    headers << acceptHeaderFor(format);
+    headers << QByteArray("xi-api-key: ") + trimmedToken.toUtf8();
 
-    QJsonObject payload{{QStringLiteral("text"), trimmedText},
-                        {QStringLiteral("model_id"), modelId},
+    QJsonObject payload{{QStringLiteral("model_id"), modelId},
                         {QStringLiteral("voice_id"), voiceId}};
 
-    const QByteArray jsonBytes = QJsonDocument(payload).toJson(QJsonDocument::Compact);
-
-    QString endpoint = QStringLiteral("https://api.elevenlabs.io/v1/text-to-speech/%1").arg(voiceId);
-
-    curl_easy_setopt(curl, CURLOPT_URL, endpoint.toUtf8().constData());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonBytes.constData());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(jsonBytes.size()));
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBinaryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &audioBuffer);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
-
-    const CURLcode res = curl_easy_perform(curl);
-    long httpStatus = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
-
-    if (headers)
+    // ElevenLabs only accepts a narrow speed range; anything beyond it is
+    // left to the local time-stretch stage.
+    if (std::abs(speed - 1.0) > 1e-3)
     {
-        curl_slist_free_all(headers);
+        payload.insert(QStringLiteral("voice_settings"),
+                       QJsonObject{{QStringLiteral("speed"), std::clamp(speed, 0.7, 1.2)}});
     }
-    curl_easy_cleanup(curl);
 
-    if (res != CURLE_OK || httpStatus >= 400 || audioBuffer.empty())
+    // Neighbouring chunks are passed as context so intonation carries across
+    // the seams.
+    const QStringList chunks = TextChunker::split_balanced(trimmedText, kParallelChunkChars, kElevenLabsMaxInputChars);
+    QList<QByteArray> bodies;
+    for (int i = 0; i < chunks.size(); ++i)
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Conversion failed"),
-                             describeCurlFailure(res, httpStatus));
-        return;
+        QJsonObject chunkPayload = payload;
+        chunkPayload.insert(QStringLiteral("text"), chunks.at(i));
+        if (i > 0)
+        {
+            chunkPayload.insert(QStringLiteral("previous_text"), chunks.at(i - 1));
+        }
+        if (i + 1 < chunks.size())
+        {
+            chunkPayload.insert(QStringLiteral("next_text"), chunks.at(i + 1));
+        }
+        bodies.append(QJsonDocument(chunkPayload).toJson(QJsonDocument::Compact));
     }
 
-    if (!writeBufferToFile(filePath, audioBuffer))
-    {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Save failed"),
-                             QObject::tr("Unable to write synthesized speech to %1.")
-                                 .arg(QString::fromStdString(filePath)));
-    }
+    // The streaming endpoint starts sending audio before synthesis completes.
+    const QByteArray endpoint = ProviderEndpoints::url(QStringLiteral("elevenlabs"),
+                                                       QStringLiteral("text-to-speech/%1/stream?output_format=%2")
+                                                           .arg(QString::fromUtf8(QUrl::toPercentEncoding(voiceId)), outputFormat));
+
+    QString networkMessage;
+    const SpeechRequestError error = performChunkedSpeechRequest(endpoint,
+                                                                 headers,
+                                                                 bodies,
+                                                                 filePath,
+                                                                 format.pcmSampleRate,
+                                                                 metric_labels(QStringLiteral("ElevenLabs"), trimmedToken),
+                                                                 &networkMessage);
+    reportSpeechRequestError(error, QStringLiteral("ElevenLabs"), networkMessage, filePath);
 }
 
-QList<QString> Audio::elevenlabs_get_voices(const QString &token)
+QList<QString> Audio::elevenlabs_get_voices(const QString &token, bool silent)
 {
     const QString trimmedToken = token.trimmed();
     if (trimmedToken.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("Please configure an API key for ElevenLabs in Settings ▸ Audio."));
+        if (silent)
+        {
+            return {};
+        }
+        warnUser(QObject::tr("Missing API key"),
+                 QObject::tr("Please configure an API key for ElevenLabs in Settings ▸ Audio."));
         return {};
     }
 
     long httpStatus = 0;
     CURLcode curlCode = CURLE_OK;
-    const QByteArray payload = performElevenLabsJsonGet(QByteArrayLiteral("https://api.elevenlabs.io/v1/voices"),
+    const QByteArray payload = performElevenLabsJsonGet(QStringLiteral("voices"),
                                                         trimmedToken,
                                                         true,
                                                         QObject::tr("Unable to fetch voices"),
@@ -288,17 +740,19 @@ QList<QString> Audio::elevenlabs_get_voices(const QString &token)
                                                         &curlCode);
     if (payload.isEmpty())
     {
+        if (silent)
+        {
+            return {};
+        }
         if (httpStatus == 401)
         {
-            QMessageBox::warning(nullptr,
-                                 QObject::tr("Invalid ElevenLabs API key"),
-                                 QObject::tr("Your ElevenLabs API key was rejected (HTTP 401). Please update it in Settings ▸ Audio."));
+            warnUser(QObject::tr("Invalid ElevenLabs API key"),
+                     QObject::tr("Your ElevenLabs API key was rejected (HTTP 401). Please update it in Settings ▸ Audio."));
         }
         else if (httpStatus >= 400 || curlCode != CURLE_OK)
         {
-            QMessageBox::warning(nullptr,
-                                 QObject::tr("Unable to fetch voices"),
-                                 describeCurlFailure(curlCode, httpStatus));
+            warnUser(QObject::tr("Unable to fetch voices"),
+                     describeCurlFailure(curlCode, httpStatus));
         }
         return {};
     }
@@ -317,20 +771,23 @@ QList<QString> Audio::elevenlabs_get_voices(const QString &token)
     return {};
 }
 
-QList<QString> Audio::elevenlabs_get_models(const QString &token)
+QList<QString> Audio::elevenlabs_get_models(const QString &token, bool silent)
 {
     const QString trimmedToken = token.trimmed();
     if (trimmedToken.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("Please configure an API key for ElevenLabs in Settings ▸ Audio."));
+        if (silent)
+        {
+            return {};
+        }
+        warnUser(QObject::tr("Missing API key"),
+                 QObject::tr("Please configure an API key for ElevenLabs in Settings ▸ Audio."));
         return {};
     }
 
     long httpStatus = 0;
     CURLcode curlCode = CURLE_OK;
-    const QByteArray payload = performElevenLabsJsonGet(QByteArrayLiteral("https://api.elevenlabs.io/v1/models"),
+    const QByteArray payload = performElevenLabsJsonGet(QStringLiteral("models"),
                                                         trimmedToken,
                                                         true,
                                                         QObject::tr("Unable to fetch models"),
@@ -338,17 +795,19 @@ QList<QString> Audio::elevenlabs_get_models(const QString &token)
                                                         &curlCode);
     if (payload.isEmpty())
     {
+        if (silent)
+        {
+            return {};
+        }
         if (httpStatus == 401)
         {
-            QMessageBox::warning(nullptr,
-                                 QObject::tr("Invalid ElevenLabs API key"),
-                                 QObject::tr("Your ElevenLabs API key was rejected (HTTP 401). Please update it in Settings ▸ Audio."));
+            warnUser(QObject::tr("Invalid ElevenLabs API key"),
+                     QObject::tr("Your ElevenLabs API key was rejected (HTTP 401). Please update it in Settings ▸ Audio."));
         }
         else if (httpStatus >= 400 || curlCode != CURLE_OK)
         {
-            QMessageBox::warning(nullptr,
-                                 QObject::tr("Unable to fetch models"),
-                                 describeCurlFailure(curlCode, httpStatus));
+            warnUser(QObject::tr("Unable to fetch models"),
+                     describeCurlFailure(curlCode, httpStatus));
         }
         return {};
     }
@@ -376,23 +835,22 @@ void Audio::openai_text_to_speech(QString text,
                                   std::string filePath,
                                   QString voice,
                                   QString model,
-                                  std::string token)
+                                  std::string token,
+                                  double speed)
 {
     const QString trimmedText = text.trimmed();
     if (trimmedText.isEmpty())
     {
-        QMessageBox::information(nullptr,
-                                 QObject::tr("Nothing to convert"),
-                                 QObject::tr("Please provide text before requesting speech synthesis."));
+        informUser(QObject::tr("Nothing to convert"),
+                   QObject::tr("Please provide text before requesting speech synthesis."));
         return;
     }
 
     const QString trimmedToken = QString::fromStdString(token).trimmed();
     if (trimmedToken.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("An OpenAI API key is required to generate speech."));
+        warnUser(QObject::tr("Missing API key"),
+                 QObject::tr("An OpenAI API key is required to generate speech."));
         return;
     }
 
@@ -408,67 +866,119 @@ void Audio::openai_text_to_speech(QString text,
         modelName = QStringLiteral("gpt-4o-mini-tts");
     }
 
-    ensureCurlInitialized();
-
-    CURL *curl = curl_easy_init();
-    if (!curl)
+    // OpenAI's pcm format is 24 kHz 16-bit mono, which matches kPcmSampleRate.
+    const SpeechFormat format = speechFormatForPath(filePath);
+    QString responseFormat = QStringLiteral("mp3");
+    if (format.pcmSampleRate > 0)
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Failed to initialize"),
-                             QObject::tr("Unable to initialize network stack for OpenAI request."));
-        return;
+        responseFormat = QStringLiteral("pcm");
+    }
+    else if (format.extension == QLatin1String("opus") || format.extension == QLatin1String("aac"))
+    {
+        responseFormat = format.extension;
     }
 
-    std::vector<unsigned char> audioBuffer;
-    struct curl_slist *headers = nullptr;
-
-    const std::string authHeader = "Authorization: Bearer " + trimmedToken.toStdString();
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Accept: audio/mpeg");
-    headers = curl_slist_append(headers, authHeader.c_str());
+    QList<QByteArray> headers;
+    headers << QByteArrayLiteral("Content-Type: application/json");
+    headers << acceptHeaderFor(format);
+    headers << QByteArray("Authorization: Bearer ") + trimmedToken.toUtf8();
 
     QJsonObject payload{
         {QStringLiteral("model"), modelName},
         {QStringLiteral("voice"), voiceName},
-        {QStringLiteral("input"), trimmedText},
-        {QStringLiteral("response_format"), QStringLiteral("mp3")}};
-    
-    const QByteArray jsonBytes = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+        {QStringLiteral("response_format"), responseFormat}};
 
-    curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/audio/speech");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonBytes.constData());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(jsonBytes.size()));
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBinaryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &audioBuffer);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
+    if (std::abs(speed - 1.0) > 1e-3)
+    {
+        payload.insert(QStringLiteral("speed"), std::clamp(speed, 0.25, 4.0));
+    }
 
-    const CURLcode res = curl_easy_perform(curl);
-    long httpStatus = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+    QList<QByteArray> bodies;
+    for (const QString &chunk : TextChunker::split_balanced(trimmedText, kParallelChunkChars, kOpenAIMaxInputChars))
+    {
+        QJsonObject chunkPayload = payload;
+        chunkPayload.insert(QStringLiteral("input"), chunk);
+        bodies.append(QJsonDocument(chunkPayload).toJson(QJsonDocument::Compact));
+    }
 
-    if (headers)
+    // OpenAI sends the speech body chunked as it is generated.
+    QString networkMessage;
+    const SpeechRequestError error = performChunkedSpeechRequest(ProviderEndpoints::url(QStringLiteral("openai"), QStringLiteral("audio/speech")),
+                                                                 headers,
+                                                                 bodies,
+                                                                 filePath,
+                                                                 format.pcmSampleRate,
+                                                                 metric_labels(QStringLiteral("OpenAI"), trimmedToken),
+                                                                 &networkMessage);
+    reportSpeechRequestError(error, QStringLiteral("OpenAI"), networkMessage, filePath);
+}
+
+MetricLabels Audio::metric_labels(const QString &provider, const QString &token)
+{
+    // The same dispatch as SpeechRenderer::render().
+    if (provider.compare(QStringLiteral("Local"), Qt::CaseInsensitive) == 0)
     {
-        curl_slist_free_all(headers);
+        return {};
+    }
+    if (provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
+    {
+        return ProviderMetrics::labels(QStringLiteral("openai"), QStringLiteral("audio/speech"), token.trimmed());
+    }
+    return ProviderMetrics::labels(QStringLiteral("elevenlabs"), QStringLiteral("text-to-speech/stream"), token.trimmed());
+}
+
+QString Audio::output_extension(const QString &provider, const QString &requested)
+{
+    QString extension = requested.trimmed().toLower();
+    if (extension.startsWith(QLatin1Char('.')))
+    {
+        extension.remove(0, 1);
     }
-    curl_easy_cleanup(curl);
 
-    if (res != CURLE_OK || httpStatus >= 400 || audioBuffer.empty())
+    if (provider.compare(QStringLiteral("Local"), Qt::CaseInsensitive) == 0)
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Conversion failed"),
-                             describeCurlFailure(res, httpStatus));
+        return QStringLiteral("wav");
+    }
+
+    QStringList supported{QStringLiteral("mp3"), QStringLiteral("wav"), QStringLiteral("opus")};
+    if (provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
+    {
+        supported << QStringLiteral("aac");
+    }
+    return supported.contains(extension) ? extension : QStringLiteral("mp3");
+}
+
+void Audio::local_text_to_speech(QString text, std::string filePath, double speed)
+{
+    const QString trimmedText = text.trimmed();
+    if (trimmedText.isEmpty())
+    {
+        informUser(QObject::tr("Nothing to convert"),
+                   QObject::tr("Please provide text before requesting speech synthesis."));
+        return;
+    }
+
+    Settings settings;
+    LocalTtsEngine::Config config;
+    config.executable = settings.value(QStringLiteral("tts/local/executable"), QStringLiteral("piper")).toString().trimmed();
+    config.model = settings.value(QStringLiteral("tts/local/model")).toString().trimmed();
+    config.workers = settings.value(QStringLiteral("tts/local/workers"), 2).toInt();
+    // Piper's length scale is the inverse of a playback-rate multiplier.
+    config.lengthScale = 1.0 / std::clamp(speed, 0.25, 4.0);
+
+    const QString outputPath = QString::fromStdString(filePath);
+    const QDir outputDir = QFileInfo(outputPath).dir();
+    if (!outputDir.exists() && !outputDir.mkpath(QStringLiteral(".")))
+    {
+        reportSpeechRequestError(SpeechRequestError::Save, QStringLiteral("Local"), QString(), filePath);
         return;
     }
 
-    if (!writeBufferToFile(filePath, audioBuffer))
+    QString errorMessage;
+    if (!LocalTtsEngine::instance().synthesize(trimmedText, outputPath, config, &errorMessage))
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Save failed"),
-                             QObject::tr("Unable to write synthesized speech to %1.")
-                                 .arg(QString::fromStdString(filePath)));
+        QFile::remove(outputPath);
+        reportSpeechRequestError(SpeechRequestError::Network, QStringLiteral("Local"), errorMessage, filePath);
     }
 }
 
@@ -485,6 +995,15 @@ double Audio::get_audio_duration_seconds(const std::string &filePath)
         return 0.0;
     }
 
+    // Header probing covers MP3 and WAV; TagLib remains the fallback for
+    // every other container.
+    const double probedSeconds = AudioProbe::probe_duration(qFilePath);
+    if (probedSeconds > 0.0)
+    {
+        return probedSeconds;
+    }
+
+    SRT_TRACE_SCOPE("Audio::taglib_probe");
 #ifdef _WIN32
     const std::wstring widePath = qFilePath.toStdWString();
     TagLib::FileRef fileRef(widePath.c_str());
@@ -0,0 +1,439 @@
+#include "audio_probe.h"
+
+#include "parallel.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+using Mp3Frame = AudioProbe::Mp3Frame;
+
+constexpr int kBitrates[2][3][16] = {
+    {{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, -1},
+     {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, -1},
+     {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, -1}},
+    {{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256, -1},
+     {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, -1},
+     {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, -1}}};
+
+constexpr int kSampleRates[3][3] = {{44100, 48000, 32000},
+                                    {22050, 24000, 16000},
+                                    {11025, 12000, 8000}};
+
+quint32 readBigEndian32(const unsigned char *p)
+{
+    return (static_cast<quint32>(p[0]) << 24) | (static_cast<quint32>(p[1]) << 16) |
+           (static_cast<quint32>(p[2]) << 8) | static_cast<quint32>(p[3]);
+}
+
+quint32 readLittleEndian32(const unsigned char *p)
+{
+    return (static_cast<quint32>(p[3]) << 24) | (static_cast<quint32>(p[2]) << 16) |
+           (static_cast<quint32>(p[1]) << 8) | static_cast<quint32>(p[0]);
+}
+
+quint16 readLittleEndian16(const unsigned char *p)
+{
+    return static_cast<quint16>(p[0] | (p[1] << 8));
+}
+
+bool parseMp3Header(const unsigned char *p, Mp3Frame *frame)
+{
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0)
+    {
+        return false;
+    }
+
+    const int versionBits = (p[1] >> 3) & 0x03;
+    const int layerBits = (p[1] >> 1) & 0x03;
+    const int bitrateIndex = (p[2] >> 4) & 0x0F;
+    const int sampleRateIndex = (p[2] >> 2) & 0x03;
+    const int padding = (p[2] >> 1) & 0x01;
+    const int channelMode = (p[3] >> 6) & 0x03;
+
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3)
+    {
+        // Reserved values, or free-format streams whose frame size cannot be
+        // derived from the header alone.
+        return false;
+    }
+
+    frame->version = versionBits == 3 ? 1 : (versionBits == 2 ? 2 : 3);
+    frame->layer = 4 - layerBits;
+    frame->bitrateKbps = kBitrates[frame->version == 1 ? 0 : 1][frame->layer - 1][bitrateIndex];
+    frame->sampleRate = kSampleRates[frame->version - 1][sampleRateIndex];
+    frame->mono = channelMode == 3;
+
+    const int bitrate = frame->bitrateKbps * 1000;
+    if (frame->layer == 1)
+    {
+        frame->samplesPerFrame = 384;
+        frame->length = (12 * bitrate / frame->sampleRate + padding) * 4;
+    }
+    else if (frame->layer == 2 || frame->version == 1)
+    {
+        frame->samplesPerFrame = 1152;
+        frame->length = 144 * bitrate / frame->sampleRate + padding;
+    }
+    else
+    {
+        frame->samplesPerFrame = 576;
+        frame->length = 72 * bitrate / frame->sampleRate + padding;
+    }
+
+    return frame->length >= 4;
+}
+
+qint64 skipId3v2(const unsigned char *data, qint64 size)
+{
+    qint64 offset = 0;
+    // Some encoders emit several tags back to back.
+    while (offset + 10 <= size && data[offset] == 'I' && data[offset + 1] == 'D' && data[offset + 2] == '3')
+    {
+        const unsigned char *p = data + offset;
+        const qint64 tagSize = (static_cast<qint64>(p[6] & 0x7F) << 21) | (static_cast<qint64>(p[7] & 0x7F) << 14) |
+                               (static_cast<qint64>(p[8] & 0x7F) << 7) | static_cast<qint64>(p[9] & 0x7F);
+        const bool hasFooter = (p[5] & 0x10) != 0;
+        offset += 10 + tagSize + (hasFooter ? 10 : 0);
+    }
+    return offset;
+}
+
+// Finds the first header that is followed by another valid header, which
+// rules out stray 0xFFE bit patterns inside tags or junk.
+qint64 findFirstFrame(const unsigned char *data, qint64 size, qint64 offset, Mp3Frame *frame)
+{
+    for (; offset + 4 <= size; ++offset)
+    {
+        if (!parseMp3Header(data + offset, frame))
+        {
+            continue;
+        }
+
+        const qint64 next = offset + frame->length;
+        Mp3Frame nextFrame;
+        if (next + 4 > size || parseMp3Header(data + next, &nextFrame))
+        {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+int sideInfoSize(const Mp3Frame &frame)
+{
+    if (frame.version == 1)
+    {
+        return frame.mono ? 17 : 32;
+    }
+    return frame.mono ? 9 : 17;
+}
+
+bool hasXingTag(const unsigned char *data, qint64 size, qint64 frameOffset, const Mp3Frame &frame)
+{
+    const qint64 xingOffset = frameOffset + 4 + sideInfoSize(frame);
+    if (xingOffset + 8 > size)
+    {
+        return false;
+    }
+
+    const unsigned char *p = data + xingOffset;
+    const bool isXing = p[0] == 'X' && p[1] == 'i' && p[2] == 'n' && p[3] == 'g';
+    const bool isInfo = p[0] == 'I' && p[1] == 'n' && p[2] == 'f' && p[3] == 'o';
+    return isXing || isInfo;
+}
+
+bool hasVbriTag(const unsigned char *data, qint64 size, qint64 frameOffset)
+{
+    const qint64 vbriOffset = frameOffset + 4 + 32;
+    if (vbriOffset + 18 > size)
+    {
+        return false;
+    }
+
+    const unsigned char *p = data + vbriOffset;
+    return p[0] == 'V' && p[1] == 'B' && p[2] == 'R' && p[3] == 'I';
+}
+
+double durationFromXing(const unsigned char *data, qint64 size, qint64 frameOffset, const Mp3Frame &frame)
+{
+    if (!hasXingTag(data, size, frameOffset, frame))
+    {
+        return -1.0;
+    }
+
+    const qint64 xingOffset = frameOffset + 4 + sideInfoSize(frame);
+    const unsigned char *p = data + xingOffset;
+
+    const quint32 flags = readBigEndian32(p + 4);
+    qint64 cursor = xingOffset + 8;
+    if ((flags & 0x1) == 0 || cursor + 4 > size)
+    {
+        return -1.0;
+    }
+
+    const quint32 frames = readBigEndian32(data + cursor);
+    cursor += 4;
+    if (flags & 0x2)
+    {
+        cursor += 4;
+    }
+    if (flags & 0x4)
+    {
+        cursor += 100;
+    }
+    if (flags & 0x8)
+    {
+        cursor += 4;
+    }
+
+    qint64 samples = static_cast<qint64>(frames) * frame.samplesPerFrame;
+
+    // LAME extension: encoder delay and padding let us report the gapless length.
+    const qint64 delayOffset = cursor + 21;
+    if (delayOffset + 3 <= size && data[cursor] == 'L' && data[cursor + 1] == 'A' && data[cursor + 2] == 'M' &&
+        data[cursor + 3] == 'E')
+    {
+        const unsigned char *d = data + delayOffset;
+        const int delay = (d[0] << 4) | (d[1] >> 4);
+        const int padding = ((d[1] & 0x0F) << 8) | d[2];
+        if (samples > delay + padding)
+        {
+            samples -= delay + padding;
+        }
+    }
+
+    return static_cast<double>(samples) / frame.sampleRate;
+}
+
+double durationFromVbri(const unsigned char *data, qint64 size, qint64 frameOffset, const Mp3Frame &frame)
+{
+    if (!hasVbriTag(data, size, frameOffset))
+    {
+        return -1.0;
+    }
+
+    const unsigned char *p = data + frameOffset + 4 + 32;
+    const quint32 frames = readBigEndian32(p + 14);
+    return static_cast<double>(frames) * frame.samplesPerFrame / frame.sampleRate;
+}
+
+double durationFromFrameScan(const unsigned char *data, qint64 size, qint64 offset, const Mp3Frame &first)
+{
+    // An ID3v1 tag occupies the last 128 bytes.
+    qint64 end = size;
+    if (end >= 128 && data[end - 128] == 'T' && data[end - 127] == 'A' && data[end - 126] == 'G')
+    {
+        end -= 128;
+    }
+
+    qint64 samples = 0;
+    const int sampleRate = first.sampleRate;
+    Mp3Frame frame;
+    while (offset + 4 <= end)
+    {
+        if (!parseMp3Header(data + offset, &frame) || frame.sampleRate != sampleRate)
+        {
+            const qint64 resync = findFirstFrame(data, end, offset + 1, &frame);
+            if (resync < 0)
+            {
+                break;
+            }
+            offset = resync;
+            continue;
+        }
+
+        if (offset + frame.length > end)
+        {
+            break;
+        }
+
+        samples += frame.samplesPerFrame;
+        offset += frame.length;
+    }
+
+    return sampleRate > 0 ? static_cast<double>(samples) / sampleRate : -1.0;
+}
+
+struct CachedDuration
+{
+    qint64 size = -1;
+    qint64 modified = 0;
+    double seconds = -1.0;
+};
+
+std::mutex &cacheMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+QHash<QString, CachedDuration> &durationCache()
+{
+    static QHash<QString, CachedDuration> cache;
+    return cache;
+}
+} // namespace
+
+bool AudioProbe::parse_mp3_header(const unsigned char *header, Mp3Frame *frame)
+{
+    return header && frame && parseMp3Header(header, frame);
+}
+
+qint64 AudioProbe::find_first_mp3_frame(const unsigned char *data, qint64 size, Mp3Frame *frame)
+{
+    if (!data || !frame)
+    {
+        return -1;
+    }
+    return findFirstFrame(data, size, skipId3v2(data, size), frame);
+}
+
+bool AudioProbe::is_mp3_info_frame(const unsigned char *data, qint64 size, qint64 frameOffset, const Mp3Frame &frame)
+{
+    return hasXingTag(data, size, frameOffset, frame) || hasVbriTag(data, size, frameOffset);
+}
+
+double AudioProbe::probe_mp3(const unsigned char *data, qint64 size)
+{
+    if (!data || size < 4)
+    {
+        return -1.0;
+    }
+
+    Mp3Frame frame;
+    const qint64 firstFrame = findFirstFrame(data, size, skipId3v2(data, size), &frame);
+    if (firstFrame < 0)
+    {
+        return -1.0;
+    }
+
+    double seconds = durationFromXing(data, size, firstFrame, frame);
+    if (seconds < 0.0)
+    {
+        seconds = durationFromVbri(data, size, firstFrame, frame);
+    }
+    if (seconds < 0.0)
+    {
+        seconds = durationFromFrameScan(data, size, firstFrame, frame);
+    }
+    return seconds;
+}
+
+double AudioProbe::probe_wav(const unsigned char *data, qint64 size)
+{
+    if (!data || size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0)
+    {
+        return -1.0;
+    }
+
+    quint32 byteRate = 0;
+    qint64 offset = 12;
+    while (offset + 8 <= size)
+    {
+        const unsigned char *chunk = data + offset;
+        const qint64 chunkSize = readLittleEndian32(chunk + 4);
+        const qint64 body = offset + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && body + 16 <= size)
+        {
+            byteRate = readLittleEndian32(data + body + 8);
+            if (byteRate == 0)
+            {
+                const quint16 channels = readLittleEndian16(data + body + 2);
+                const quint32 sampleRate = readLittleEndian32(data + body + 4);
+                const quint16 bits = readLittleEndian16(data + body + 14);
+                byteRate = sampleRate * channels * ((bits + 7) / 8);
+            }
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (byteRate == 0)
+            {
+                return -1.0;
+            }
+            // Streaming writers leave a placeholder size; trust the file length.
+            const qint64 available = size - body;
+            const qint64 dataSize = (chunkSize == 0 || chunkSize > available) ? available : chunkSize;
+            return static_cast<double>(dataSize) / byteRate;
+        }
+
+        offset = body + chunkSize + (chunkSize & 1);
+    }
+
+    return -1.0;
+}
+
+double AudioProbe::probe_duration(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists() || info.size() <= 0)
+    {
+        return -1.0;
+    }
+
+    const QString key = info.absoluteFilePath();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        const auto it = durationCache().constFind(key);
+        if (it != durationCache().constEnd() && it->size == info.size() && it->modified == modified)
+        {
+            return it->seconds;
+        }
+    }
+
+    const QString suffix = info.suffix().toLower();
+    const bool isMp3 = suffix == QStringLiteral("mp3");
+    const bool isWav = suffix == QStringLiteral("wav");
+    if (!isMp3 && !isWav)
+    {
+        return -1.0;
+    }
+
+    QFile file(key);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return -1.0;
+    }
+
+    double seconds = -1.0;
+    const qint64 size = file.size();
+    if (uchar *mapped = file.map(0, size))
+    {
+        seconds = isMp3 ? probe_mp3(mapped, size) : probe_wav(mapped, size);
+        file.unmap(mapped);
+    }
+    else
+    {
+        const QByteArray bytes = file.readAll();
+        const auto *raw = reinterpret_cast<const unsigned char *>(bytes.constData());
+        seconds = isMp3 ? probe_mp3(raw, bytes.size()) : probe_wav(raw, bytes.size());
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    durationCache().insert(key, CachedDuration{size, modified, seconds});
+    return seconds;
+}
+
+QHash<QString, double> AudioProbe::probe_durations(const QStringList &filePaths)
+{
+    std::vector<double> results(static_cast<size_t>(filePaths.size()), -1.0);
+    parallelFor(static_cast<int>(filePaths.size()), [&](int index) {
+        results[static_cast<size_t>(index)] = probe_duration(filePaths.at(index));
+    });
+
+    QHash<QString, double> durations;
+    durations.reserve(static_cast<int>(filePaths.size()));
+    for (int index = 0; index < filePaths.size(); ++index)
+    {
+        durations.insert(filePaths.at(index), results[static_cast<size_t>(index)]);
+    }
+    return durations;
+}
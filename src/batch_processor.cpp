@@ -0,0 +1,821 @@
+#include "batch_processor.h"
+
+#include "audio.h"
+#include "executor.h"
+#include "logger.h"
+#include "provider_metrics.h"
+#include "srt_document.h"
+#include "srt_timing.h"
+#include "timeline_mixer.h"
+#include "trace.h"
+#include "translator.h"
+#include "tts_cache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr int kCheckpointVersion = 1;
+// A checkpoint is rewritten after this many finished cues or this long,
+// whichever comes first, so a crash loses little without rewriting the
+// file for every cue.
+constexpr int kCheckpointFlushCues = 25;
+constexpr qint64 kCheckpointFlushMs = 2000;
+// A failed cue waits this long before its first retry, doubling up to the
+// cap, so a provider that just dropped a connection is not hit again at
+// once. 429s are backed off separately by ProviderScheduler.
+constexpr int kRetryDelayMs = 500;
+constexpr int kMaxRetryDelayMs = 8000;
+
+bool isSrtFile(const QFileInfo &info)
+{
+    return info.isFile() && info.suffix().compare(QStringLiteral("srt"), Qt::CaseInsensitive) == 0;
+}
+
+bool translates(const BatchProcessor::Options &options)
+{
+    return options.command == BatchProcessor::Command::Translate ||
+           (options.command == BatchProcessor::Command::Pipeline && options.pipelineTranslate);
+}
+
+bool speaks(const BatchProcessor::Options &options)
+{
+    return options.command == BatchProcessor::Command::Speak ||
+           (options.command == BatchProcessor::Command::Pipeline && options.pipelineSpeak);
+}
+
+bool worksPerCue(const BatchProcessor::Options &options)
+{
+    return translates(options) || speaks(options);
+}
+
+QString commandName(BatchProcessor::Command command)
+{
+    switch (command)
+    {
+    case BatchProcessor::Command::Normalize:
+        return QStringLiteral("normalize");
+    case BatchProcessor::Command::Retime:
+        return QStringLiteral("retime");
+    case BatchProcessor::Command::Translate:
+        return QStringLiteral("translate");
+    case BatchProcessor::Command::Speak:
+        return QStringLiteral("tts");
+    case BatchProcessor::Command::Pipeline:
+        return QStringLiteral("batch");
+    }
+    return {};
+}
+
+// Everything that changes what a cue turns into. A checkpoint written under
+// other settings is ignored rather than mixed into the new output.
+QString optionsFingerprint(const BatchProcessor::Options &options)
+{
+    QStringList parts{commandName(options.command)};
+    if (translates(options))
+    {
+        parts << options.translateProvider
+              << QString::fromStdString(options.sourceLanguage)
+              << QString::fromStdString(options.targetLanguage);
+    }
+    if (speaks(options))
+    {
+        parts << options.speech.provider << options.speech.voice << options.speech.model << options.clipExtension
+              << QString::number(options.speech.speed)
+              << QString::fromUtf8(QJsonDocument(options.speech.cacheKey.voiceSettings).toJson(QJsonDocument::Compact))
+              << QString::number(options.speech.trimSilence) << QString::number(options.speech.fitToSlot)
+              << QString::number(options.speech.normalizeLoudness) << QString::number(options.speech.targetLufs);
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(parts.join(QLatin1Char('\n')).toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+// Size and modification time, so an edited source starts over.
+QString sourceStamp(const QString &path)
+{
+    const QFileInfo info(path);
+    return QStringLiteral("%1@%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+// One open file. Slots in texts and clipPaths are written under
+// progressMutex, which also guards the checkpoint bookkeeping; an empty slot
+// means the stage has not succeeded for that cue yet.
+struct FileState
+{
+    int index = 0;
+    QString outputPath;
+    QString clipDirectory;
+    QString checkpointPath;
+    QString stamp;
+    QVector<SrtCue> cues;
+    QElapsedTimer timer;
+    int nextCue = 0; // guarded by BatchRun::mutex_
+    std::atomic<int> remaining{0};
+    std::atomic<int> failed{0};
+    std::atomic<int> resumed{0};
+    std::atomic<int> retries{0};
+
+    std::mutex progressMutex;
+    std::vector<QString> texts;
+    std::vector<QString> clipPaths;
+    int unsavedCues = 0;
+    QElapsedTimer sinceCheckpoint;
+};
+
+class BatchRun
+{
+public:
+    BatchRun(const QVector<BatchProcessor::Input> &inputs,
+             const BatchProcessor::Options &options,
+             const BatchProcessor::ProgressCallback &progress)
+        : inputs_(inputs),
+          options_(options),
+          progress_(progress),
+          fingerprint_(optionsFingerprint(options)),
+          results_(inputs.size())
+    {
+    }
+
+    void drain()
+    {
+        std::shared_ptr<FileState> file;
+        int cue = -1;
+        while (next_unit(&file, &cue))
+        {
+            process_cue(*file, cue);
+            if (file->remaining.fetch_sub(1) == 1)
+            {
+                finish_file(*file);
+            }
+        }
+    }
+
+    QVector<BatchProcessor::FileResult> results() const
+    {
+        return results_;
+    }
+
+private:
+    // Hands out the next cue of an open file, opening files as needed. Files
+    // are opened outside the lock, so slow disks do not stall the workers
+    // that already have requests to send.
+    bool next_unit(std::shared_ptr<FileState> *file, int *cue)
+    {
+        for (;;)
+        {
+            int index = -1;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                while (!open_.empty())
+                {
+                    const std::shared_ptr<FileState> &front = open_.front();
+                    if (front->nextCue < front->cues.size())
+                    {
+                        *file = front;
+                        *cue = front->nextCue++;
+                        return true;
+                    }
+                    open_.pop_front();
+                }
+                if (nextInput_ >= inputs_.size())
+                {
+                    return false;
+                }
+                index = nextInput_++;
+            }
+
+            std::shared_ptr<FileState> opened = open_file(index);
+            if (opened)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                open_.push_back(std::move(opened));
+            }
+        }
+    }
+
+    // Returns the file when it has cues left to hand out; files that need no
+    // per-cue work are finished right here.
+    std::shared_ptr<FileState> open_file(int index)
+    {
+        const BatchProcessor::Input &input = inputs_.at(index);
+        auto file = std::make_shared<FileState>();
+        file->timer.start();
+        file->index = index;
+        file->outputPath = options_.inPlace ? input.path : QDir(options_.outputDirectory).filePath(input.relativePath);
+        const QFileInfo outputInfo(file->outputPath);
+        file->clipDirectory = outputInfo.dir().filePath(outputInfo.completeBaseName());
+        file->checkpointPath = file->outputPath + QStringLiteral(".checkpoint.json");
+
+        QString errorMessage;
+        if (!SrtDocument::read_file(input.path, &file->cues, &errorMessage))
+        {
+            report(*file, errorMessage);
+            return {};
+        }
+
+        if (!worksPerCue(options_) || file->cues.isEmpty())
+        {
+            finish_file(*file);
+            return {};
+        }
+
+        file->texts.resize(static_cast<size_t>(file->cues.size()));
+        file->clipPaths.resize(static_cast<size_t>(file->cues.size()));
+        file->remaining.store(file->cues.size());
+        if (options_.checkpoints)
+        {
+            file->stamp = sourceStamp(input.path);
+            file->sinceCheckpoint.start();
+            if (load_checkpoint(*file))
+            {
+                report(*file, {}, true);
+                return {};
+            }
+        }
+        if (speaks(options_) && !QDir().mkpath(file->clipDirectory))
+        {
+            report(*file, QObject::tr("Cannot create %1").arg(QDir::toNativeSeparators(file->clipDirectory)));
+            return {};
+        }
+        return file;
+    }
+
+    // Restores finished cues from an earlier run. Returns true when that run
+    // completed the file and its output is still there.
+    bool load_checkpoint(FileState &file) const
+    {
+        QFile checkpointFile(file.checkpointPath);
+        if (!checkpointFile.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+        const QJsonObject checkpoint = QJsonDocument::fromJson(checkpointFile.readAll()).object();
+        if (checkpoint.value(QStringLiteral("version")).toInt() != kCheckpointVersion ||
+            checkpoint.value(QStringLiteral("fingerprint")).toString() != fingerprint_ ||
+            checkpoint.value(QStringLiteral("source")).toString() != file.stamp)
+        {
+            return false;
+        }
+
+        if (checkpoint.value(QStringLiteral("complete")).toBool())
+        {
+            const bool outputPresent = options_.command == BatchProcessor::Command::Speak
+                                           ? QFileInfo(file.clipDirectory).isDir()
+                                           : QFileInfo::exists(file.outputPath);
+            if (outputPresent)
+            {
+                return true;
+            }
+        }
+
+        const int cueCount = file.cues.size();
+        const QJsonObject translations = checkpoint.value(QStringLiteral("translations")).toObject();
+        for (auto it = translations.begin(); it != translations.end(); ++it)
+        {
+            const int cue = it.key().toInt();
+            if (cue >= 0 && cue < cueCount)
+            {
+                file.texts[static_cast<size_t>(cue)] = it.value().toString();
+            }
+        }
+        const QJsonObject clips = checkpoint.value(QStringLiteral("clips")).toObject();
+        for (auto it = clips.begin(); it != clips.end(); ++it)
+        {
+            const int cue = it.key().toInt();
+            const QString clipPath = QDir(file.clipDirectory).filePath(it.value().toString());
+            if (cue >= 0 && cue < cueCount && QFileInfo::exists(clipPath))
+            {
+                file.clipPaths[static_cast<size_t>(cue)] = clipPath;
+            }
+        }
+        return false;
+    }
+
+    // Call with file.progressMutex held.
+    void save_checkpoint_locked(FileState &file, bool complete) const
+    {
+        QJsonObject translations;
+        QJsonObject clips;
+        for (size_t i = 0; i < file.texts.size(); ++i)
+        {
+            if (!file.texts[i].isEmpty())
+            {
+                translations.insert(QString::number(i), file.texts[i]);
+            }
+            if (!file.clipPaths[i].isEmpty())
+            {
+                clips.insert(QString::number(i), QFileInfo(file.clipPaths[i]).fileName());
+            }
+        }
+        const QJsonObject checkpoint{{QStringLiteral("version"), kCheckpointVersion},
+                                     {QStringLiteral("fingerprint"), fingerprint_},
+                                     {QStringLiteral("source"), file.stamp},
+                                     {QStringLiteral("complete"), complete},
+                                     {QStringLiteral("translations"), translations},
+                                     {QStringLiteral("clips"), clips}};
+
+        QDir().mkpath(QFileInfo(file.checkpointPath).absolutePath());
+        QSaveFile out(file.checkpointPath);
+        if (!out.open(QIODevice::WriteOnly) || out.write(QJsonDocument(checkpoint).toJson(QJsonDocument::Compact)) < 0 || !out.commit())
+        {
+            SRT_LOG_WARN("batch", "cannot write checkpoint {}: {}", file.checkpointPath, out.errorString());
+        }
+        file.unsavedCues = 0;
+        file.sinceCheckpoint.restart();
+    }
+
+    void store_translation(FileState &file, size_t slot, const QString &text) const
+    {
+        std::lock_guard<std::mutex> lock(file.progressMutex);
+        file.texts[slot] = text;
+        note_progress_locked(file);
+    }
+
+    void store_clip(FileState &file, size_t slot, const QString &clipPath) const
+    {
+        std::lock_guard<std::mutex> lock(file.progressMutex);
+        file.clipPaths[slot] = clipPath;
+        note_progress_locked(file);
+    }
+
+    void note_progress_locked(FileState &file) const
+    {
+        if (!options_.checkpoints)
+        {
+            return;
+        }
+        ++file.unsavedCues;
+        if (file.unsavedCues >= kCheckpointFlushCues || file.sinceCheckpoint.elapsed() >= kCheckpointFlushMs)
+        {
+            save_checkpoint_locked(file, false);
+        }
+    }
+
+    // Runs attempt() until it succeeds or the retries are used up, with an
+    // exponential delay between attempts. Each retry is also counted in the
+    // provider metrics under labels, unless they are empty.
+    template <typename Fn>
+    bool with_retries(FileState &file, const MetricLabels &labels, Fn attempt) const
+    {
+        int delayMs = kRetryDelayMs;
+        for (int tries = 0;; ++tries)
+        {
+            if (attempt())
+            {
+                return true;
+            }
+            if (tries >= options_.retries)
+            {
+                return false;
+            }
+            file.retries.fetch_add(1);
+            if (!labels.provider.isEmpty())
+            {
+                ProviderMetrics::instance().add_retry(labels);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            delayMs = std::min(delayMs * 2, kMaxRetryDelayMs);
+        }
+    }
+
+    void process_cue(FileState &file, int cue)
+    {
+        const QString text = file.cues.at(cue).text.trimmed();
+        const size_t slot = static_cast<size_t>(cue);
+        if (text.isEmpty())
+        {
+            return;
+        }
+
+        QString translated;
+        QString clipPath;
+        {
+            std::lock_guard<std::mutex> lock(file.progressMutex);
+            translated = file.texts[slot];
+            clipPath = file.clipPaths[slot];
+        }
+        bool didWork = false;
+
+        QString spoken = text;
+        if (translates(options_))
+        {
+            if (translated.isEmpty())
+            {
+                SRT_TRACE_SCOPE("BatchProcessor::translate_cue");
+                didWork = true;
+                QString error;
+                const MetricLabels labels = Translator::metric_labels(options_.translateProvider, options_.translateToken);
+                const bool ok = with_retries(file, labels, [this, &text, &translated, &error]() {
+                    Translator translator;
+                    error.clear();
+                    translated = translator.translate(options_.translateProvider,
+                                                      text,
+                                                      options_.sourceLanguage,
+                                                      options_.targetLanguage,
+                                                      options_.translateToken,
+                                                      &error);
+                    // A cue may translate to itself (names, numbers), so
+                    // only the translator's error counts as a failure.
+                    return error.isEmpty() && !translated.isEmpty();
+                });
+                if (!ok)
+                {
+                    file.failed.fetch_add(1);
+                    SRT_LOG_WARN("batch", "{}: cue {} not translated: {}", inputs_.at(file.index).path, cue + 1, error);
+                    return;
+                }
+                store_translation(file, slot, translated);
+            }
+            spoken = translated.trimmed();
+        }
+
+        if (speaks(options_) && clipPath.isEmpty())
+        {
+            SRT_TRACE_SCOPE("BatchProcessor::speak_cue");
+            didWork = true;
+            SpeechJob job = options_.speech;
+            job.text = spoken;
+            job.cacheKey.text = spoken;
+            job.filePath = QDir(file.clipDirectory).filePath(QStringLiteral("%1.%2")
+                                                                 .arg(cue + 1, 4, 10, QLatin1Char('0'))
+                                                                 .arg(options_.clipExtension));
+            const qint64 startMs = SrtTiming::parse_srt_timestamp(file.cues.at(cue).start);
+            const qint64 endMs = SrtTiming::parse_srt_timestamp(file.cues.at(cue).end);
+            job.slotMs = endMs > startMs ? endMs - startMs : -1;
+
+            const MetricLabels labels = Audio::metric_labels(job.provider, job.token);
+            if (!with_retries(file, labels, [&job]() { return SpeechRenderer::render(job) >= 0.0; }))
+            {
+                file.failed.fetch_add(1);
+                SRT_LOG_WARN("batch", "{}: cue {} produced no audio", inputs_.at(file.index).path, cue + 1);
+                return;
+            }
+            store_clip(file, slot, job.filePath);
+        }
+
+        if (!didWork)
+        {
+            file.resumed.fetch_add(1);
+        }
+    }
+
+    void finish_file(FileState &file)
+    {
+        QString errorMessage;
+        switch (options_.command)
+        {
+        case BatchProcessor::Command::Normalize:
+        case BatchProcessor::Command::Speak:
+            break;
+        case BatchProcessor::Command::Retime:
+            for (SrtCue &cue : file.cues)
+            {
+                cue.start = SrtTiming::retime_timestamp(cue.start, options_.offsetMs, options_.scale);
+                cue.end = SrtTiming::retime_timestamp(cue.end, options_.offsetMs, options_.scale);
+            }
+            break;
+        case BatchProcessor::Command::Translate:
+        case BatchProcessor::Command::Pipeline:
+            // Cues that failed keep their original text.
+            for (int i = 0; i < static_cast<int>(file.texts.size()); ++i)
+            {
+                const QString &translated = file.texts[static_cast<size_t>(i)];
+                if (!translated.isEmpty())
+                {
+                    file.cues[i].text = translated;
+                }
+            }
+            break;
+        }
+
+        if (options_.command != BatchProcessor::Command::Speak)
+        {
+            // Parsing and serializing is itself the normalization: numbering
+            // from 1, CRLF line endings, no byte order mark, malformed blocks
+            // dropped.
+            if (!QDir().mkpath(QFileInfo(file.outputPath).absolutePath()))
+            {
+                errorMessage = QObject::tr("Cannot create the directory for %1").arg(QDir::toNativeSeparators(file.outputPath));
+            }
+            else
+            {
+                SrtDocument::write_file(file.outputPath, file.cues, &errorMessage);
+            }
+        }
+
+        if (errorMessage.isEmpty() && speaks(options_) && options_.mixTrack)
+        {
+            mix_track(file, &errorMessage);
+        }
+
+        if (options_.checkpoints && worksPerCue(options_) && !file.cues.isEmpty())
+        {
+            std::lock_guard<std::mutex> lock(file.progressMutex);
+            if (options_.inPlace && options_.command != BatchProcessor::Command::Speak)
+            {
+                // The output replaced the source; a rerun reads it back.
+                file.stamp = sourceStamp(file.outputPath);
+            }
+            save_checkpoint_locked(file, errorMessage.isEmpty() && file.failed.load() == 0);
+        }
+        report(file, errorMessage);
+    }
+
+    void mix_track(const FileState &file, QString *errorMessage) const
+    {
+        QVector<TimelineMixer::Cue> cues;
+        for (int i = 0; i < file.cues.size(); ++i)
+        {
+            const QString &clipPath = file.clipPaths[static_cast<size_t>(i)];
+            const qint64 startMs = SrtTiming::parse_srt_timestamp(file.cues.at(i).start);
+            if (!clipPath.isEmpty() && startMs >= 0)
+            {
+                cues.append({startMs, clipPath});
+            }
+        }
+        if (cues.isEmpty())
+        {
+            return;
+        }
+
+        const bool mp3 = options_.clipExtension == QStringLiteral("mp3");
+        const QString trackPath = file.clipDirectory + (mp3 ? QStringLiteral(".mp3") : QStringLiteral(".wav"));
+        TimelineMixer::Report mixReport;
+        const bool mixed = mp3 ? TimelineMixer::concat_mp3(cues, trackPath, &mixReport)
+                               : TimelineMixer::mix_to_wav(cues, trackPath, &mixReport);
+        if (!mixed)
+        {
+            *errorMessage = mixReport.error;
+        }
+    }
+
+    void report(const FileState &file, const QString &errorMessage, bool skipped = false)
+    {
+        BatchProcessor::FileResult result;
+        result.inputPath = inputs_.at(file.index).path;
+        result.outputPath = options_.command == BatchProcessor::Command::Speak ? file.clipDirectory : file.outputPath;
+        result.cues = file.cues.size();
+        result.failedCues = file.failed.load();
+        result.resumedCues = skipped ? file.cues.size() : file.resumed.load();
+        result.retries = file.retries.load();
+        result.skipped = skipped;
+        result.elapsedMs = file.timer.elapsed();
+        result.error = errorMessage;
+        if (!errorMessage.isEmpty())
+        {
+            SRT_LOG_WARN("batch", "{}: {}", result.inputPath, errorMessage);
+        }
+
+        std::lock_guard<std::mutex> lock(resultMutex_);
+        results_[file.index] = result;
+        ++filesDone_;
+        if (progress_)
+        {
+            progress_(result, filesDone_, inputs_.size());
+        }
+    }
+
+    const QVector<BatchProcessor::Input> &inputs_;
+    const BatchProcessor::Options &options_;
+    const BatchProcessor::ProgressCallback &progress_;
+    const QString fingerprint_;
+
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<FileState>> open_;
+    int nextInput_ = 0;
+
+    std::mutex resultMutex_;
+    QVector<BatchProcessor::FileResult> results_;
+    int filesDone_ = 0;
+};
+} // namespace
+
+QVector<BatchProcessor::Input> BatchProcessor::collect_inputs(const QStringList &paths, bool recursive, QStringList *missing)
+{
+    QVector<Input> inputs;
+    for (const QString &path : paths)
+    {
+        const QFileInfo info(path);
+        if (info.isFile())
+        {
+            inputs.append({info.filePath(), info.fileName()});
+            continue;
+        }
+        if (!info.isDir())
+        {
+            if (missing)
+            {
+                missing->append(path);
+            }
+            continue;
+        }
+
+        const QDir root(info.filePath());
+        QVector<Input> found;
+        QDirIterator it(root.path(),
+                        QStringList{QStringLiteral("*.srt"), QStringLiteral("*.SRT")},
+                        QDir::Files,
+                        recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+        while (it.hasNext())
+        {
+            const QString filePath = it.next();
+            if (isSrtFile(it.fileInfo()))
+            {
+                found.append({filePath, root.relativeFilePath(filePath)});
+            }
+        }
+        std::sort(found.begin(), found.end(), [](const Input &a, const Input &b) { return a.path < b.path; });
+        inputs += found;
+    }
+    return inputs;
+}
+
+bool BatchProcessor::read_manifest(const QString &manifestPath,
+                                   bool recursive,
+                                   QVector<Input> *inputs,
+                                   QStringList *missing,
+                                   QString *errorMessage)
+{
+    QFile manifest(manifestPath);
+    if (!manifest.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = manifest.errorString();
+        }
+        return false;
+    }
+
+    const QDir base = QFileInfo(manifestPath).absoluteDir();
+    QTextStream stream(&manifest);
+    while (!stream.atEnd())
+    {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+        {
+            continue;
+        }
+
+        const QString path = QDir::cleanPath(base.absoluteFilePath(line));
+        const bool isDirectory = QFileInfo(path).isDir();
+        // Entries outside the manifest's directory keep only their own name.
+        QString prefix = base.relativeFilePath(path);
+        if (prefix.startsWith(QStringLiteral("..")) || prefix == QStringLiteral("."))
+        {
+            prefix.clear();
+        }
+
+        for (Input input : collect_inputs({path}, recursive, missing))
+        {
+            if (!prefix.isEmpty())
+            {
+                input.relativePath = isDirectory ? prefix + QLatin1Char('/') + input.relativePath : prefix;
+            }
+            inputs->append(input);
+        }
+    }
+    return true;
+}
+
+QVector<BatchProcessor::FileResult> BatchProcessor::run(const QVector<Input> &inputs,
+                                                        const Options &options,
+                                                        const ProgressCallback &progress)
+{
+    if (inputs.isEmpty())
+    {
+        return {};
+    }
+
+    BatchRun batch(inputs, options, progress);
+
+    // A pool of its own rather than the shared executor: its size is the
+    // global cap, and provider calls that fan out internally (chunked speech,
+    // local engines) still get the shared executor to themselves.
+    // The latch outlives the pool, whose destructor joins the workers.
+    const int workers = std::max(1, options.jobs);
+    std::mutex mutex;
+    std::condition_variable finished;
+    int running = workers;
+    Executor pool(workers);
+    for (int i = 0; i < workers; ++i)
+    {
+        pool.submit([&]() {
+            batch.drain();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0)
+            {
+                finished.notify_one();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&running]() { return running == 0; });
+    if (speaks(options))
+    {
+        TtsCache::instance().save();
+    }
+    return batch.results();
+}
+
+bool BatchProcessor::write_report(const QString &path,
+                                  const QVector<FileResult> &results,
+                                  const Options &options,
+                                  qint64 elapsedMs,
+                                  QString *errorMessage)
+{
+    int succeeded = 0;
+    int skipped = 0;
+    int cues = 0;
+    int failedCues = 0;
+    int resumedCues = 0;
+    int retries = 0;
+    QJsonArray files;
+    for (const FileResult &result : results)
+    {
+        succeeded += result.ok() ? 1 : 0;
+        skipped += result.skipped ? 1 : 0;
+        cues += result.cues;
+        failedCues += result.failedCues;
+        resumedCues += result.resumedCues;
+        retries += result.retries;
+        QJsonObject file{{QStringLiteral("input"), result.inputPath},
+                         {QStringLiteral("output"), result.outputPath},
+                         {QStringLiteral("cues"), result.cues},
+                         {QStringLiteral("failedCues"), result.failedCues},
+                         {QStringLiteral("resumedCues"), result.resumedCues},
+                         {QStringLiteral("retries"), result.retries},
+                         {QStringLiteral("skipped"), result.skipped},
+                         {QStringLiteral("seconds"), result.elapsedMs / 1000.0}};
+        if (!result.error.isEmpty())
+        {
+            file.insert(QStringLiteral("error"), result.error);
+        }
+        files.append(file);
+    }
+
+    QJsonArray providers;
+    for (const ProviderMetrics::SeriesSnapshot &series : ProviderMetrics::instance().snapshot())
+    {
+        providers.append(QJsonObject{{QStringLiteral("provider"), series.labels.provider},
+                                     {QStringLiteral("endpoint"), series.labels.endpoint},
+                                     {QStringLiteral("requests"), static_cast<double>(series.requests)},
+                                     {QStringLiteral("failures"), static_cast<double>(series.failures)},
+                                     {QStringLiteral("throttled"), static_cast<double>(series.throttled)},
+                                     {QStringLiteral("p50Ms"), series.p50Us / 1000.0},
+                                     {QStringLiteral("p99Ms"), series.p99Us / 1000.0},
+                                     {QStringLiteral("promptTokens"), static_cast<double>(series.promptTokens)},
+                                     {QStringLiteral("completionTokens"), static_cast<double>(series.completionTokens)}});
+    }
+
+    const double seconds = elapsedMs / 1000.0;
+    const QJsonObject totals{{QStringLiteral("files"), results.size()},
+                             {QStringLiteral("succeeded"), succeeded},
+                             {QStringLiteral("failed"), results.size() - succeeded},
+                             {QStringLiteral("skipped"), skipped},
+                             {QStringLiteral("cues"), cues},
+                             {QStringLiteral("failedCues"), failedCues},
+                             {QStringLiteral("resumedCues"), resumedCues},
+                             {QStringLiteral("retries"), retries},
+                             {QStringLiteral("cuesPerSecond"), seconds > 0.0 ? (cues - resumedCues) / seconds : 0.0}};
+    const QJsonObject root{{QStringLiteral("schema"), 1},
+                           {QStringLiteral("command"), commandName(options.command)},
+                           {QStringLiteral("finished"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+                           {QStringLiteral("seconds"), seconds},
+                           {QStringLiteral("jobs"), options.jobs},
+                           {QStringLiteral("totals"), totals},
+                           {QStringLiteral("providers"), providers},
+                           {QStringLiteral("files"), files}};
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly) || out.write(QJsonDocument(root).toJson()) < 0 || !out.commit())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = out.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,456 @@
+#include "audio.h"
+#include "batch_processor.h"
+#include "logger.h"
+#include "provider_metrics.h"
+#include "provider_scheduler.h"
+#include "settings.h"
+#include "speech_renderer.h"
+#include "tts_cache.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+constexpr qint64 kLogFileMaxBytes = 5 * 1024 * 1024;
+constexpr int kLogFilesKept = 5;
+
+enum ExitCode
+{
+    kExitOk = 0,
+    kExitUsage = 1,
+    kExitFilesFailed = 2
+};
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+int usageError(const QString &message)
+{
+    err() << "srt-editor-cli: " << message << Qt::endl
+          << "Run with --help for usage." << Qt::endl;
+    return kExitUsage;
+}
+
+// The environment wins over the key saved in Settings, so scripts can pass a
+// key without touching the editor's configuration.
+QString apiKey(const char *environmentVariable, const QString &settingsKey)
+{
+    const QString fromEnvironment = qEnvironmentVariable(environmentVariable).trimmed();
+    if (!fromEnvironment.isEmpty())
+    {
+        return fromEnvironment;
+    }
+    return Settings().value(settingsKey).toString().trimmed();
+}
+
+// The same key the TTS window builds from its controls, so clips rendered by
+// either tool are served from the cache to the other.
+TtsCache::Key speechCacheKey(const SpeechJob &job, const QString &extension, int speedPercent)
+{
+    Settings settings;
+    TtsCache::Key key;
+    key.provider = job.provider;
+    key.voice = job.voice;
+    key.model = job.model;
+    key.outputFormat = extension;
+    key.speed = speedPercent;
+
+    if (SpeechRenderer::is_local_provider(job.provider))
+    {
+        key.voice = settings.value(QStringLiteral("tts/local/model")).toString();
+    }
+    else if (job.provider.compare(QStringLiteral("ElevenLabs"), Qt::CaseInsensitive) == 0)
+    {
+        key.voiceSettings = QJsonObject{
+            {QStringLiteral("language_code"), settings.value(QStringLiteral("tts/elevenlabs/language_code")).toString().trimmed()},
+            {QStringLiteral("stability"), settings.value(QStringLiteral("tts/elevenlabs/stability"), 50).toInt()},
+            {QStringLiteral("similarity_boost"), settings.value(QStringLiteral("tts/elevenlabs/similarity_boost"), 50).toInt()},
+            {QStringLiteral("style"), settings.value(QStringLiteral("tts/elevenlabs/style"), 50).toInt()},
+            {QStringLiteral("use_speaker_boost"), settings.value(QStringLiteral("tts/elevenlabs/use_speaker_boost"), false).toBool()},
+            {QStringLiteral("improve_previous"), settings.value(QStringLiteral("tts/elevenlabs/improve_previous"), false).toBool()},
+            {QStringLiteral("improve_next"), settings.value(QStringLiteral("tts/elevenlabs/improve_next"), false).toBool()},
+            {QStringLiteral("text_normalization"), settings.value(QStringLiteral("tts/elevenlabs/text_normalization"), false).toBool()},
+            {QStringLiteral("language_text_normalization"), settings.value(QStringLiteral("tts/elevenlabs/language_text_normalization"), false).toBool()}};
+    }
+    return key;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    // The editor's identity, so keys, endpoints and the clip cache configured
+    // in the GUI apply here too.
+    QCoreApplication::setOrganizationName(QStringLiteral("haidanghth910"));
+    QCoreApplication::setApplicationName(QStringLiteral("srteditor"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Processes SRT files without the editor window.\n\n"
+        "Commands:\n"
+        "  normalize  Renumber cues and rewrite with CRLF line endings.\n"
+        "  retime     Shift and scale every timestamp (--offset, --scale).\n"
+        "  translate  Translate cue text (--provider, --from, --to).\n"
+        "  tts        Synthesize one clip per cue (--provider, --voice, --model, --format, --speed, --track).\n"
+        "  batch      Translate (--to), speak the result (--speak) and save, resuming from checkpoints.\n"
+        "             --translator and --speech pick the providers.\n\n"
+        "Exit status: 0 on success, 1 for usage errors, 2 if any file failed."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("command"), QStringLiteral("normalize, retime, translate, tts or batch."));
+    parser.addPositionalArgument(QStringLiteral("paths"), QStringLiteral("SRT files or directories of them."), QStringLiteral("<path>..."));
+
+    const QCommandLineOption jobsOption({QStringLiteral("j"), QStringLiteral("jobs")},
+                                        QStringLiteral("Cues or files processed at once, across all files (default: CPU count)."),
+                                        QStringLiteral("count"));
+    const QCommandLineOption outputDirOption({QStringLiteral("o"), QStringLiteral("output-dir")},
+                                             QStringLiteral("Write results below <dir>, mirroring the input layout."),
+                                             QStringLiteral("dir"));
+    const QCommandLineOption inPlaceOption(QStringLiteral("in-place"), QStringLiteral("Overwrite the input files; tts writes clips next to them."));
+    const QCommandLineOption recursiveOption({QStringLiteral("r"), QStringLiteral("recursive")}, QStringLiteral("Descend into subdirectories."));
+    const QCommandLineOption quietOption({QStringLiteral("q"), QStringLiteral("quiet")}, QStringLiteral("Only report failures."));
+    const QCommandLineOption logFileOption(QStringLiteral("log-file"), QStringLiteral("Write the structured log to <file>."), QStringLiteral("file"));
+    const QCommandLineOption logLevelOption(QStringLiteral("log-level"), QStringLiteral("trace, debug, info, warn or error (default info)."), QStringLiteral("level"), QStringLiteral("info"));
+    const QCommandLineOption metricsFileOption(QStringLiteral("metrics-file"), QStringLiteral("Write provider metrics in Prometheus text format to <file> at exit."), QStringLiteral("file"));
+    const QCommandLineOption offsetOption(QStringLiteral("offset"), QStringLiteral("retime: milliseconds to add, e.g. --offset=-1500 (default 0)."), QStringLiteral("ms"), QStringLiteral("0"));
+    const QCommandLineOption scaleOption(QStringLiteral("scale"), QStringLiteral("retime: factor applied before the offset, e.g. 25/23.976 (default 1)."), QStringLiteral("factor"), QStringLiteral("1"));
+    const QCommandLineOption providerOption(QStringLiteral("provider"), QStringLiteral("translate/tts: provider name as shown in Settings (default: the one configured there)."), QStringLiteral("name"));
+    const QCommandLineOption fromOption(QStringLiteral("from"), QStringLiteral("translate/batch: source language (default auto)."), QStringLiteral("language"), QStringLiteral("auto"));
+    const QCommandLineOption toOption(QStringLiteral("to"), QStringLiteral("translate/batch: target language."), QStringLiteral("language"));
+    const QCommandLineOption voiceOption(QStringLiteral("voice"), QStringLiteral("tts/batch: voice name or id."), QStringLiteral("voice"));
+    const QCommandLineOption modelOption(QStringLiteral("model"), QStringLiteral("tts/batch: model name."), QStringLiteral("model"));
+    const QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("tts/batch: mp3, wav, opus or aac (default: the one configured in the editor)."), QStringLiteral("type"));
+    const QCommandLineOption speedOption(QStringLiteral("speed"), QStringLiteral("tts/batch: speaking rate in percent (default: the one configured in the editor)."), QStringLiteral("percent"));
+    const QCommandLineOption trackOption(QStringLiteral("track"), QStringLiteral("tts/batch: also place the clips on one track per file (wav or mp3 clips)."));
+    const QCommandLineOption translatorOption(QStringLiteral("translator"), QStringLiteral("batch: translation provider (default: the one configured in the editor)."), QStringLiteral("name"));
+    const QCommandLineOption speechOption(QStringLiteral("speech"), QStringLiteral("batch: speech provider (default: the one configured in the editor)."), QStringLiteral("name"));
+    const QCommandLineOption speakOption(QStringLiteral("speak"), QStringLiteral("batch: synthesize a clip per cue, from the translation when --to is given."));
+    const QCommandLineOption manifestOption(QStringLiteral("manifest"), QStringLiteral("Also process the paths listed in <file>, one per line."), QStringLiteral("file"));
+    const QCommandLineOption retriesOption(QStringLiteral("retries"), QStringLiteral("Extra attempts for a failed cue (default 2 for batch, 0 otherwise)."), QStringLiteral("count"));
+    const QCommandLineOption noResumeOption(QStringLiteral("no-resume"), QStringLiteral("batch: ignore and overwrite checkpoints from earlier runs."));
+    const QCommandLineOption reportOption(QStringLiteral("report"), QStringLiteral("Write a JSON summary to <file> (batch default: <output-dir>/batch-report.json)."), QStringLiteral("file"));
+    const QCommandLineOption limitOption(QStringLiteral("limit"),
+                                         QStringLiteral("Cap a provider (openai, github, elevenlabs) at <rpm> requests a minute and <n> at once; repeatable."),
+                                         QStringLiteral("provider=rpm[:n]"));
+    parser.addOptions({jobsOption, outputDirOption, inPlaceOption, recursiveOption, quietOption, logFileOption, logLevelOption,
+                       metricsFileOption, offsetOption, scaleOption, providerOption, fromOption, toOption, voiceOption,
+                       modelOption, formatOption, speedOption, trackOption, translatorOption, speechOption, speakOption,
+                       manifestOption, retriesOption, noResumeOption, reportOption, limitOption});
+    parser.process(application);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.isEmpty() || (positional.size() < 2 && !parser.isSet(manifestOption)))
+    {
+        return usageError(QStringLiteral("expected a command and at least one path"));
+    }
+
+    Logger::set_level(Logger::level_from_string(parser.value(logLevelOption), LogLevel::Info));
+    if (parser.isSet(logFileOption))
+    {
+        QString logError;
+        if (!Logger::start(parser.value(logFileOption), kLogFileMaxBytes, kLogFilesKept, &logError))
+        {
+            return usageError(QStringLiteral("cannot open log file %1: %2").arg(parser.value(logFileOption), logError));
+        }
+    }
+    else
+    {
+        // Per-cue failure reasons and provider errors are only logged; without
+        // a file they would be dropped once the rings fill.
+        Logger::start_console(LogLevel::Warn);
+    }
+
+    const QString command = positional.first().toLower();
+    Settings settings;
+    BatchProcessor::Options options;
+    options.jobs = QThread::idealThreadCount();
+    if (parser.isSet(jobsOption))
+    {
+        bool ok = false;
+        options.jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || options.jobs < 1)
+        {
+            return usageError(QStringLiteral("--jobs must be a positive number"));
+        }
+    }
+
+    options.inPlace = parser.isSet(inPlaceOption);
+    options.outputDirectory = parser.value(outputDirOption);
+    if (options.inPlace == !options.outputDirectory.isEmpty())
+    {
+        return usageError(QStringLiteral("pass exactly one of --output-dir and --in-place"));
+    }
+
+    // Shared by translate and batch; returns a usage error or nothing.
+    const auto setUpTranslation = [&](const QString &provider) -> QString {
+        options.translateProvider = !provider.isEmpty() ? provider
+                                                        : settings.value(QStringLiteral("ai/lang/provider")).toString().trimmed();
+        if (!parser.isSet(toOption))
+        {
+            return QStringLiteral("translation needs --to");
+        }
+        options.sourceLanguage = parser.value(fromOption).toStdString();
+        options.targetLanguage = parser.value(toOption).toStdString();
+        options.translateToken = apiKey("SRT_EDITOR_TRANSLATE_KEY", QStringLiteral("ai/lang/apiKey"));
+        if (options.translateToken.isEmpty())
+        {
+            return QStringLiteral("no translation API key; set SRT_EDITOR_TRANSLATE_KEY or configure one in the editor");
+        }
+        return {};
+    };
+
+    const auto setUpSpeech = [&](const QString &provider) -> QString {
+        SpeechJob &speech = options.speech;
+        speech.provider = !provider.isEmpty() ? provider
+                                              : settings.value(QStringLiteral("ai/audio/provider"), QStringLiteral("ElevenLabs")).toString();
+        if (!SpeechRenderer::is_supported_provider(speech.provider))
+        {
+            return QStringLiteral("speech provider \"%1\" is not supported").arg(speech.provider);
+        }
+        speech.token = apiKey("SRT_EDITOR_SPEECH_KEY", QStringLiteral("ai/audio/apiKey"));
+        if (speech.token.isEmpty() && !SpeechRenderer::is_local_provider(speech.provider))
+        {
+            return QStringLiteral("no speech API key; set SRT_EDITOR_SPEECH_KEY or configure one in the editor");
+        }
+        speech.voice = parser.value(voiceOption);
+        speech.model = parser.value(modelOption);
+        if (!SpeechRenderer::is_local_provider(speech.provider) && (speech.voice.isEmpty() || speech.model.isEmpty()))
+        {
+            return QStringLiteral("speech needs --voice and --model for %1").arg(speech.provider);
+        }
+
+        const QString format = parser.isSet(formatOption) ? parser.value(formatOption)
+                                                          : settings.value(QStringLiteral("tts/general/output_format"), QStringLiteral("mp3")).toString();
+        options.clipExtension = Audio::output_extension(speech.provider, format);
+        const int speedPercent = parser.isSet(speedOption) ? parser.value(speedOption).toInt()
+                                                           : settings.value(QStringLiteral("tts/general/speed"), 100).toInt();
+        if (speedPercent <= 0)
+        {
+            return QStringLiteral("--speed must be a positive percentage");
+        }
+        speech.speed = speedPercent / 100.0;
+        speech.cacheKey = speechCacheKey(speech, options.clipExtension, speedPercent);
+
+        // Post-processing follows the editor's settings.
+        speech.trimSilence = settings.value(QStringLiteral("tts/trim/enabled"), false).toBool();
+        speech.trimThresholdDb = settings.value(QStringLiteral("tts/trim/threshold_db"), -45.0).toDouble();
+        speech.fitToSlot = settings.value(QStringLiteral("tts/general/fit_to_slot"), false).toBool();
+        speech.maxStretchRatio = settings.value(QStringLiteral("tts/general/max_stretch_ratio"), 1.3).toDouble();
+        speech.normalizeLoudness = settings.value(QStringLiteral("tts/loudness/enabled"), false).toBool();
+        speech.targetLufs = settings.value(QStringLiteral("tts/loudness/target_lufs"), -16.0).toDouble();
+
+        options.mixTrack = parser.isSet(trackOption);
+        if (options.mixTrack && options.clipExtension != QStringLiteral("wav") && options.clipExtension != QStringLiteral("mp3"))
+        {
+            return QStringLiteral("--track needs wav or mp3 clips");
+        }
+        return {};
+    };
+
+    if (command == QStringLiteral("normalize"))
+    {
+        options.command = BatchProcessor::Command::Normalize;
+    }
+    else if (command == QStringLiteral("retime"))
+    {
+        options.command = BatchProcessor::Command::Retime;
+        bool offsetOk = false;
+        bool scaleOk = false;
+        options.offsetMs = parser.value(offsetOption).toLongLong(&offsetOk);
+        const QString scaleText = parser.value(scaleOption);
+        if (scaleText.contains(QLatin1Char('/')))
+        {
+            bool numeratorOk = false;
+            bool denominatorOk = false;
+            const double numerator = scaleText.section(QLatin1Char('/'), 0, 0).toDouble(&numeratorOk);
+            const double denominator = scaleText.section(QLatin1Char('/'), 1).toDouble(&denominatorOk);
+            scaleOk = numeratorOk && denominatorOk && denominator > 0.0;
+            options.scale = scaleOk ? numerator / denominator : 0.0;
+        }
+        else
+        {
+            options.scale = scaleText.toDouble(&scaleOk);
+        }
+        if (!offsetOk)
+        {
+            return usageError(QStringLiteral("--offset must be a number of milliseconds"));
+        }
+        if (!scaleOk || options.scale <= 0.0)
+        {
+            return usageError(QStringLiteral("--scale must be a positive number or ratio"));
+        }
+    }
+    else if (command == QStringLiteral("translate"))
+    {
+        options.command = BatchProcessor::Command::Translate;
+        const QString error = setUpTranslation(parser.value(providerOption));
+        if (!error.isEmpty())
+        {
+            return usageError(error);
+        }
+    }
+    else if (command == QStringLiteral("tts"))
+    {
+        options.command = BatchProcessor::Command::Speak;
+        const QString error = setUpSpeech(parser.value(providerOption));
+        if (!error.isEmpty())
+        {
+            return usageError(error);
+        }
+    }
+    else if (command == QStringLiteral("batch"))
+    {
+        options.command = BatchProcessor::Command::Pipeline;
+        options.pipelineTranslate = parser.isSet(toOption);
+        options.pipelineSpeak = parser.isSet(speakOption);
+        if (!options.pipelineTranslate && !options.pipelineSpeak)
+        {
+            return usageError(QStringLiteral("batch needs --to, --speak or both"));
+        }
+        QString error;
+        if (options.pipelineTranslate)
+        {
+            error = setUpTranslation(parser.value(translatorOption));
+        }
+        if (error.isEmpty() && options.pipelineSpeak)
+        {
+            error = setUpSpeech(parser.value(speechOption));
+        }
+        if (!error.isEmpty())
+        {
+            return usageError(error);
+        }
+        options.retries = 2;
+        options.checkpoints = !parser.isSet(noResumeOption);
+    }
+    else
+    {
+        return usageError(QStringLiteral("unknown command \"%1\"").arg(command));
+    }
+
+    if (parser.isSet(retriesOption))
+    {
+        bool ok = false;
+        options.retries = parser.value(retriesOption).toInt(&ok);
+        if (!ok || options.retries < 0)
+        {
+            return usageError(QStringLiteral("--retries must be zero or more"));
+        }
+    }
+
+    // --limit openai=500:8 caps OpenAI at 500 requests a minute, 8 at once.
+    for (const QString &limit : parser.values(limitOption))
+    {
+        const QString provider = limit.section(QLatin1Char('='), 0, 0).trimmed().toLower();
+        const QString value = limit.section(QLatin1Char('='), 1);
+        bool rateOk = false;
+        bool concurrencyOk = true;
+        ProviderScheduler::Limits limits;
+        limits.requestsPerMinute = value.section(QLatin1Char(':'), 0, 0).toDouble(&rateOk);
+        if (value.contains(QLatin1Char(':')))
+        {
+            limits.maxConcurrent = value.section(QLatin1Char(':'), 1).toInt(&concurrencyOk);
+        }
+        if (provider.isEmpty() || !rateOk || !concurrencyOk || limits.requestsPerMinute < 0.0 || limits.maxConcurrent < 0)
+        {
+            return usageError(QStringLiteral("cannot parse --limit %1").arg(limit));
+        }
+        ProviderScheduler::instance().set_limits(provider, limits);
+    }
+
+    QStringList missing;
+    QVector<BatchProcessor::Input> inputs = BatchProcessor::collect_inputs(positional.mid(1), parser.isSet(recursiveOption), &missing);
+    if (parser.isSet(manifestOption))
+    {
+        QString manifestError;
+        if (!BatchProcessor::read_manifest(parser.value(manifestOption), parser.isSet(recursiveOption), &inputs, &missing, &manifestError))
+        {
+            return usageError(QStringLiteral("cannot read manifest %1: %2").arg(parser.value(manifestOption), manifestError));
+        }
+    }
+    for (const QString &path : missing)
+    {
+        err() << "srt-editor-cli: no such file or directory: " << path << Qt::endl;
+    }
+    if (inputs.isEmpty())
+    {
+        return usageError(QStringLiteral("no .srt files found"));
+    }
+
+    SRT_LOG_INFO("cli", "{} over {} files with {} jobs", command, inputs.size(), options.jobs);
+    const bool quiet = parser.isSet(quietOption);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    const QVector<BatchProcessor::FileResult> results = BatchProcessor::run(
+        inputs, options, [quiet](const BatchProcessor::FileResult &result, int done, int total) {
+            if (!result.error.isEmpty())
+            {
+                err() << "[" << done << "/" << total << "] " << result.inputPath << ": " << result.error << Qt::endl;
+            }
+            else if (result.failedCues > 0)
+            {
+                err() << "[" << done << "/" << total << "] " << result.inputPath << ": " << result.failedCues
+                      << " of " << result.cues << " cues failed" << Qt::endl;
+            }
+            else if (!quiet)
+            {
+                err() << "[" << done << "/" << total << "] " << result.outputPath
+                      << (result.skipped ? " (already complete)" : "") << Qt::endl;
+            }
+        });
+
+    int failedFiles = 0;
+    int cues = 0;
+    for (const BatchProcessor::FileResult &result : results)
+    {
+        cues += result.cues;
+        if (!result.ok())
+        {
+            ++failedFiles;
+        }
+    }
+
+    if (!quiet || failedFiles > 0)
+    {
+        err() << results.size() - failedFiles << " of " << results.size() << " files done, " << cues << " cues, "
+              << QString::number(elapsed.elapsed() / 1000.0, 'f', 1) << " s" << Qt::endl;
+    }
+
+    QString reportPath = parser.value(reportOption);
+    if (reportPath.isEmpty() && options.command == BatchProcessor::Command::Pipeline && !options.inPlace)
+    {
+        reportPath = QDir(options.outputDirectory).filePath(QStringLiteral("batch-report.json"));
+    }
+    if (!reportPath.isEmpty())
+    {
+        QString reportError;
+        if (!BatchProcessor::write_report(reportPath, results, options, elapsed.elapsed(), &reportError))
+        {
+            err() << "srt-editor-cli: cannot write report: " << reportError << Qt::endl;
+        }
+    }
+
+    if (parser.isSet(metricsFileOption))
+    {
+        QString metricsError;
+        if (!ProviderMetrics::instance().write_prometheus_file(parser.value(metricsFileOption), &metricsError))
+        {
+            err() << "srt-editor-cli: cannot write metrics: " << metricsError << Qt::endl;
+        }
+    }
+
+    SRT_LOG_INFO("cli", "finished, {} of {} files failed", failedFiles, results.size());
+    Logger::stop();
+    return failedFiles > 0 ? kExitFilesFailed : kExitOk;
+}
@@ -0,0 +1,170 @@
+#include "executor.h"
+
+#include "trace.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+// Index of the worker running on this thread, or -1 off the pool.
+thread_local int currentWorker = -1;
+thread_local const void *currentExecutor = nullptr;
+} // namespace
+
+CancellationToken::CancellationToken()
+    : cancelled_(std::make_shared<std::atomic<bool>>(false))
+{
+}
+
+void CancellationToken::cancel()
+{
+    cancelled_->store(true, std::memory_order_release);
+}
+
+bool CancellationToken::is_cancelled() const
+{
+    return cancelled_->load(std::memory_order_acquire);
+}
+
+Executor &Executor::instance()
+{
+    static Executor executor(static_cast<int>(std::max(2u, std::thread::hardware_concurrency())));
+    return executor;
+}
+
+Executor &Executor::io()
+{
+    // Enough for the windows' translation and speech caps plus single-row
+    // requests and catalog refreshes; the threads mostly sleep.
+    static Executor executor(16);
+    return executor;
+}
+
+Executor::Executor(int threadCount)
+{
+    const int count = std::max(1, threadCount);
+    workers_.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+
+    threads_.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        threads_.emplace_back(&Executor::worker_loop, this, i);
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (std::thread &thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void Executor::submit(Task task, Priority priority, CancellationToken token)
+{
+    if (!task || token.is_cancelled())
+    {
+        return;
+    }
+
+    Task guarded = [task = std::move(task), token = std::move(token)]() {
+        if (!token.is_cancelled())
+        {
+            task();
+        }
+    };
+
+    const int count = static_cast<int>(workers_.size());
+    const int target = currentExecutor == this ? currentWorker
+                                               : static_cast<int>(nextWorker_.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(count));
+    {
+        Worker &worker = *workers_[static_cast<size_t>(target)];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[static_cast<int>(priority)].push_back(std::move(guarded));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++pending_;
+    }
+    wake_.notify_one();
+}
+
+int Executor::thread_count() const
+{
+    return static_cast<int>(threads_.size());
+}
+
+bool Executor::take(int self, Task *task)
+{
+    const int count = static_cast<int>(workers_.size());
+    for (int priority = 0; priority < kPriorityCount; ++priority)
+    {
+        // Own work first, oldest task first.
+        {
+            Worker &own = *workers_[static_cast<size_t>(self)];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            std::deque<Task> &queue = own.queues[priority];
+            if (!queue.empty())
+            {
+                *task = std::move(queue.front());
+                queue.pop_front();
+                return true;
+            }
+        }
+
+        // Then steal from the opposite end, so owner and thief rarely meet.
+        for (int offset = 1; offset < count; ++offset)
+        {
+            Worker &victim = *workers_[static_cast<size_t>((self + offset) % count)];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            std::deque<Task> &queue = victim.queues[priority];
+            if (!queue.empty())
+            {
+                *task = std::move(queue.back());
+                queue.pop_back();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Executor::worker_loop(int index)
+{
+    currentWorker = index;
+    currentExecutor = this;
+    SRT_TRACE_THREAD_NAME(QStringLiteral("executor-%1").arg(index));
+
+    for (;;)
+    {
+        Task task;
+        if (take(index, &task))
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                --pending_;
+            }
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this]() { return stopping_ || pending_ > 0; });
+        if (stopping_)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,421 @@
+#include "find_panel.h"
+
+#include "logger.h"
+#include "subtitle_table.h"
+#include "trace.h"
+
+#include <QCheckBox>
+#include <QElapsedTimer>
+#include <QKeySequence>
+#include <QLineEdit>
+#include <QPointer>
+#include <QPushButton>
+#include <QShortcut>
+#include <QStringList>
+#include <QStyledItemDelegate>
+#include <algorithm>
+
+namespace
+{
+// Typing pauses this long before the column is searched.
+constexpr int kSearchDelayMs = 150;
+// Editing more rows than this at once re-indexes the whole column; posting
+// list inserts would cost more than a parallel rebuild.
+constexpr int kIncrementalRowLimit = 1000;
+
+// Paints hit rows of the text column. The table owns it; the panel may go
+// away first.
+class HitDelegate : public QStyledItemDelegate
+{
+public:
+    HitDelegate(FindPanel *panel, QObject *parent)
+        : QStyledItemDelegate(parent), panel_(panel)
+    {
+    }
+
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override
+    {
+        QStyledItemDelegate::initStyleOption(option, index);
+        if (!panel_)
+        {
+            return;
+        }
+        if (panel_->is_current_hit(index.row()))
+        {
+            option->backgroundBrush = QColor(255, 190, 80);
+        }
+        else if (panel_->is_hit(index.row()))
+        {
+            option->backgroundBrush = QColor(255, 235, 130);
+        }
+    }
+
+private:
+    QPointer<FindPanel> panel_;
+};
+} // namespace
+
+FindPanel::FindPanel(QTableWidget *table, QWidget *parent)
+    : QWidget(parent), ui(std::make_unique<Ui::FindPanel>()), table_(table)
+{
+    ui->setupUi(this);
+
+    searchTimer_.setSingleShot(true);
+    searchTimer_.setInterval(kSearchDelayMs);
+    connect(&searchTimer_, &QTimer::timeout, this, &FindPanel::search);
+    editTimer_.setSingleShot(true);
+    editTimer_.setInterval(0);
+    connect(&editTimer_, &QTimer::timeout, this, &FindPanel::flush_edits);
+    connect(ui->lineEditFind, &QLineEdit::textChanged, this, &FindPanel::schedule_search);
+    connect(ui->checkBoxMatchCase, &QCheckBox::toggled, this, &FindPanel::schedule_search);
+    connect(ui->checkBoxRegex, &QCheckBox::toggled, this, &FindPanel::schedule_search);
+    connect(ui->lineEditFind, &QLineEdit::returnPressed, this, &FindPanel::find_next);
+    connect(ui->btnNext, &QPushButton::clicked, this, &FindPanel::find_next);
+    connect(ui->btnPrevious, &QPushButton::clicked, this, &FindPanel::find_previous);
+    connect(ui->btnClose, &QPushButton::clicked, this, &FindPanel::close_panel);
+
+    auto *previousShortcut = new QShortcut(QKeySequence(QStringLiteral("Shift+Return")), this);
+    previousShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(previousShortcut, &QShortcut::activated, this, &FindPanel::find_previous);
+    auto *closeShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
+    closeShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(closeShortcut, &QShortcut::activated, this, &FindPanel::close_panel);
+
+    table_->setItemDelegateForColumn(SubtitleTable::TextColumn, new HitDelegate(this, table_));
+
+    // Edits re-index their rows in place; anything that moves rows makes
+    // the index stale until the next search rebuilds it.
+    QAbstractItemModel *model = table_->model();
+    connect(model, &QAbstractItemModel::dataChanged, this, &FindPanel::cells_changed);
+    connect(model, &QAbstractItemModel::rowsInserted, this, &FindPanel::rows_moved);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &FindPanel::rows_moved);
+    connect(model, &QAbstractItemModel::rowsMoved, this, &FindPanel::rows_moved);
+    connect(model, &QAbstractItemModel::modelReset, this, &FindPanel::rows_moved);
+    connect(model, &QAbstractItemModel::layoutChanged, this, &FindPanel::rows_moved);
+}
+
+FindPanel::~FindPanel()
+{
+    indexCancel_.cancel();
+}
+
+void FindPanel::activate()
+{
+    show();
+    ui->lineEditFind->setFocus();
+    ui->lineEditFind->selectAll();
+    if (!ui->lineEditFind->text().isEmpty())
+    {
+        schedule_search();
+    }
+}
+
+void FindPanel::find_next()
+{
+    if (hits_.isEmpty())
+    {
+        return;
+    }
+
+    // Continue from wherever the user is in the table.
+    const int row = table_->currentRow();
+    const auto next = std::upper_bound(hits_.cbegin(), hits_.cend(), row);
+    select_hit(next == hits_.cend() ? 0 : static_cast<int>(next - hits_.cbegin()));
+}
+
+void FindPanel::find_previous()
+{
+    if (hits_.isEmpty())
+    {
+        return;
+    }
+
+    const int row = table_->currentRow() < 0 ? table_->rowCount() : table_->currentRow();
+    const int previous = static_cast<int>(std::lower_bound(hits_.cbegin(), hits_.cend(), row) - hits_.cbegin()) - 1;
+    select_hit(previous < 0 ? static_cast<int>(hits_.size()) - 1 : previous);
+}
+
+bool FindPanel::is_hit(int row) const
+{
+    return std::binary_search(hits_.cbegin(), hits_.cend(), row);
+}
+
+bool FindPanel::is_current_hit(int row) const
+{
+    return currentHit_ >= 0 && hits_.at(currentHit_) == row;
+}
+
+void FindPanel::schedule_search()
+{
+    searchTimer_.start();
+}
+
+void FindPanel::search()
+{
+    SRT_TRACE_SCOPE("FindPanel::search");
+    hits_.clear();
+    currentHit_ = -1;
+    matcher_.reset();
+    ui->labelMatches->setToolTip(QString());
+
+    TextIndex::Query query;
+    query.pattern = ui->lineEditFind->text();
+    query.mode = ui->checkBoxRegex->isChecked() ? TextIndex::Mode::Regex : TextIndex::Mode::Substring;
+    query.caseSensitive = ui->checkBoxMatchCase->isChecked();
+    if (query.pattern.isEmpty() || !isVisible())
+    {
+        update_match_label();
+        table_->viewport()->update();
+        return;
+    }
+
+    auto matcher = std::make_unique<TextIndex::Matcher>(query);
+    if (!matcher->is_valid())
+    {
+        ui->labelMatches->setText(tr("Invalid pattern"));
+        ui->labelMatches->setToolTip(matcher->error());
+        table_->viewport()->update();
+        return;
+    }
+    matcher_ = std::move(matcher);
+
+    if (indexStale_)
+    {
+        // The search runs again once the index lands.
+        rebuild_index();
+        update_match_label();
+        table_->viewport()->update();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    hits_ = index_.find(*matcher_);
+    SRT_LOG_DEBUG("find", "{} hits in {} rows in {} ms", hits_.size(), index_.size(), timer.elapsed());
+
+    update_match_label();
+    table_->viewport()->update();
+}
+
+void FindPanel::rebuild_index()
+{
+    if (indexing_)
+    {
+        return;
+    }
+
+    SRT_TRACE_SCOPE("FindPanel::rebuild_index");
+    indexing_ = true;
+    editedDuringBuild_.clear();
+
+    // Item texts are shared, not copied, so the snapshot is cheap even for
+    // very long transcripts; the trigrams are built off the GUI thread.
+    const int rowCount = table_->rowCount();
+    QStringList texts;
+    texts.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row)
+    {
+        texts.append(cell_text(row));
+    }
+
+    const int generation = indexGeneration_;
+    auto index = std::make_shared<TextIndex>();
+    const QPointer<FindPanel> self(this);
+    Executor::instance().submit([self, index, texts, generation]() {
+        index->reset(texts);
+        postToGui(self, [self, index, generation]() {
+            self->indexing_ = false;
+            if (generation != self->indexGeneration_)
+            {
+                // Rows moved under the build; only start over if someone is
+                // waiting on the result.
+                if (self->matcher_)
+                {
+                    self->rebuild_index();
+                }
+                return;
+            }
+
+            self->index_ = std::move(*index);
+            self->indexStale_ = false;
+            for (const int row : std::as_const(self->editedDuringBuild_))
+            {
+                self->index_.set_text(row, self->cell_text(row));
+            }
+            self->editedDuringBuild_.clear();
+            if (self->matcher_)
+            {
+                self->search();
+            }
+        });
+    }, Executor::Priority::Normal, indexCancel_);
+}
+
+void FindPanel::rows_moved()
+{
+    ++indexGeneration_;
+    indexStale_ = true;
+    editedDuringBuild_.clear();
+    pendingEdits_.clear();
+    editTimer_.stop();
+
+    // Hit rows no longer line up with the table, so drop them until the
+    // search has run against the new layout.
+    if (!hits_.isEmpty())
+    {
+        hits_.clear();
+        currentHit_ = -1;
+        table_->viewport()->update();
+    }
+    if (matcher_)
+    {
+        schedule_search();
+    }
+}
+
+void FindPanel::cells_changed(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles)
+{
+    if (top_left.column() > SubtitleTable::TextColumn || bottom_right.column() < SubtitleTable::TextColumn)
+    {
+        return;
+    }
+    // Clip paths and other user data ride on the same items.
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole))
+    {
+        return;
+    }
+    // A stale index is rebuilt from the table as it is then.
+    if (indexStale_ && !indexing_)
+    {
+        return;
+    }
+    if (bottom_right.row() - top_left.row() >= kIncrementalRowLimit)
+    {
+        rows_moved();
+        return;
+    }
+
+    for (int row = top_left.row(); row <= bottom_right.row(); ++row)
+    {
+        pendingEdits_.insert(row);
+    }
+    if (pendingEdits_.size() > kIncrementalRowLimit)
+    {
+        rows_moved();
+        return;
+    }
+    editTimer_.start();
+}
+
+void FindPanel::flush_edits()
+{
+    const QSet<int> rows = pendingEdits_;
+    pendingEdits_.clear();
+    for (const int row : rows)
+    {
+        update_row(row);
+    }
+}
+
+void FindPanel::update_row(int row)
+{
+    if (indexing_)
+    {
+        editedDuringBuild_.insert(row);
+    }
+    if (indexStale_)
+    {
+        return;
+    }
+
+    const QString text = cell_text(row);
+    index_.set_text(row, text);
+    if (!matcher_)
+    {
+        return;
+    }
+
+    const bool hit = matcher_->matches(text);
+    const auto position = std::lower_bound(hits_.begin(), hits_.end(), row);
+    const bool wasHit = position != hits_.end() && *position == row;
+    if (hit == wasHit)
+    {
+        return;
+    }
+
+    const int hitIndex = static_cast<int>(position - hits_.begin());
+    if (hit)
+    {
+        hits_.insert(position, row);
+        if (currentHit_ >= hitIndex)
+        {
+            ++currentHit_;
+        }
+    }
+    else
+    {
+        hits_.erase(position);
+        if (currentHit_ == hitIndex)
+        {
+            currentHit_ = -1;
+        }
+        else if (currentHit_ > hitIndex)
+        {
+            --currentHit_;
+        }
+    }
+    update_match_label();
+}
+
+void FindPanel::select_hit(int hit)
+{
+    currentHit_ = hit;
+    const int row = hits_.at(hit);
+    table_->setCurrentCell(row, SubtitleTable::TextColumn);
+    table_->scrollTo(table_->model()->index(row, SubtitleTable::TextColumn), QAbstractItemView::PositionAtCenter);
+    update_match_label();
+    table_->viewport()->update();
+}
+
+void FindPanel::close_panel()
+{
+    searchTimer_.stop();
+    hide();
+    hits_.clear();
+    currentHit_ = -1;
+    matcher_.reset();
+    update_match_label();
+    table_->viewport()->update();
+    table_->setFocus();
+}
+
+void FindPanel::update_match_label()
+{
+    if (!matcher_)
+    {
+        ui->labelMatches->clear();
+    }
+    else if (indexStale_)
+    {
+        ui->labelMatches->setText(tr("Indexing..."));
+    }
+    else if (hits_.isEmpty())
+    {
+        ui->labelMatches->setText(tr("No matches"));
+    }
+    else if (currentHit_ < 0)
+    {
+        ui->labelMatches->setText(tr("%1 matches").arg(hits_.size()));
+    }
+    else
+    {
+        ui->labelMatches->setText(tr("%1 of %2").arg(currentHit_ + 1).arg(hits_.size()));
+    }
+}
+
+QString FindPanel::cell_text(int row) const
+{
+    const QTableWidgetItem *item = table_->item(row, SubtitleTable::TextColumn);
+    return item ? item->text() : QString();
+}
@@ -0,0 +1,258 @@
+#include "local_tts_engine.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QProcess>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int kStartTimeoutMs = 15000;
+constexpr int kSynthesisTimeoutMs = 120000;
+constexpr int kStopTimeoutMs = 2000;
+constexpr int kMaxWorkers = 16;
+
+bool startEngine(QProcess &process, const LocalTtsEngine::Config &config)
+{
+    process.setProgram(config.executable);
+    process.setArguments({QStringLiteral("--model"),
+                          config.model,
+                          QStringLiteral("--json-input"),
+                          QStringLiteral("--length_scale"),
+                          QString::number(config.lengthScale, 'f', 3)});
+    // Engine logging is not read; an unread pipe would eventually block it.
+    process.setStandardErrorFile(QProcess::nullDevice());
+    process.start();
+    return process.waitForStarted(kStartTimeoutMs);
+}
+
+void stopEngine(QProcess &process)
+{
+    if (process.state() == QProcess::NotRunning)
+    {
+        return;
+    }
+
+    process.closeWriteChannel();
+    if (!process.waitForFinished(kStopTimeoutMs))
+    {
+        process.kill();
+        process.waitForFinished(kStopTimeoutMs);
+    }
+}
+
+// The engine prints the path of each clip once it has been written.
+bool waitForCompletion(QProcess &process)
+{
+    while (true)
+    {
+        while (process.canReadLine())
+        {
+            if (!process.readLine().trimmed().isEmpty())
+            {
+                return true;
+            }
+        }
+
+        if (process.state() != QProcess::Running || !process.waitForReadyRead(kSynthesisTimeoutMs))
+        {
+            return false;
+        }
+    }
+}
+} // namespace
+
+bool LocalTtsEngine::Config::operator==(const Config &other) const
+{
+    return executable == other.executable && model == other.model && workers == other.workers &&
+           std::abs(lengthScale - other.lengthScale) < 1e-6;
+}
+
+LocalTtsEngine &LocalTtsEngine::instance()
+{
+    static LocalTtsEngine engine;
+    static std::once_flag quitHookFlag;
+    std::call_once(quitHookFlag, []() {
+        // Engine processes must not outlive the application.
+        if (QCoreApplication *app = QCoreApplication::instance())
+        {
+            QObject::connect(app, &QCoreApplication::aboutToQuit, []() { LocalTtsEngine::instance().shutdown(); });
+        }
+    });
+    return engine;
+}
+
+LocalTtsEngine::~LocalTtsEngine()
+{
+    shutdown();
+}
+
+bool LocalTtsEngine::synthesize(const QString &text,
+                                const QString &outputPath,
+                                const Config &config,
+                                QString *errorMessage)
+{
+    if (config.executable.isEmpty() || config.model.isEmpty())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = QObject::tr("Configure the local engine executable and voice model in Settings ▸ Audio.");
+        }
+        return false;
+    }
+
+    std::future<Result> pending;
+    {
+        std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+        if (workers_.empty() || config != config_)
+        {
+            stop();
+            {
+                // Jobs queued for the old settings would come out in the
+                // wrong voice or speed from the new pool.
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                fail_jobs_locked(config, QObject::tr("The local speech engine was restarted with other settings."));
+            }
+            start(config);
+        }
+
+        Job job;
+        job.text = text;
+        job.outputPath = outputPath;
+        job.config = config;
+        pending = job.result.get_future();
+
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queue_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+
+    const Result result = pending.get();
+    if (!result.ok && errorMessage)
+    {
+        *errorMessage = result.error;
+    }
+    return result.ok;
+}
+
+void LocalTtsEngine::shutdown()
+{
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+    stop();
+
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    for (Job &job : queue_)
+    {
+        job.result.set_value(Result{false, QObject::tr("The local speech engine was stopped.")});
+    }
+    queue_.clear();
+}
+
+void LocalTtsEngine::fail_jobs_locked(const Config &keep, const QString &error)
+{
+    for (auto it = queue_.begin(); it != queue_.end();)
+    {
+        if (it->config == keep)
+        {
+            ++it;
+            continue;
+        }
+        it->result.set_value(Result{false, error});
+        it = queue_.erase(it);
+    }
+}
+
+void LocalTtsEngine::start(const Config &config)
+{
+    config_ = config;
+    const int count = std::clamp(config.workers, 1, kMaxWorkers);
+    workers_.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        workers_.emplace_back(&LocalTtsEngine::worker_loop, this, config);
+    }
+}
+
+void LocalTtsEngine::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (std::thread &worker : workers_)
+    {
+        worker.join();
+    }
+    workers_.clear();
+
+    // Jobs still queued stay for the next pool if they match its settings;
+    // synthesize() fails the rest.
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stopping_ = false;
+}
+
+void LocalTtsEngine::worker_loop(Config config)
+{
+    // QProcess is used through its blocking API only, so this thread needs
+    // no event loop.
+    QProcess process;
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_)
+            {
+                break;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        if (job.config != config)
+        {
+            job.result.set_value(Result{false, QObject::tr("The local speech engine was restarted with other settings.")});
+            continue;
+        }
+
+        // A crashed or timed-out engine is restarted by the next job.
+        if (process.state() != QProcess::Running && !startEngine(process, config))
+        {
+            job.result.set_value(Result{false,
+                                        QObject::tr("Unable to start the local speech engine \"%1\": %2")
+                                            .arg(config.executable, process.errorString())});
+            continue;
+        }
+
+        const QByteArray request =
+            QJsonDocument(QJsonObject{{QStringLiteral("text"), job.text},
+                                      {QStringLiteral("output_file"), job.outputPath}})
+                .toJson(QJsonDocument::Compact) +
+            '\n';
+
+        const bool sent = process.write(request) == request.size() && process.waitForBytesWritten(kStartTimeoutMs);
+        if (!sent || !waitForCompletion(process))
+        {
+            stopEngine(process);
+            job.result.set_value(Result{false, QObject::tr("The local speech engine did not produce %1.").arg(job.outputPath)});
+            continue;
+        }
+
+        const bool written = QFileInfo(job.outputPath).size() > 44;
+        job.result.set_value(Result{written,
+                                    written ? QString()
+                                            : QObject::tr("The local speech engine produced an empty clip for %1.")
+                                                  .arg(job.outputPath)});
+    }
+
+    stopEngine(process);
+}
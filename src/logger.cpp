@@ -0,0 +1,386 @@
+#include "logger.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr std::uint64_t kRingCapacity = 1u << 10; // records per thread, power of two
+constexpr auto kDrainInterval = std::chrono::milliseconds(100);
+
+// Single producer (the owning thread), single consumer (the sink thread).
+struct LogRing
+{
+    int tid = 0;
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> tail{0};
+    std::unique_ptr<LogRecord[]> slots{new LogRecord[kRingCapacity]};
+};
+
+// Rings are registered once per thread and never freed, so records from a
+// thread that has exited are still drained.
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<LogRing>> rings;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+LogRing &threadRing()
+{
+    thread_local LogRing *ring = []() {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto created = std::make_unique<LogRing>();
+        created->tid = static_cast<int>(reg.rings.size()) + 1;
+        reg.rings.push_back(std::move(created));
+        return reg.rings.back().get();
+    }();
+    return *ring;
+}
+
+std::atomic<std::uint64_t> droppedRecords{0};
+
+const char *levelName(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Trace:
+        return "TRACE";
+    case LogLevel::Debug:
+        return "DEBUG";
+    case LogLevel::Info:
+        return "INFO ";
+    case LogLevel::Warn:
+        return "WARN ";
+    case LogLevel::Error:
+        return "ERROR";
+    case LogLevel::Off:
+        break;
+    }
+    return "?????";
+}
+
+void appendArg(const LogRecord &record, const LogRecord::Arg &arg, QByteArray *out)
+{
+    switch (arg.type)
+    {
+    case LogRecord::ArgType::Signed:
+        out->append(QByteArray::number(static_cast<qlonglong>(arg.i)));
+        break;
+    case LogRecord::ArgType::Unsigned:
+        out->append(QByteArray::number(static_cast<qulonglong>(arg.u)));
+        break;
+    case LogRecord::ArgType::Double:
+        out->append(QByteArray::number(arg.d, 'g', 6));
+        break;
+    case LogRecord::ArgType::Text:
+        out->append(record.text + arg.textOffset, arg.textLength);
+        break;
+    }
+}
+
+QByteArray formatRecord(int tid, const LogRecord &record)
+{
+    QByteArray line = QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString(Qt::ISODateWithMs).toUtf8();
+    line += ' ';
+    line += levelName(record.level);
+    line += " [";
+    line += record.category ? record.category : "";
+    line += "] t";
+    line += QByteArray::number(tid);
+    line += ' ';
+
+    int argIndex = 0;
+    for (const char *cursor = record.format ? record.format : ""; *cursor; ++cursor)
+    {
+        if (cursor[0] == '{' && cursor[1] == '}' && argIndex < record.argCount)
+        {
+            appendArg(record, record.args[argIndex++], &line);
+            ++cursor;
+            continue;
+        }
+        line += *cursor;
+    }
+    // Arguments without a placeholder are kept rather than silently lost.
+    for (; argIndex < record.argCount; ++argIndex)
+    {
+        line += ' ';
+        appendArg(record, record.args[argIndex], &line);
+    }
+
+    line.replace('\n', "\\n");
+    line += '\n';
+    return line;
+}
+
+class Sink
+{
+public:
+    bool start(const QString &path, qint64 maxBytes, int maxFiles, QString *errorMessage)
+    {
+        stop();
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        file_.setFileName(path);
+        if (!file_.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            if (errorMessage)
+            {
+                *errorMessage = file_.errorString();
+            }
+            return false;
+        }
+
+        path_ = path;
+        maxBytes_ = std::max<qint64>(maxBytes, 4096);
+        maxFiles_ = std::max(maxFiles, 1);
+        minimumLevel_ = LogLevel::Trace;
+        launch();
+        return true;
+    }
+
+    void start_console(LogLevel minimum)
+    {
+        stop();
+
+        // Wraps the handle without taking it over, so close() leaves stderr open.
+        file_.open(stderr, QIODevice::WriteOnly);
+        path_.clear();
+        maxBytes_ = 0;
+        minimumLevel_ = minimum;
+        launch();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+            {
+                return;
+            }
+            running_ = false;
+        }
+        wake_.notify_one();
+        thread_.join();
+        file_.close();
+    }
+
+    void wake()
+    {
+        wake_.notify_one();
+    }
+
+private:
+    void launch()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = true;
+        }
+        thread_ = std::thread(&Sink::run, this);
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_)
+        {
+            wake_.wait_for(lock, kDrainInterval);
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+        lock.unlock();
+        drain();
+    }
+
+    void drain()
+    {
+        std::vector<LogRing *> rings;
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            rings.reserve(reg.rings.size());
+            for (const auto &ring : reg.rings)
+            {
+                rings.push_back(ring.get());
+            }
+        }
+
+        batch_.clear();
+        for (LogRing *ring : rings)
+        {
+            const std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (std::uint64_t index = tail; index < head; ++index)
+            {
+                batch_.emplace_back(ring->tid, ring->slots[index & (kRingCapacity - 1)]);
+            }
+            ring->tail.store(head, std::memory_order_release);
+        }
+        if (batch_.empty())
+        {
+            return;
+        }
+
+        std::stable_sort(batch_.begin(), batch_.end(), [](const auto &a, const auto &b) {
+            return a.second.timestampMs < b.second.timestampMs;
+        });
+
+        for (const auto &entry : batch_)
+        {
+            // Records below the sink's level are still drained, so the rings
+            // keep room for the ones it does write.
+            if (entry.second.level < minimumLevel_)
+            {
+                continue;
+            }
+            file_.write(formatRecord(entry.first, entry.second));
+            if (maxBytes_ > 0 && file_.size() >= maxBytes_)
+            {
+                rotate();
+            }
+        }
+
+        const std::uint64_t dropped = droppedRecords.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            file_.write(QByteArray("-- ") + QByteArray::number(static_cast<qulonglong>(dropped)) +
+                        " log records dropped, rings were full --\n");
+        }
+        file_.flush();
+    }
+
+    void rotate()
+    {
+        file_.close();
+        QFile::remove(path_ + QLatin1Char('.') + QString::number(maxFiles_));
+        for (int i = maxFiles_ - 1; i >= 1; --i)
+        {
+            QFile::rename(path_ + QLatin1Char('.') + QString::number(i),
+                          path_ + QLatin1Char('.') + QString::number(i + 1));
+        }
+        QFile::rename(path_, path_ + QStringLiteral(".1"));
+        file_.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    bool running_ = false;
+
+    QFile file_;
+    QString path_;
+    qint64 maxBytes_ = 0; // 0 never rotates
+    int maxFiles_ = 1;
+    LogLevel minimumLevel_ = LogLevel::Trace;
+    std::vector<std::pair<int, LogRecord>> batch_;
+};
+
+// Deliberately never destroyed: worker threads may still log while static
+// objects are torn down at exit. Logger::stop() does the orderly shutdown.
+Sink &sink()
+{
+    static Sink *instance = new Sink;
+    return *instance;
+}
+} // namespace
+
+void Logger::set_level(LogLevel level)
+{
+    minimumLevel_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::level_from_string(const QString &name, LogLevel fallback)
+{
+    const QString normalized = name.trimmed().toLower();
+    if (normalized == QLatin1String("trace"))
+    {
+        return LogLevel::Trace;
+    }
+    if (normalized == QLatin1String("debug"))
+    {
+        return LogLevel::Debug;
+    }
+    if (normalized == QLatin1String("info"))
+    {
+        return LogLevel::Info;
+    }
+    if (normalized == QLatin1String("warn") || normalized == QLatin1String("warning"))
+    {
+        return LogLevel::Warn;
+    }
+    if (normalized == QLatin1String("error"))
+    {
+        return LogLevel::Error;
+    }
+    if (normalized == QLatin1String("off"))
+    {
+        return LogLevel::Off;
+    }
+    return fallback;
+}
+
+bool Logger::start(const QString &path, qint64 maxBytes, int maxFiles, QString *errorMessage)
+{
+    return sink().start(path, maxBytes, maxFiles, errorMessage);
+}
+
+void Logger::start_console(LogLevel minimum)
+{
+    sink().start_console(minimum);
+}
+
+void Logger::stop()
+{
+    sink().stop();
+}
+
+std::uint64_t Logger::dropped()
+{
+    return droppedRecords.load(std::memory_order_relaxed);
+}
+
+std::int64_t Logger::now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Logger::submit(const LogRecord &record)
+{
+    LogRing &ring = threadRing();
+    const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    const std::uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= kRingCapacity)
+    {
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring.slots[head & (kRingCapacity - 1)] = record;
+    ring.head.store(head + 1, std::memory_order_release);
+
+    if (record.level >= LogLevel::Warn)
+    {
+        sink().wake();
+    }
+}
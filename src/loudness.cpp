@@ -0,0 +1,343 @@
+#include "loudness.h"
+
+#include "parallel.h"
+#include "simd.h"
+#include "wav_file.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kAbsoluteGateLufs = -70.0;
+constexpr double kRelativeGateLu = -10.0;
+constexpr double kBlockSeconds = 0.4;
+constexpr int kSubBlocksPerBlock = 4; // 75% block overlap
+constexpr int kOversampling = 4;
+constexpr int kTapsPerPhase = 12;
+constexpr double kMinimumGainDb = 0.05;
+
+struct Biquad
+{
+    double b0 = 1.0;
+    double b1 = 0.0;
+    double b2 = 0.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+};
+
+// BS.1770 K-weighting: a high shelf modelling the head, then the RLB
+// high-pass. Coefficients are derived for any sample rate, matching the
+// published 48 kHz values.
+std::array<Biquad, 2> kWeightingFilters(int sampleRate)
+{
+    std::array<Biquad, 2> filters;
+
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(kPi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        filters[0].b0 = (vh + vb * k / q + k * k) / a0;
+        filters[0].b1 = 2.0 * (k * k - vh) / a0;
+        filters[0].b2 = (vh - vb * k / q + k * k) / a0;
+        filters[0].a1 = 2.0 * (k * k - 1.0) / a0;
+        filters[0].a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(kPi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        filters[1].b0 = 1.0;
+        filters[1].b1 = -2.0;
+        filters[1].b2 = 1.0;
+        filters[1].a1 = 2.0 * (k * k - 1.0) / a0;
+        filters[1].a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    return filters;
+}
+
+// Runs both K-weighting stages over one channel (transposed direct form II).
+// The recursion cannot be vectorized; the block energy sums that follow are.
+void applyKWeighting(std::vector<float> &channel, const std::array<Biquad, 2> &filters)
+{
+    for (const Biquad &f : filters)
+    {
+        double z1 = 0.0;
+        double z2 = 0.0;
+        for (float &sample : channel)
+        {
+            const double x = sample;
+            const double y = f.b0 * x + z1;
+            z1 = f.b1 * x - f.a1 * y + z2;
+            z2 = f.b2 * x - f.a2 * y;
+            sample = static_cast<float>(y);
+        }
+    }
+}
+
+// Polyphase interpolation filter for true-peak detection: a windowed sinc
+// cut off at the original Nyquist, stored reversed per phase so each output
+// is one dot product over the most recent input samples.
+const std::array<std::array<float, kTapsPerPhase>, kOversampling> &truePeakPhases()
+{
+    static const auto phases = []() {
+        std::array<std::array<float, kTapsPerPhase>, kOversampling> result{};
+        constexpr int taps = kOversampling * kTapsPerPhase;
+        const double centre = (taps - 1) / 2.0;
+        for (int phase = 0; phase < kOversampling; ++phase)
+        {
+            double sum = 0.0;
+            std::array<double, kTapsPerPhase> coefficients{};
+            for (int k = 0; k < kTapsPerPhase; ++k)
+            {
+                const int n = k * kOversampling + phase;
+                const double x = (n - centre) / kOversampling;
+                const double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+                const double window = 0.42 - 0.5 * std::cos(2.0 * kPi * (n + 0.5) / taps) +
+                                      0.08 * std::cos(4.0 * kPi * (n + 0.5) / taps);
+                coefficients[static_cast<size_t>(k)] = sinc * window;
+                sum += coefficients[static_cast<size_t>(k)];
+            }
+            for (int k = 0; k < kTapsPerPhase; ++k)
+            {
+                result[static_cast<size_t>(phase)][static_cast<size_t>(kTapsPerPhase - 1 - k)] =
+                    static_cast<float>(coefficients[static_cast<size_t>(k)] / sum);
+            }
+        }
+        return result;
+    }();
+    return phases;
+}
+
+float truePeak(const std::vector<float> &channel)
+{
+    const auto &phases = truePeakPhases();
+    const int length = static_cast<int>(channel.size());
+
+    // Zero history before the first sample and after the last one.
+    std::vector<float> padded(static_cast<size_t>(length + 2 * kTapsPerPhase), 0.0f);
+    std::copy(channel.begin(), channel.end(), padded.begin() + kTapsPerPhase);
+
+    float peak = peakAbs(channel.data(), length);
+    for (int n = 1; n <= length + kTapsPerPhase; ++n)
+    {
+        const float *history = padded.data() + n;
+        for (const auto &phase : phases)
+        {
+            peak = std::max(peak, std::fabs(dotProduct(history, phase.data(), kTapsPerPhase)));
+        }
+    }
+    return peak;
+}
+
+double powerToLufs(double power)
+{
+    return -0.691 + 10.0 * std::log10(power);
+}
+
+bool readClip(const QString &path, WavFormat *format, std::vector<float> *samples)
+{
+    return WavFile::is_wav(path) && WavFile::read(path, format, samples) && !samples->empty();
+}
+
+enum class Outcome
+{
+    Adjusted,
+    Unchanged,
+    Skipped,
+    Failed
+};
+
+Outcome normalizeClip(const QString &path, double targetLufs, double ceilingDbtp)
+{
+    WavFormat format;
+    std::vector<float> samples;
+    if (!readClip(path, &format, &samples))
+    {
+        return Outcome::Skipped;
+    }
+
+    const Loudness::Measurement measurement = Loudness::measure(samples, format.channels, format.sampleRate);
+    if (!measurement.valid)
+    {
+        return Outcome::Skipped;
+    }
+
+    const double gainDb = Loudness::gain_for_target(measurement, targetLufs, ceilingDbtp);
+    if (std::abs(gainDb) < kMinimumGainDb)
+    {
+        return Outcome::Unchanged;
+    }
+
+    // The rewrite goes through a temporary file, so cached copies that share
+    // the clip's inode keep their original level.
+    scaleInPlace(samples.data(), static_cast<long long>(samples.size()), static_cast<float>(std::pow(10.0, gainDb / 20.0)));
+    return WavFile::write(path, format, samples) ? Outcome::Adjusted : Outcome::Failed;
+}
+} // namespace
+
+Loudness::Measurement Loudness::measure(const std::vector<float> &samples, int channels, int sampleRate)
+{
+    Measurement measurement;
+    if (samples.empty() || channels <= 0 || sampleRate <= 0)
+    {
+        return measurement;
+    }
+
+    const size_t frames = samples.size() / static_cast<size_t>(channels);
+    const auto filters = kWeightingFilters(sampleRate);
+    const int subBlock = std::max(1, static_cast<int>(std::lround(kBlockSeconds * sampleRate / kSubBlocksPerBlock)));
+    const size_t subBlockCount = std::max<size_t>(1, frames / static_cast<size_t>(subBlock));
+
+    // Energy per 100 ms sub-block, summed over channels. Channel weights are
+    // 1.0 for the mono and stereo clips speech providers produce.
+    std::vector<double> subBlockEnergy(subBlockCount, 0.0);
+    float peak = 0.0f;
+    std::vector<float> channel(frames);
+    for (int c = 0; c < channels; ++c)
+    {
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            channel[frame] = samples[frame * static_cast<size_t>(channels) + static_cast<size_t>(c)];
+        }
+        peak = std::max(peak, truePeak(channel));
+
+        applyKWeighting(channel, filters);
+        for (size_t block = 0; block < subBlockCount; ++block)
+        {
+            const size_t begin = block * static_cast<size_t>(subBlock);
+            const int length = static_cast<int>(std::min(static_cast<size_t>(subBlock), frames - begin));
+            subBlockEnergy[block] += sumOfSquares(channel.data() + begin, length);
+        }
+    }
+
+    // Gating blocks of 400 ms stepping by 100 ms. Clips shorter than one
+    // block are measured as a single block.
+    std::vector<double> blockPower;
+    const size_t span = std::min<size_t>(kSubBlocksPerBlock, subBlockCount);
+    const size_t blockCount = subBlockCount - span + 1;
+    const size_t blockFrames = std::min(frames, span * static_cast<size_t>(subBlock));
+    blockPower.reserve(blockCount);
+    for (size_t block = 0; block < blockCount; ++block)
+    {
+        double energy = 0.0;
+        for (size_t i = 0; i < span; ++i)
+        {
+            energy += subBlockEnergy[block + i];
+        }
+        blockPower.push_back(energy / static_cast<double>(blockFrames));
+    }
+
+    auto gatedMean = [&blockPower](double thresholdLufs) {
+        double sum = 0.0;
+        size_t count = 0;
+        for (double power : blockPower)
+        {
+            if (power > 0.0 && powerToLufs(power) > thresholdLufs)
+            {
+                sum += power;
+                ++count;
+            }
+        }
+        return count > 0 ? sum / static_cast<double>(count) : 0.0;
+    };
+
+    const double absoluteMean = gatedMean(kAbsoluteGateLufs);
+    if (absoluteMean <= 0.0)
+    {
+        return measurement;
+    }
+    // Both gates apply to the second pass: a block has to clear the absolute
+    // gate as well as the relative one.
+    const double relativeMean =
+        gatedMean(std::max(kAbsoluteGateLufs, powerToLufs(absoluteMean) + kRelativeGateLu));
+    if (relativeMean <= 0.0)
+    {
+        return measurement;
+    }
+
+    measurement.valid = true;
+    measurement.integratedLufs = powerToLufs(relativeMean);
+    measurement.truePeakDbtp = 20.0 * std::log10(std::max(peak, 1e-9f));
+    return measurement;
+}
+
+Loudness::Measurement Loudness::measure_file(const QString &path)
+{
+    WavFormat format;
+    std::vector<float> samples;
+    if (!readClip(path, &format, &samples))
+    {
+        return {};
+    }
+    return measure(samples, format.channels, format.sampleRate);
+}
+
+QHash<QString, Loudness::Measurement> Loudness::measure_files(const QStringList &paths)
+{
+    std::vector<Measurement> results(static_cast<size_t>(paths.size()));
+    parallelFor(static_cast<int>(paths.size()), [&](int index) {
+        results[static_cast<size_t>(index)] = measure_file(paths.at(index));
+    });
+
+    QHash<QString, Measurement> measurements;
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        measurements.insert(paths.at(i), results[static_cast<size_t>(i)]);
+    }
+    return measurements;
+}
+
+double Loudness::gain_for_target(const Measurement &measurement, double targetLufs, double ceilingDbtp)
+{
+    if (!measurement.valid)
+    {
+        return 0.0;
+    }
+    const double gain = targetLufs - measurement.integratedLufs;
+    return std::min(gain, ceilingDbtp - measurement.truePeakDbtp);
+}
+
+bool Loudness::normalize_file(const QString &path, double targetLufs, double ceilingDbtp)
+{
+    const Outcome outcome = normalizeClip(path, targetLufs, ceilingDbtp);
+    return outcome == Outcome::Adjusted || outcome == Outcome::Unchanged;
+}
+
+Loudness::Report Loudness::normalize_files(const QStringList &paths, double targetLufs, double ceilingDbtp)
+{
+    std::atomic<int> adjusted{0};
+    std::atomic<int> skipped{0};
+    std::atomic<int> failed{0};
+    parallelFor(static_cast<int>(paths.size()), [&](int index) {
+        switch (normalizeClip(paths.at(index), targetLufs, ceilingDbtp))
+        {
+        case Outcome::Adjusted:
+            ++adjusted;
+            break;
+        case Outcome::Unchanged:
+        case Outcome::Skipped:
+            ++skipped;
+            break;
+        case Outcome::Failed:
+            ++failed;
+            break;
+        }
+    });
+
+    Report report;
+    report.adjusted = adjusted.load();
+    report.skipped = skipped.load();
+    report.failed = failed.load();
+    return report;
+}
@@ -1,5 +1,50 @@
 #include "main.h"
 
+#include "logger.h"
+#include "provider_metrics.h"
+#include "trace.h"
+#include "ui_watchdog.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <memory>
+
+namespace
+{
+constexpr int kMetricsExportIntervalMs = 15000;
+constexpr qint64 kLogFileMaxBytes = 5 * 1024 * 1024;
+constexpr int kLogFilesKept = 5;
+constexpr int kWatchdogIntervalMs = 50;
+constexpr int kDefaultStallThresholdMs = 200;
+
+// Taken at startup so every artifact of one session shares the same stamp.
+const QString sessionStamp = QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"));
+
+// Per-session artifacts go to <app data>/<directory>/<prefix>-<start time>.json.
+QString sessionFilePath(const QString &directory, const QString &prefix)
+{
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+                         QLatin1Char('/') + directory;
+    QDir().mkpath(path);
+    return path + QLatin1Char('/') + prefix + QLatin1Char('-') + sessionStamp + QStringLiteral(".json");
+}
+
+// SRT_EDITOR_TRACE_FILE overrides where the session trace is written.
+QString traceOutputPath()
+{
+    const QString overridePath = qEnvironmentVariable("SRT_EDITOR_TRACE_FILE");
+    if (!overridePath.isEmpty())
+    {
+        return overridePath;
+    }
+
+    return sessionFilePath(QStringLiteral("traces"), QStringLiteral("session"));
+}
+} // namespace
+
 int main(int argc, char *argv[])
 {
     QApplication application(argc, argv);
@@ -7,8 +52,70 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationName("haidanghth910");
     QCoreApplication::setApplicationName("srteditor");
 
+    Settings settings;
+    Logger::set_level(Logger::level_from_string(settings.value("log/level").toString(), LogLevel::Info));
+    const QString logPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+                            QStringLiteral("/logs/srt-editor.log");
+    QString logError;
+    if (!Logger::start(logPath, kLogFileMaxBytes, kLogFilesKept, &logError))
+    {
+        qWarning("Failed to open log file %s: %s", qUtf8Printable(logPath), qUtf8Printable(logError));
+    }
+    SRT_LOG_INFO("app", "session started, version {}", SRT_EDITOR_VERSION);
+
+    if (Trace::enabled())
+    {
+        SRT_TRACE_THREAD_NAME(QStringLiteral("GUI"));
+        QObject::connect(&application, &QCoreApplication::aboutToQuit, []() {
+            const QString path = traceOutputPath();
+            QString errorMessage;
+            if (!Trace::write_chrome_json(path, &errorMessage))
+            {
+                SRT_LOG_WARN("app", "failed to write trace to {}: {}", path, errorMessage);
+            }
+        });
+    }
+
+    // metrics/prometheus_file, when set, is kept current for the
+    // node_exporter textfile collector.
+    QTimer metricsExportTimer;
+    const QString metricsPath = settings.value("metrics/prometheus_file").toString().trimmed();
+    if (!metricsPath.isEmpty())
+    {
+        const auto exportMetrics = [metricsPath]() {
+            QString errorMessage;
+            if (!ProviderMetrics::instance().write_prometheus_file(metricsPath, &errorMessage))
+            {
+                SRT_LOG_WARN("app", "failed to write metrics to {}: {}", metricsPath, errorMessage);
+            }
+        };
+        QObject::connect(&metricsExportTimer, &QTimer::timeout, exportMetrics);
+        QObject::connect(&application, &QCoreApplication::aboutToQuit, exportMetrics);
+        metricsExportTimer.start(kMetricsExportIntervalMs);
+    }
+
+    // Watches the GUI event loop for the whole session and writes a
+    // responsiveness report on exit. watchdog/stall_ms sets the threshold.
+    std::unique_ptr<UiWatchdog> watchdog;
+    if (settings.value("watchdog/enabled", true).toBool())
+    {
+        const int stallThresholdMs = settings.value("watchdog/stall_ms", kDefaultStallThresholdMs).toInt();
+        watchdog = std::make_unique<UiWatchdog>(kWatchdogIntervalMs, stallThresholdMs);
+        QObject::connect(&application, &QCoreApplication::aboutToQuit, [&watchdog]() {
+            const QString path = sessionFilePath(QStringLiteral("reports"), QStringLiteral("responsiveness"));
+            QString errorMessage;
+            if (!watchdog->write_report(path, &errorMessage))
+            {
+                SRT_LOG_WARN("app", "failed to write responsiveness report to {}: {}", path, errorMessage);
+            }
+        });
+    }
+
     MainWindow window;
     window.show();
 
-    return application.exec();
+    const int status = application.exec();
+    // Runs after every aboutToQuit handler, so their warnings still land.
+    Logger::stop();
+    return status;
 }
@@ -1,160 +1,66 @@
 #include "main_window.h"
 
-#include <QRegularExpression>
+#include "executor.h"
+#include "logger.h"
+#include "srt_timing.h"
+#include "subtitle_table.h"
+#include "trace.h"
+
+#include <QAction>
+#include <QInputDialog>
+#include <QKeySequence>
+#include <QLineEdit>
+#include <QPointer>
+#include <QUndoCommand>
 #include <QVector>
 #include <QPixmap>
 #include <algorithm>
+#include <memory>
 
 namespace
 {
-    constexpr qint64 kMillisecondsPerDay = 24LL * 60 * 60 * 1000;
+    // Path of the synthesized clip for a row, stored on its text item.
+    constexpr int kClipPathRole = Qt::UserRole + 1;
 
-    qint64 toMilliseconds(int hours, int minutes, int seconds, int milliseconds)
+    // A batch of text column edits as one undo step. Rows whose text was
+    // changed by hand in between are left as the user made them.
+    class TextEditCommand : public QUndoCommand
     {
-        return (((static_cast<qint64>(hours) * 60) + minutes) * 60 + seconds) * 1000 + milliseconds;
-    }
-
-    qint64 parseSrtTimestamp(const QString &value)
-    {
-        static const QRegularExpression pattern(QStringLiteral(R"(^(\d{2}):(\d{2}):(\d{2}),(\d{3})$)"));
-        const QRegularExpressionMatch match = pattern.match(value.trimmed());
-        if (!match.hasMatch())
-        {
-            return -1;
-        }
-
-        return toMilliseconds(match.captured(1).toInt(),
-                              match.captured(2).toInt(),
-                              match.captured(3).toInt(),
-                              match.captured(4).toInt());
-    }
-
-    qint64 parseFlexibleDuration(const QString &value)
-    {
-        const QString trimmed = value.trimmed();
-        if (trimmed.isEmpty())
+    public:
+        TextEditCommand(QTableWidget *table, QVector<TextTransform::Change> changes, const QString &text)
+            : QUndoCommand(text), table_(table), changes_(std::move(changes))
         {
-            return -1;
         }
 
-        static const QRegularExpression longPattern(QStringLiteral(R"(^(\d{2}):(\d{2}):(\d{2})[\.,](\d{3})$)"));
-        QRegularExpressionMatch match = longPattern.match(trimmed);
-        if (match.hasMatch())
+        void undo() override
         {
-            return toMilliseconds(match.captured(1).toInt(),
-                                  match.captured(2).toInt(),
-                                  match.captured(3).toInt(),
-                                  match.captured(4).toInt());
+            apply(false);
         }
 
-        static const QRegularExpression mediumPattern(QStringLiteral(R"(^(\d{2}):(\d{2})[\.,](\d{3})$)"));
-        match = mediumPattern.match(trimmed);
-        if (match.hasMatch())
+        void redo() override
         {
-            return toMilliseconds(0,
-                                  match.captured(1).toInt(),
-                                  match.captured(2).toInt(),
-                                  match.captured(3).toInt());
+            apply(true);
         }
 
-        static const QRegularExpression secondsPattern(
-            QStringLiteral(R"((\d+)(?:[\.,](\d{1,3}))?\s*s?$)"),
-            QRegularExpression::CaseInsensitiveOption);
-        match = secondsPattern.match(trimmed);
-        if (match.hasMatch())
+    private:
+        void apply(bool forward)
         {
-            const qint64 seconds = match.captured(1).toLongLong();
-            QString fraction = match.captured(2);
-            int milliseconds = 0;
-            if (!fraction.isEmpty())
+            SRT_TRACE_SCOPE("TextEditCommand::apply");
+            table_->setUpdatesEnabled(false);
+            for (const TextTransform::Change &change : std::as_const(changes_))
             {
-                if (fraction.length() > 3)
+                QTableWidgetItem *textItem = table_->item(change.row, SubtitleTable::TextColumn);
+                if (textItem && textItem->text() == (forward ? change.before : change.after))
                 {
-                    fraction = fraction.left(3);
+                    textItem->setText(forward ? change.after : change.before);
                 }
-                while (fraction.length() < 3)
-                {
-                    fraction.append(QLatin1Char('0'));
-                }
-                milliseconds = fraction.toInt();
             }
-
-            return seconds * 1000 + milliseconds;
-        }
-
-        return -1;
-    }
-
-    QString millisecondsToSrt(qint64 msecs)
-    {
-        if (msecs < 0)
-        {
-            return {};
-        }
-
-        const int hours = static_cast<int>(msecs / (60 * 60 * 1000));
-        const int minutes = static_cast<int>((msecs / (60 * 1000)) % 60);
-        const int seconds = static_cast<int>((msecs / 1000) % 60);
-        const int milliseconds = static_cast<int>(msecs % 1000);
-
-        return QStringLiteral("%1:%2:%3,%4")
-            .arg(hours, 2, 10, QLatin1Char('0'))
-            .arg(minutes, 2, 10, QLatin1Char('0'))
-            .arg(seconds, 2, 10, QLatin1Char('0'))
-            .arg(milliseconds, 3, 10, QLatin1Char('0'));
-    }
-
-    QString computeDurationString(const QString &start, const QString &end)
-    {
-        const qint64 startMs = parseSrtTimestamp(start);
-        const qint64 endMs = parseSrtTimestamp(end);
-        if (startMs < 0 || endMs < 0)
-        {
-            return {};
-        }
-
-        qint64 diff = endMs - startMs;
-        if (diff < 0)
-        {
-            diff += kMillisecondsPerDay;
-        }
-        if (diff < 0)
-        {
-            return {};
-        }
-
-        return millisecondsToSrt(diff);
-    }
-
-    QString addDurationToTimestamp(const QString &start, const QString &duration)
-    {
-        const qint64 startMs = parseSrtTimestamp(start);
-        const qint64 durationMs = parseSrtTimestamp(duration);
-        if (startMs < 0 || durationMs < 0)
-        {
-            return {};
+            table_->setUpdatesEnabled(true);
         }
 
-        qint64 endMs = startMs + durationMs;
-        endMs %= kMillisecondsPerDay;
-        if (endMs < 0)
-        {
-            endMs += kMillisecondsPerDay;
-        }
-
-        return millisecondsToSrt(endMs);
-    }
-
-    QString normalizeDurationFromTts(const QString &rawDuration)
-    {
-        const qint64 durationMs = parseFlexibleDuration(rawDuration);
-        if (durationMs < 0)
-        {
-            return {};
-        }
-
-        return millisecondsToSrt(durationMs);
-    }
+        QTableWidget *table_;
+        QVector<TextTransform::Change> changes_;
+    };
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -173,18 +79,33 @@ MainWindow::MainWindow(QWidget *parent)
     resize(1280, 800);
     centerOnPrimaryScreen();
 
+    findPanel_ = new FindPanel(ui->subtitleTable, this);
+    ui->verticalLayout->addWidget(findPanel_);
+    findPanel_->hide();
+
+    QAction *undoAction = undoStack_.createUndoAction(this, tr("Undo"));
+    undoAction->setShortcut(QKeySequence::Undo);
+    QAction *redoAction = undoStack_.createRedoAction(this, tr("Redo"));
+    redoAction->setShortcut(QKeySequence::Redo);
+    ui->menuEdit->insertActions(ui->actionAdd_subtitle, {undoAction, redoAction});
+    ui->menuEdit->insertSeparator(ui->actionAdd_subtitle);
+
     connect(ui->actionNew, &QAction::triggered, this, &MainWindow::new_project);
     connect(ui->actionOpen, &QAction::triggered, this, &MainWindow::open_project);
     connect(ui->actionSave, &QAction::triggered, this, &MainWindow::save_project);
     connect(ui->actionSave_as, &QAction::triggered, this, &MainWindow::save_as_project);
     connect(ui->actionSettings, &QAction::triggered, this, &MainWindow::open_settings_window);
+    connect(ui->actionProvider_metrics, &QAction::triggered, this, &MainWindow::open_metrics_window);
     connect(ui->actionClose, &QAction::triggered, this, &MainWindow::close);
     connect(ui->actionAdd_subtitle, &QAction::triggered, this, &MainWindow::add_subtitle);
     connect(ui->actionRemove_subtitle, &QAction::triggered, this, &MainWindow::remove_subtitle);
+    connect(ui->actionFind, &QAction::triggered, findPanel_, &FindPanel::activate);
+    connect(ui->actionClean_up_text, &QAction::triggered, this, &MainWindow::open_text_transform_window);
     connect(ui->actionAuto_translate, &QAction::triggered, this, &MainWindow::open_translator_window);
     connect(ui->actionAuthor, &QAction::triggered, this, &MainWindow::open_portfolio_website);
     connect(ui->actionSoftware, &QAction::triggered, this, &MainWindow::show_software_info);
     connect(ui->actionText_to_Speech, &QAction::triggered, this, &MainWindow::open_text_to_speech_window);
+    connect(ui->actionDub, &QAction::triggered, this, &MainWindow::open_dubbing_window);
 
     init_settings();
     ui->statusbar->showMessage("Ready!");
@@ -220,6 +141,8 @@ void MainWindow::centerOnPrimaryScreen() noexcept
 
 void MainWindow::new_project()
 {
+    loadCancel_.cancel();
+    undoStack_.clear();
     ui->subtitleTable->clearContents();
     ui->subtitleTable->setRowCount(0);
     currentProjectPath_.clear();
@@ -242,17 +165,7 @@ void MainWindow::open_project()
         return;
     }
 
-    if (!load_project_from_file(filePath))
-    {
-        return;
-    }
-
-    const QFileInfo fileInfo(filePath);
-    currentProjectPath_ = fileInfo.absoluteFilePath();
-    setWindowTitle(QStringLiteral("%1 - %2").arg(baseWindowTitle_, fileInfo.fileName()));
-    ui->statusbar->showMessage(tr("Opened %1 (%2 subtitles)")
-                                   .arg(fileInfo.fileName())
-                                   .arg(ui->subtitleTable->rowCount()));
+    load_project_from_file(filePath);
 }
 
 void MainWindow::save_project()
@@ -263,13 +176,7 @@ void MainWindow::save_project()
         return;
     }
 
-    if (!save_project_to_file(currentProjectPath_))
-    {
-        return;
-    }
-
-    const QFileInfo fileInfo(currentProjectPath_);
-    ui->statusbar->showMessage(tr("Saved %1").arg(fileInfo.fileName()));
+    save_project_to_file(currentProjectPath_);
 }
 
 void MainWindow::save_as_project()
@@ -296,15 +203,7 @@ void MainWindow::save_as_project()
         normalizedPath += QStringLiteral(".srt");
     }
 
-    if (!save_project_to_file(normalizedPath))
-    {
-        return;
-    }
-
-    const QFileInfo fileInfo(normalizedPath);
-    currentProjectPath_ = fileInfo.absoluteFilePath();
-    setWindowTitle(QStringLiteral("%1 - %2").arg(baseWindowTitle_, fileInfo.fileName()));
-    ui->statusbar->showMessage(tr("Saved %1").arg(fileInfo.fileName()));
+    save_project_to_file(normalizedPath);
 }
 
 void MainWindow::open_settings_window()
@@ -313,115 +212,68 @@ void MainWindow::open_settings_window()
     settingsDialog.exec();
 }
 
-bool MainWindow::load_project_from_file(const QString &file_path)
+void MainWindow::open_metrics_window()
 {
-    QFile file(file_path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QMessageBox::warning(this,
-                             tr("Open Failed"),
-                             tr("Unable to open \"%1\"\n\n%2").arg(file_path, file.errorString()));
-        return false;
-    }
-
-    QTextStream stream(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    stream.setEncoding(QStringConverter::Utf8);
-#else
-    stream.setCodec("UTF-8");
-#endif
-
-    ui->subtitleTable->setRowCount(0);
-
-    QStringList block;
-    auto processBlock = [this](const QStringList &lines)
-    {
-        if (lines.size() < 2)
-        {
-            return;
-        }
-
-        QStringList payload = lines;
-        payload.removeFirst(); // subtitle index
-
-        if (payload.isEmpty())
-        {
-            return;
-        }
-
-        const QString timingLine = payload.takeFirst();
-        static const QRegularExpression timingPattern(
-            QStringLiteral(R"((\d{2}:\d{2}:\d{2},\d{3})\s*-->\s*(\d{2}:\d{2}:\d{2},\d{3}))"));
-        const QRegularExpressionMatch match = timingPattern.match(timingLine);
-        if (!match.hasMatch())
-        {
-            return;
-        }
-
-        const QString start = match.captured(1);
-        const QString end = match.captured(2);
-        const QString text = payload.join(QStringLiteral("\n"));
-
-        const QString duration = computeDurationString(start, end);
-
-        const int row = ui->subtitleTable->rowCount();
-        ui->subtitleTable->insertRow(row);
-        ui->subtitleTable->setItem(row, 0, new QTableWidgetItem(start));
-        ui->subtitleTable->setItem(row, 1, new QTableWidgetItem(end));
-        ui->subtitleTable->setItem(row, 2, new QTableWidgetItem(duration));
-        ui->subtitleTable->setItem(row, 3, new QTableWidgetItem(text));
-    };
+    MetricsWindow metricsDialog(this);
+    metricsDialog.exec();
+}
 
-    while (!stream.atEnd())
-    {
-        QString line = stream.readLine();
-        if (line.endsWith(QLatin1Char('\r')))
-        {
-            line.chop(1);
-        }
-        if (line.trimmed().isEmpty())
-        {
-            if (!block.isEmpty())
+void MainWindow::load_project_from_file(const QString &file_path)
+{
+    SRT_TRACE_SCOPE("MainWindow::load_project_from_file");
+    // A newer open supersedes one still being read.
+    loadCancel_.cancel();
+    loadCancel_ = CancellationToken();
+    const CancellationToken token = loadCancel_;
+    const QPointer<MainWindow> self(this);
+
+    const QFileInfo fileInfo(file_path);
+    ui->statusbar->showMessage(tr("Opening %1...").arg(fileInfo.fileName()));
+
+    Executor::instance().submit([self, file_path, token]() {
+        SRT_TRACE_SCOPE("MainWindow::load_project_from_file/read");
+        auto cues = std::make_shared<QVector<SrtCue>>();
+        QString errorMessage;
+        const bool ok = SrtDocument::read_file(file_path, cues.get(), &errorMessage);
+
+        postToGui(self, [self, file_path, token, ok, errorMessage, cues]() {
+            if (token.is_cancelled())
             {
-                processBlock(block);
-                block.clear();
+                return;
+            }
+            if (!ok)
+            {
+                QMessageBox::warning(self,
+                                     tr("Open Failed"),
+                                     tr("Unable to open \"%1\"\n\n%2").arg(file_path, errorMessage));
+                return;
             }
-        }
-        else
-        {
-            block << line;
-        }
-    }
 
-    if (!block.isEmpty())
-    {
-        processBlock(block);
-    }
+            self->populate_table(*cues);
 
-    return true;
+            const QFileInfo loadedInfo(file_path);
+            self->currentProjectPath_ = loadedInfo.absoluteFilePath();
+            self->setWindowTitle(QStringLiteral("%1 - %2").arg(self->baseWindowTitle_, loadedInfo.fileName()));
+            self->ui->statusbar->showMessage(tr("Opened %1 (%2 subtitles)")
+                                                 .arg(loadedInfo.fileName())
+                                                 .arg(self->ui->subtitleTable->rowCount()));
+        });
+    }, Executor::Priority::High, token);
 }
 
-bool MainWindow::save_project_to_file(const QString &file_path)
+void MainWindow::populate_table(const QVector<SrtCue> &cues)
 {
-    QFile file(file_path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
-    {
-        QMessageBox::warning(this,
-                             tr("Save Failed"),
-                             tr("Unable to write \"%1\"\n\n%2").arg(file_path, file.errorString()));
-        return false;
-    }
-
-    QTextStream stream(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    stream.setEncoding(QStringConverter::Utf8);
-#else
-    stream.setCodec("UTF-8");
-#endif
-    stream.setGenerateByteOrderMark(false);
+    undoStack_.clear();
+    SubtitleTable::populate(ui->subtitleTable, cues);
+}
 
+void MainWindow::save_project_to_file(const QString &file_path)
+{
+    SRT_TRACE_SCOPE("MainWindow::save_project_to_file");
+    // The table is snapshotted here; encoding and disk I/O run on the pool.
+    QVector<SrtCue> cues;
     const int rowCount = ui->subtitleTable->rowCount();
-    int subtitleIndex = 1;
+    cues.reserve(rowCount);
     for (int row = 0; row < rowCount; ++row)
     {
         const QString start = ui->subtitleTable->item(row, 0) ? ui->subtitleTable->item(row, 0)->text() : QString();
@@ -433,7 +285,7 @@ bool MainWindow::save_project_to_file(const QString &file_path)
             continue;
         }
 
-        const QString duration = computeDurationString(start, end);
+        const QString duration = SrtTiming::compute_duration_string(start, end);
         if (!duration.isEmpty())
         {
             QTableWidgetItem *durationItem = ui->subtitleTable->item(row, 2);
@@ -445,21 +297,30 @@ bool MainWindow::save_project_to_file(const QString &file_path)
             durationItem->setText(duration);
         }
 
-        if (subtitleIndex > 1)
-        {
-            stream << "\r\n";
-        }
-
-        stream << subtitleIndex++ << "\r\n";
-        stream << start << " --> " << end << "\r\n";
-        const QStringList textLines = text.split(QLatin1Char('\n'));
-        for (const QString &textLine : textLines)
-        {
-            stream << textLine << "\r\n";
-        }
+        cues.push_back(SrtCue{start, end, text});
     }
 
-    return true;
+    const QPointer<MainWindow> self(this);
+    Executor::instance().submit([self, file_path, cues]() {
+        SRT_TRACE_SCOPE("MainWindow::save_project_to_file/write");
+        QString errorMessage;
+        const bool ok = SrtDocument::write_file(file_path, cues, &errorMessage);
+
+        postToGui(self, [self, file_path, ok, errorMessage]() {
+            if (!ok)
+            {
+                QMessageBox::warning(self,
+                                     tr("Save Failed"),
+                                     tr("Unable to write \"%1\"\n\n%2").arg(file_path, errorMessage));
+                return;
+            }
+
+            const QFileInfo fileInfo(file_path);
+            self->currentProjectPath_ = fileInfo.absoluteFilePath();
+            self->setWindowTitle(QStringLiteral("%1 - %2").arg(self->baseWindowTitle_, fileInfo.fileName()));
+            self->ui->statusbar->showMessage(tr("Saved %1").arg(fileInfo.fileName()));
+        });
+    }, Executor::Priority::High);
 }
 
 void MainWindow::add_subtitle()
@@ -473,10 +334,15 @@ void MainWindow::remove_subtitle()
     QModelIndexList selected = ui->subtitleTable->selectionModel()->selectedRows();
     for (const QModelIndex &index : selected)
     {
-        qDebug() << "Selected row:" << index.row();
+        SRT_LOG_DEBUG("editor", "remove subtitle row {}", index.row() + 1);
         ui->statusbar->showMessage(QString("Remove subtitle %1").arg(index.row() + 1));
         ui->subtitleTable->removeRow(index.row());
     }
+    // Undo steps address rows by index, which no longer line up.
+    if (!selected.isEmpty())
+    {
+        undoStack_.clear();
+    }
 }
 
 void MainWindow::open_translator_window()
@@ -514,10 +380,35 @@ void MainWindow::open_translator_window()
                 ui->subtitleTable->setItem(row, 3, textItem);
             }
             textItem->setText(translated);
+            textItem->setData(kClipPathRole, QVariant());
         }
     }
 }
 
+void MainWindow::open_text_transform_window()
+{
+    QStringList texts;
+    const int rowCount = ui->subtitleTable->rowCount();
+    texts.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row)
+    {
+        const QTableWidgetItem *textItem = ui->subtitleTable->item(row, SubtitleTable::TextColumn);
+        texts.append(textItem ? textItem->text() : QString());
+    }
+
+    TextTransformWindow dialog(this);
+    dialog.set_texts(texts);
+    if (dialog.exec() != QDialog::Accepted)
+    {
+        return;
+    }
+
+    const QVector<TextTransform::Change> changes = dialog.changes();
+    // Pushing runs redo(), which applies the changes.
+    undoStack_.push(new TextEditCommand(ui->subtitleTable, changes, tr("Clean up %n subtitle(s)", "", static_cast<int>(changes.size()))));
+    ui->statusbar->showMessage(tr("Cleaned up %n subtitle(s).", "", static_cast<int>(changes.size())));
+}
+
 void MainWindow::open_portfolio_website()
 {
     QDesktopServices::openUrl(QUrl(QStringLiteral("https://truonghaidang.com")));
@@ -554,9 +445,8 @@ void MainWindow::show_software_info()
     about.exec();
 }
 
-void MainWindow::open_text_to_speech_window()
+QVector<TextToSpeechWindow::Entry> MainWindow::text_to_speech_entries() const
 {
-    TextToSpeechWindow text_to_speech_window(this);
     QVector<TextToSpeechWindow::Entry> entries;
     const int rowCount = ui->subtitleTable->rowCount();
     entries.reserve(rowCount);
@@ -568,6 +458,21 @@ void MainWindow::open_text_to_speech_window()
         if (QTableWidgetItem *textItem = ui->subtitleTable->item(row, 3))
         {
             entry.text = textItem->text();
+            entry.filePath = textItem->data(kClipPathRole).toString();
+        }
+
+        if (QTableWidgetItem *startItem = ui->subtitleTable->item(row, 0))
+        {
+            entry.startMs = SrtTiming::parse_srt_timestamp(startItem->text());
+        }
+
+        if (QTableWidgetItem *endItem = ui->subtitleTable->item(row, 1))
+        {
+            const qint64 endMs = SrtTiming::parse_srt_timestamp(endItem->text());
+            if (entry.startMs >= 0 && endMs > entry.startMs)
+            {
+                entry.slotMs = endMs - entry.startMs;
+            }
         }
 
         if (QTableWidgetItem *durationItem = ui->subtitleTable->item(row, 2))
@@ -578,46 +483,127 @@ void MainWindow::open_text_to_speech_window()
         entries.push_back(entry);
     }
 
+    return entries;
+}
+
+void MainWindow::apply_text_to_speech_entry(int row, const TextToSpeechWindow::Entry &entry)
+{
+    if (row < 0 || row >= ui->subtitleTable->rowCount())
+    {
+        return;
+    }
+
+    const QString clipPath = entry.filePath;
+    QTableWidgetItem *clipItem = ui->subtitleTable->item(row, 3);
+    if (clipItem && !clipPath.isEmpty())
+    {
+        clipItem->setData(kClipPathRole, clipPath);
+    }
+
+    const QString normalizedDuration = SrtTiming::normalize_duration_from_tts(entry.duration);
+    if (normalizedDuration.isEmpty())
+    {
+        return;
+    }
+
+    QTableWidgetItem *durationItem = ui->subtitleTable->item(row, 2);
+    if (!durationItem)
+    {
+        durationItem = new QTableWidgetItem();
+        ui->subtitleTable->setItem(row, 2, durationItem);
+    }
+    durationItem->setText(normalizedDuration);
+
+    QTableWidgetItem *startItem = ui->subtitleTable->item(row, 0);
+    if (!startItem)
+    {
+        return;
+    }
+
+    const QString newEnd = SrtTiming::add_duration_to_timestamp(startItem->text(), normalizedDuration);
+    if (newEnd.isEmpty())
+    {
+        return;
+    }
+
+    QTableWidgetItem *endItem = ui->subtitleTable->item(row, 1);
+    if (!endItem)
+    {
+        endItem = new QTableWidgetItem();
+        ui->subtitleTable->setItem(row, 1, endItem);
+    }
+    endItem->setText(newEnd);
+}
+
+void MainWindow::open_text_to_speech_window()
+{
+    TextToSpeechWindow text_to_speech_window(this);
+    const QVector<TextToSpeechWindow::Entry> entries = text_to_speech_entries();
     text_to_speech_window.set_entries(entries);
     text_to_speech_window.exec();
 
     const QVector<TextToSpeechWindow::Entry> updatedEntries = text_to_speech_window.entries();
-    const int rowsToUpdate = std::min(rowCount, static_cast<int>(updatedEntries.size()));
-
+    const int rowsToUpdate = std::min(static_cast<int>(entries.size()), static_cast<int>(updatedEntries.size()));
     for (int row = 0; row < rowsToUpdate; ++row)
     {
-        const QString normalizedDuration = normalizeDurationFromTts(updatedEntries.at(row).duration);
-        if (normalizedDuration.isEmpty())
-        {
-            continue;
-        }
+        apply_text_to_speech_entry(row, updatedEntries.at(row));
+    }
+}
 
-        QTableWidgetItem *durationItem = ui->subtitleTable->item(row, 2);
-        if (!durationItem)
-        {
-            durationItem = new QTableWidgetItem();
-            ui->subtitleTable->setItem(row, 2, durationItem);
-        }
-        durationItem->setText(normalizedDuration);
+void MainWindow::open_dubbing_window()
+{
+    const QString provider = settings.value("ai/lang/provider").toString().trimmed();
+    const QString apiToken = settings.value("ai/lang/apiKey").toString().trimmed();
+    if (provider.isEmpty() || apiToken.isEmpty())
+    {
+        QMessageBox::warning(this, tr("Missing API key"), tr("Please configure a translation provider and API key before dubbing."));
+        return;
+    }
 
-        QTableWidgetItem *startItem = ui->subtitleTable->item(row, 0);
-        if (!startItem)
+    const QString targetLanguageKey = QStringLiteral("ai/lang/dub_target_language");
+    bool accepted = false;
+    const QString targetLanguage = QInputDialog::getText(this,
+                                                         tr("Dub"),
+                                                         tr("Translate every row into:"),
+                                                         QLineEdit::Normal,
+                                                         settings.value(targetLanguageKey).toString(),
+                                                         &accepted)
+                                       .trimmed();
+    if (!accepted || targetLanguage.isEmpty())
+    {
+        return;
+    }
+    settings.setValue(targetLanguageKey, targetLanguage);
+
+    TextToSpeechWindow::Translation translation;
+    translation.provider = provider;
+    translation.token = apiToken;
+    translation.sourceLanguage = "auto";
+    translation.targetLanguage = targetLanguage.toStdString();
+
+    TextToSpeechWindow dubbing_window(this);
+    const QVector<TextToSpeechWindow::Entry> entries = text_to_speech_entries();
+    dubbing_window.set_entries(entries);
+    dubbing_window.set_translation(translation);
+
+    // Rows are written back as each stage lands rather than on close, so the
+    // table already shows the new text and timings while the rest are still
+    // being translated or spoken.
+    connect(&dubbing_window, &TextToSpeechWindow::row_translated, this, [this, &dubbing_window](int row, bool succeeded) {
+        QTableWidgetItem *textItem = ui->subtitleTable->item(row, 3);
+        if (!succeeded || !textItem)
         {
-            continue;
+            return;
         }
-
-        const QString newEnd = addDurationToTimestamp(startItem->text(), normalizedDuration);
-        if (newEnd.isEmpty())
+        textItem->setText(dubbing_window.entry(row).text);
+        textItem->setData(kClipPathRole, QVariant());
+    });
+    connect(&dubbing_window, &TextToSpeechWindow::conversion_finished, this, [this, &dubbing_window](int row, bool succeeded) {
+        if (succeeded)
         {
-            continue;
+            apply_text_to_speech_entry(row, dubbing_window.entry(row));
         }
+    });
 
-        QTableWidgetItem *endItem = ui->subtitleTable->item(row, 1);
-        if (!endItem)
-        {
-            endItem = new QTableWidgetItem();
-            ui->subtitleTable->setItem(row, 1, endItem);
-        }
-        endItem->setText(newEnd);
-    }
+    dubbing_window.exec();
 }
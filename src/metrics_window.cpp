@@ -0,0 +1,112 @@
+#include "metrics_window.h"
+
+#include "provider_metrics.h"
+
+#include <QDir>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLocale>
+#include <QMessageBox>
+#include <QTableWidgetItem>
+
+namespace
+{
+constexpr int kRefreshIntervalMs = 1000;
+
+QString formatLatency(std::int64_t micros)
+{
+    if (micros < 1000)
+    {
+        return QStringLiteral("%1 us").arg(micros);
+    }
+    if (micros < 1000000)
+    {
+        return QStringLiteral("%1 ms").arg(static_cast<double>(micros) / 1e3, 0, 'f', 1);
+    }
+    return QStringLiteral("%1 s").arg(static_cast<double>(micros) / 1e6, 0, 'f', 2);
+}
+
+QTableWidgetItem *textCell(const QString &text)
+{
+    return new QTableWidgetItem(text);
+}
+
+QTableWidgetItem *numberCell(const QString &text)
+{
+    auto *item = new QTableWidgetItem(text);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+} // namespace
+
+MetricsWindow::MetricsWindow(QWidget *parent)
+    : QDialog(parent), ui(std::make_unique<Ui::MetricsWindow>())
+{
+    ui->setupUi(this);
+    ui->metricsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    ui->metricsTable->verticalHeader()->setVisible(false);
+
+    connect(ui->btnReset, &QPushButton::clicked, this, &MetricsWindow::reset_metrics);
+    connect(ui->btnExport, &QPushButton::clicked, this, &MetricsWindow::export_metrics);
+    connect(ui->btnClose, &QPushButton::clicked, this, &QDialog::accept);
+    connect(&refreshTimer, &QTimer::timeout, this, &MetricsWindow::refresh_table);
+
+    refresh_table();
+    refreshTimer.start(kRefreshIntervalMs);
+}
+
+MetricsWindow::~MetricsWindow() = default;
+
+void MetricsWindow::refresh_table()
+{
+    const QVector<ProviderMetrics::SeriesSnapshot> series = ProviderMetrics::instance().snapshot();
+    const QLocale locale;
+
+    ui->metricsTable->setRowCount(static_cast<int>(series.size()));
+    for (int row = 0; row < static_cast<int>(series.size()); ++row)
+    {
+        const ProviderMetrics::SeriesSnapshot &snap = series.at(row);
+        int column = 0;
+        ui->metricsTable->setItem(row, column++, textCell(snap.labels.provider));
+        ui->metricsTable->setItem(row, column++, textCell(snap.labels.endpoint));
+        ui->metricsTable->setItem(row, column++, textCell(snap.labels.key));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.toString(static_cast<qulonglong>(snap.requests))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.toString(static_cast<qulonglong>(snap.failures))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.toString(static_cast<qulonglong>(snap.throttled))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.toString(static_cast<qulonglong>(snap.retries))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.formattedDataSize(static_cast<qint64>(snap.bytesSent))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.formattedDataSize(static_cast<qint64>(snap.bytesReceived))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.toString(static_cast<qulonglong>(snap.promptTokens))));
+        ui->metricsTable->setItem(row, column++, numberCell(locale.toString(static_cast<qulonglong>(snap.completionTokens))));
+        ui->metricsTable->setItem(row, column++, numberCell(formatLatency(snap.p50Us)));
+        ui->metricsTable->setItem(row, column++, numberCell(formatLatency(snap.p90Us)));
+        ui->metricsTable->setItem(row, column++, numberCell(formatLatency(snap.p99Us)));
+        ui->metricsTable->setItem(row, column++, numberCell(formatLatency(snap.maxUs)));
+    }
+}
+
+void MetricsWindow::reset_metrics()
+{
+    ProviderMetrics::instance().reset();
+    refresh_table();
+}
+
+void MetricsWindow::export_metrics()
+{
+    const QString filePath = QFileDialog::getSaveFileName(this,
+                                                          tr("Export Metrics"),
+                                                          QDir::homePath() + QDir::separator() + QStringLiteral("srt_editor.prom"),
+                                                          tr("Prometheus Text (*.prom);;All Files (*.*)"));
+    if (filePath.isEmpty())
+    {
+        return;
+    }
+
+    QString errorMessage;
+    if (!ProviderMetrics::instance().write_prometheus_file(filePath, &errorMessage))
+    {
+        QMessageBox::warning(this,
+                             tr("Export failed"),
+                             tr("Unable to write metrics to %1: %2").arg(filePath, errorMessage));
+    }
+}
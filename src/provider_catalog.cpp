@@ -0,0 +1,163 @@
+#include "provider_catalog.h"
+
+#include "executor.h"
+#include "settings.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+constexpr int kFileVersion = 1;
+constexpr qint64 kDefaultTtlHours = 24;
+} // namespace
+
+ProviderCatalog &ProviderCatalog::instance()
+{
+    static ProviderCatalog catalog = []() {
+        Settings settings;
+        const qint64 ttlHours = settings.value(QStringLiteral("catalog/ttl_hours"), kDefaultTtlHours).toLongLong();
+        const QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        return ProviderCatalog(QDir(root).filePath(QStringLiteral("provider_catalog.json")),
+                               std::max<qint64>(ttlHours, 0) * 3600);
+    }();
+    return catalog;
+}
+
+QString ProviderCatalog::make_key(const QString &provider, const QString &kind, const QString &token)
+{
+    const QByteArray account = QCryptographicHash::hash(token.trimmed().toUtf8(), QCryptographicHash::Sha256).toHex().left(12);
+    return provider.toLower() + QLatin1Char('/') + kind + QLatin1Char('/') + QString::fromLatin1(account);
+}
+
+ProviderCatalog::ProviderCatalog(const QString &filePath, qint64 ttlSeconds)
+    : filePath_(filePath), ttlSeconds_(ttlSeconds)
+{
+    load();
+}
+
+ProviderCatalog::~ProviderCatalog() = default;
+
+QStringList ProviderCatalog::cached(const QString &key) const
+{
+    const auto it = entries_.constFind(key);
+    return it == entries_.constEnd() ? QStringList() : it->items;
+}
+
+bool ProviderCatalog::is_fresh(const QString &key) const
+{
+    const auto it = entries_.constFind(key);
+    if (it == entries_.constEnd())
+    {
+        return false;
+    }
+    const qint64 age = QDateTime::currentSecsSinceEpoch() - it->fetchedAt;
+    return age >= 0 && age < ttlSeconds_;
+}
+
+void ProviderCatalog::refresh(const QString &key, Fetcher fetcher, bool force)
+{
+    if ((!force && is_fresh(key)) || inFlight_.contains(key))
+    {
+        return;
+    }
+
+    inFlight_.insert(key);
+    const QPointer<ProviderCatalog> self(this);
+    Executor::io().submit([self, key, fetcher = std::move(fetcher)]() {
+        const QStringList items = fetcher ? fetcher() : QStringList();
+        postToGui(self, [self, key, items]() {
+            self->inFlight_.remove(key);
+            if (items.isEmpty())
+            {
+                return;
+            }
+
+            const bool changed = self->cached(key) != items;
+            self->store(key, items);
+            if (changed)
+            {
+                emit self->updated(key, items);
+            }
+        });
+    }, Executor::Priority::Low);
+}
+
+void ProviderCatalog::store(const QString &key, const QStringList &items)
+{
+    Entry &entry = entries_[key];
+    entry.items = items;
+    entry.fetchedAt = QDateTime::currentSecsSinceEpoch();
+    save();
+}
+
+void ProviderCatalog::load()
+{
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != kFileVersion)
+    {
+        return;
+    }
+
+    const QJsonObject entries = root.value(QStringLiteral("entries")).toObject();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    {
+        const QJsonObject obj = it.value().toObject();
+        Entry entry;
+        for (const QJsonValue &item : obj.value(QStringLiteral("items")).toArray())
+        {
+            entry.items.append(item.toString());
+        }
+        entry.fetchedAt = static_cast<qint64>(obj.value(QStringLiteral("fetched_at")).toDouble());
+        if (!entry.items.isEmpty())
+        {
+            entries_.insert(it.key(), entry);
+        }
+    }
+}
+
+void ProviderCatalog::save() const
+{
+    if (filePath_.isEmpty())
+    {
+        return;
+    }
+
+    QJsonObject entries;
+    for (auto it = entries_.cbegin(); it != entries_.cend(); ++it)
+    {
+        entries.insert(it.key(),
+                       QJsonObject{{QStringLiteral("items"), QJsonArray::fromStringList(it->items)},
+                                   {QStringLiteral("fetched_at"), static_cast<double>(it->fetchedAt)}});
+    }
+
+    const QJsonObject root{{QStringLiteral("version"), kFileVersion},
+                           {QStringLiteral("entries"), entries}};
+
+    QDir().mkpath(QFileInfo(filePath_).absolutePath());
+    QSaveFile file(filePath_);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
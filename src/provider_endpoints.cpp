@@ -0,0 +1,45 @@
+#include "provider_endpoints.h"
+
+#include "settings.h"
+
+QString ProviderEndpoints::default_base_url(const QString &provider)
+{
+    if (provider == QLatin1String("openai"))
+    {
+        return QStringLiteral("https://api.openai.com/v1");
+    }
+    if (provider == QLatin1String("github"))
+    {
+        return QStringLiteral("https://models.github.ai");
+    }
+    if (provider == QLatin1String("elevenlabs"))
+    {
+        return QStringLiteral("https://api.elevenlabs.io/v1");
+    }
+    return {};
+}
+
+QString ProviderEndpoints::base_url(const QString &provider)
+{
+    Settings settings;
+    QString base = settings.value(QStringLiteral("endpoints/") + provider).toString().trimmed();
+    if (base.isEmpty())
+    {
+        base = default_base_url(provider);
+    }
+    while (base.endsWith(QLatin1Char('/')))
+    {
+        base.chop(1);
+    }
+    return base;
+}
+
+QByteArray ProviderEndpoints::url(const QString &provider, const QString &path)
+{
+    QString relative = path;
+    while (relative.startsWith(QLatin1Char('/')))
+    {
+        relative.remove(0, 1);
+    }
+    return (base_url(provider) + QLatin1Char('/') + relative).toUtf8();
+}
@@ -0,0 +1,324 @@
+#include "provider_metrics.h"
+
+#include <QCryptographicHash>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace
+{
+constexpr int kSubBucketCount = 1 << LatencyHistogram::kSubBucketBits;
+
+int highestBit(std::uint64_t value)
+{
+    int bit = 0;
+    for (int step = 32; step > 0; step /= 2)
+    {
+        if (value >> (bit + step))
+        {
+            bit += step;
+        }
+    }
+    return bit;
+}
+
+QString seriesId(const MetricLabels &labels)
+{
+    return labels.provider + QLatin1Char('\n') + labels.endpoint + QLatin1Char('\n') + labels.key;
+}
+
+QByteArray escapeLabel(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return escaped;
+}
+
+QByteArray labelSet(const MetricLabels &labels, const QByteArray &extra = {})
+{
+    QByteArray out = "{provider=\"" + escapeLabel(labels.provider) +
+                     "\",endpoint=\"" + escapeLabel(labels.endpoint) +
+                     "\",key=\"" + escapeLabel(labels.key) + '"';
+    if (!extra.isEmpty())
+    {
+        out += ',' + extra;
+    }
+    out += '}';
+    return out;
+}
+
+QByteArray seconds(std::int64_t micros)
+{
+    return QByteArray::number(static_cast<double>(micros) / 1e6, 'g', 9);
+}
+} // namespace
+
+void LatencyHistogram::record(std::int64_t micros)
+{
+    micros = std::max<std::int64_t>(micros, 0);
+    buckets_[static_cast<size_t>(bucket_index(micros))].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+
+    std::int64_t previous = max_.load(std::memory_order_relaxed);
+    while (micros > previous && !max_.compare_exchange_weak(previous, micros, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : buckets_)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+    return count_.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::sum() const
+{
+    return sum_.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::max() const
+{
+    return max_.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::value_at_percentile(double percentile) const
+{
+    // Recorders may run concurrently, so walk a copy and use its own total.
+    std::array<std::uint64_t, kBucketCount> copy{};
+    std::uint64_t total = 0;
+    for (int i = 0; i < kBucketCount; ++i)
+    {
+        copy[static_cast<size_t>(i)] = buckets_[static_cast<size_t>(i)].load(std::memory_order_relaxed);
+        total += copy[static_cast<size_t>(i)];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i)
+    {
+        seen += copy[static_cast<size_t>(i)];
+        if (seen >= target)
+        {
+            return std::min(bucket_upper_bound(i), max());
+        }
+    }
+    return max();
+}
+
+int LatencyHistogram::bucket_index(std::int64_t micros)
+{
+    if (micros < 2 * kSubBucketCount)
+    {
+        return static_cast<int>(std::max<std::int64_t>(micros, 0));
+    }
+
+    // Keep the top kSubBucketBits + 1 bits: the mantissa lies in
+    // [kSubBucketCount, 2 * kSubBucketCount) and the shift picks the octave.
+    const int shift = highestBit(static_cast<std::uint64_t>(micros)) - kSubBucketBits;
+    const int mantissa = static_cast<int>(micros >> shift);
+    return std::min(kSubBucketCount * shift + mantissa, kBucketCount - 1);
+}
+
+std::int64_t LatencyHistogram::bucket_upper_bound(int index)
+{
+    if (index < 2 * kSubBucketCount)
+    {
+        return index;
+    }
+
+    const int shift = index / kSubBucketCount - 1;
+    const std::int64_t mantissa = index - kSubBucketCount * shift;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+ProviderMetrics &ProviderMetrics::instance()
+{
+    static ProviderMetrics metrics;
+    return metrics;
+}
+
+MetricLabels ProviderMetrics::labels(const QString &provider, const QString &endpoint, const QString &token)
+{
+    const QString trimmed = token.trimmed();
+    const QString key = trimmed.isEmpty()
+                            ? QStringLiteral("none")
+                            : QString::fromLatin1(QCryptographicHash::hash(trimmed.toUtf8(), QCryptographicHash::Sha256).toHex().left(8));
+    return MetricLabels{provider.toLower(), endpoint, key};
+}
+
+std::shared_ptr<ProviderMetrics::Series> ProviderMetrics::series(const MetricLabels &labels)
+{
+    const QString id = seriesId(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_ptr<Series> &entry = series_[id];
+    if (!entry)
+    {
+        entry = std::make_shared<Series>();
+        labels_.insert(id, labels);
+    }
+    return entry;
+}
+
+void ProviderMetrics::record_curl(const MetricLabels &labels, CURL *curl, CURLcode code)
+{
+    long httpStatus = 0;
+    curl_off_t totalMicros = 0;
+    curl_off_t uploaded = 0;
+    curl_off_t downloaded = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &totalMicros);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+
+    const std::shared_ptr<Series> target = series(labels);
+    target->requests.fetch_add(1, std::memory_order_relaxed);
+    target->bytesSent.fetch_add(static_cast<std::uint64_t>(std::max<curl_off_t>(uploaded, 0)), std::memory_order_relaxed);
+    target->bytesReceived.fetch_add(static_cast<std::uint64_t>(std::max<curl_off_t>(downloaded, 0)), std::memory_order_relaxed);
+    if (httpStatus == 429)
+    {
+        target->throttled.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (code != CURLE_OK || httpStatus >= 400)
+    {
+        target->failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    target->latency.record(static_cast<std::int64_t>(totalMicros));
+}
+
+void ProviderMetrics::add_tokens(const MetricLabels &labels, std::uint64_t prompt, std::uint64_t completion)
+{
+    const std::shared_ptr<Series> target = series(labels);
+    target->promptTokens.fetch_add(prompt, std::memory_order_relaxed);
+    target->completionTokens.fetch_add(completion, std::memory_order_relaxed);
+}
+
+void ProviderMetrics::add_retry(const MetricLabels &labels)
+{
+    series(labels)->retries.fetch_add(1, std::memory_order_relaxed);
+}
+
+QVector<ProviderMetrics::SeriesSnapshot> ProviderMetrics::snapshot() const
+{
+    QVector<QPair<MetricLabels, std::shared_ptr<Series>>> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = series_.constBegin(); it != series_.constEnd(); ++it)
+        {
+            entries.append(qMakePair(labels_.value(it.key()), it.value()));
+        }
+    }
+
+    QVector<SeriesSnapshot> result;
+    result.reserve(entries.size());
+    for (const auto &entry : entries)
+    {
+        const Series &source = *entry.second;
+        SeriesSnapshot snap;
+        snap.labels = entry.first;
+        snap.requests = source.requests.load(std::memory_order_relaxed);
+        snap.failures = source.failures.load(std::memory_order_relaxed);
+        snap.throttled = source.throttled.load(std::memory_order_relaxed);
+        snap.retries = source.retries.load(std::memory_order_relaxed);
+        snap.bytesSent = source.bytesSent.load(std::memory_order_relaxed);
+        snap.bytesReceived = source.bytesReceived.load(std::memory_order_relaxed);
+        snap.promptTokens = source.promptTokens.load(std::memory_order_relaxed);
+        snap.completionTokens = source.completionTokens.load(std::memory_order_relaxed);
+        snap.p50Us = source.latency.value_at_percentile(50.0);
+        snap.p90Us = source.latency.value_at_percentile(90.0);
+        snap.p99Us = source.latency.value_at_percentile(99.0);
+        snap.maxUs = source.latency.max();
+        snap.sumUs = source.latency.sum();
+        result.append(snap);
+    }
+
+    std::sort(result.begin(), result.end(), [](const SeriesSnapshot &a, const SeriesSnapshot &b) {
+        return std::tie(a.labels.provider, a.labels.endpoint, a.labels.key) <
+               std::tie(b.labels.provider, b.labels.endpoint, b.labels.key);
+    });
+    return result;
+}
+
+void ProviderMetrics::reset()
+{
+    // Recorders keep their shared_ptr, so a request finishing during the
+    // reset lands in a detached series and is simply dropped.
+    std::lock_guard<std::mutex> lock(mutex_);
+    series_.clear();
+    labels_.clear();
+}
+
+QByteArray ProviderMetrics::to_prometheus() const
+{
+    const QVector<SeriesSnapshot> all = snapshot();
+    QByteArray out;
+
+    auto counter = [&](const char *name, const char *help, std::uint64_t SeriesSnapshot::*field) {
+        out += QByteArray("# HELP srt_editor_provider_") + name + ' ' + help + '\n';
+        out += QByteArray("# TYPE srt_editor_provider_") + name + " counter\n";
+        for (const SeriesSnapshot &snap : all)
+        {
+            out += QByteArray("srt_editor_provider_") + name + labelSet(snap.labels) + ' ' +
+                   QByteArray::number(static_cast<qulonglong>(snap.*field)) + '\n';
+        }
+    };
+
+    counter("requests_total", "HTTP requests sent to the provider.", &SeriesSnapshot::requests);
+    counter("failures_total", "Requests that failed at the transport or returned HTTP >= 400.", &SeriesSnapshot::failures);
+    counter("throttled_total", "Requests rejected with HTTP 429.", &SeriesSnapshot::throttled);
+    counter("retries_total", "Requests re-sent after a failure.", &SeriesSnapshot::retries);
+    counter("sent_bytes_total", "Request body bytes uploaded.", &SeriesSnapshot::bytesSent);
+    counter("received_bytes_total", "Response body bytes downloaded.", &SeriesSnapshot::bytesReceived);
+    counter("prompt_tokens_total", "Prompt tokens reported by the provider.", &SeriesSnapshot::promptTokens);
+    counter("completion_tokens_total", "Completion tokens reported by the provider.", &SeriesSnapshot::completionTokens);
+
+    out += "# HELP srt_editor_provider_request_duration_seconds End-to-end request latency.\n";
+    out += "# TYPE srt_editor_provider_request_duration_seconds summary\n";
+    for (const SeriesSnapshot &snap : all)
+    {
+        const QByteArray name = "srt_editor_provider_request_duration_seconds";
+        out += name + labelSet(snap.labels, "quantile=\"0.5\"") + ' ' + seconds(snap.p50Us) + '\n';
+        out += name + labelSet(snap.labels, "quantile=\"0.9\"") + ' ' + seconds(snap.p90Us) + '\n';
+        out += name + labelSet(snap.labels, "quantile=\"0.99\"") + ' ' + seconds(snap.p99Us) + '\n';
+        out += name + "_sum" + labelSet(snap.labels) + ' ' + seconds(snap.sumUs) + '\n';
+        out += name + "_count" + labelSet(snap.labels) + ' ' + QByteArray::number(static_cast<qulonglong>(snap.requests)) + '\n';
+    }
+
+    return out;
+}
+
+bool ProviderMetrics::write_prometheus_file(const QString &path, QString *errorMessage) const
+{
+    // QSaveFile renames into place, so a scraper never reads a partial file.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(to_prometheus()) < 0 ||
+        !file.commit())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
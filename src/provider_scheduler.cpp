@@ -0,0 +1,219 @@
+#include "provider_scheduler.h"
+
+#include "logger.h"
+#include "settings.h"
+#include "trace.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr int kInitialBackoffMs = 1000;
+constexpr int kMaxBackoffMs = 30000;
+
+ProviderScheduler::Limits limitsFromSettings(const QString &provider)
+{
+    Settings settings;
+    ProviderScheduler::Limits limits;
+    limits.requestsPerMinute = std::max(0.0, settings.value(QStringLiteral("limits/%1/requests_per_minute").arg(provider), 0.0).toDouble());
+    limits.maxConcurrent = std::max(0, settings.value(QStringLiteral("limits/%1/max_concurrent").arg(provider), 0).toInt());
+    return limits;
+}
+
+// A second's worth of requests may go out back to back, so a low rate does
+// not serialize requests that the provider would happily take together.
+double bucketCapacity(double requestsPerMinute)
+{
+    return std::max(1.0, requestsPerMinute / 60.0);
+}
+} // namespace
+
+ProviderScheduler::Permit::Permit(ProviderScheduler *scheduler, QString provider)
+    : scheduler_(scheduler), provider_(std::move(provider))
+{
+}
+
+ProviderScheduler::Permit::Permit(Permit &&other) noexcept
+    : scheduler_(other.scheduler_), provider_(std::move(other.provider_))
+{
+    other.scheduler_ = nullptr;
+}
+
+ProviderScheduler::Permit::~Permit()
+{
+    if (scheduler_)
+    {
+        scheduler_->release(provider_);
+    }
+}
+
+void ProviderScheduler::Permit::complete(CURL *curl) const
+{
+    if (!scheduler_ || !curl)
+    {
+        return;
+    }
+    long httpStatus = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpStatus);
+    scheduler_->report(provider_, httpStatus);
+}
+
+ProviderScheduler &ProviderScheduler::instance()
+{
+    static ProviderScheduler scheduler;
+    return scheduler;
+}
+
+ProviderScheduler::ProviderScheduler()
+{
+    // Callers have run curl_global_init before their first request.
+    share_ = curl_share_init();
+    if (share_)
+    {
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &ProviderScheduler::lock_share);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &ProviderScheduler::unlock_share);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        // Not CURL_LOCK_DATA_CONNECT: a shared connection cache is not safe
+        // with easy handles performing on several threads at once.
+    }
+}
+
+ProviderScheduler::~ProviderScheduler()
+{
+    if (share_)
+    {
+        curl_share_cleanup(share_);
+    }
+}
+
+ProviderScheduler::Permit ProviderScheduler::acquire(const QString &provider)
+{
+    SRT_TRACE_SCOPE("ProviderScheduler::acquire");
+    const Limits configured = limitsFromSettings(provider);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    State &state = state_locked(provider);
+    if (!state.overridden)
+    {
+        state.limits = configured;
+    }
+
+    for (;;)
+    {
+        const Clock::time_point now = Clock::now();
+        if (now < state.pausedUntil)
+        {
+            changed_.wait_until(lock, state.pausedUntil);
+            continue;
+        }
+        if (state.limits.maxConcurrent > 0 && state.inFlight >= state.limits.maxConcurrent)
+        {
+            changed_.wait(lock);
+            continue;
+        }
+
+        const double perMinute = state.limits.requestsPerMinute;
+        if (perMinute > 0.0)
+        {
+            const double elapsedMs = std::chrono::duration<double, std::milli>(now - state.refilledAt).count();
+            state.tokens = std::min(bucketCapacity(perMinute), state.tokens + elapsedMs * perMinute / 60000.0);
+            state.refilledAt = now;
+            if (state.tokens < 1.0)
+            {
+                const double waitMs = (1.0 - state.tokens) * 60000.0 / perMinute;
+                changed_.wait_until(lock, now + std::chrono::microseconds(static_cast<qint64>(waitMs * 1000.0) + 1));
+                continue;
+            }
+            state.tokens -= 1.0;
+        }
+
+        ++state.inFlight;
+        return Permit(this, provider);
+    }
+}
+
+void ProviderScheduler::set_limits(const QString &provider, const Limits &limits)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        State &state = state_locked(provider);
+        state.limits = limits;
+        state.overridden = true;
+    }
+    changed_.notify_all();
+}
+
+ProviderScheduler::Limits ProviderScheduler::limits(const QString &provider) const
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = states_.constFind(provider);
+        if (it != states_.constEnd() && it.value()->overridden)
+        {
+            return it.value()->limits;
+        }
+    }
+    return limitsFromSettings(provider);
+}
+
+void ProviderScheduler::share_caches(CURL *curl)
+{
+    if (share_ && curl)
+    {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    }
+}
+
+ProviderScheduler::State &ProviderScheduler::state_locked(const QString &provider)
+{
+    std::shared_ptr<State> &state = states_[provider];
+    if (!state)
+    {
+        state = std::make_shared<State>();
+    }
+    return *state;
+}
+
+void ProviderScheduler::release(const QString &provider)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        State &state = state_locked(provider);
+        state.inFlight = std::max(0, state.inFlight - 1);
+    }
+    changed_.notify_all();
+}
+
+void ProviderScheduler::report(const QString &provider, long httpStatus)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    State &state = state_locked(provider);
+    if (httpStatus != 429)
+    {
+        state.backoffMs = 0;
+        return;
+    }
+
+    // Every request still in flight was sent under the same quota, so one
+    // pause covers them all instead of each 429 stacking another.
+    const Clock::time_point now = Clock::now();
+    if (now < state.pausedUntil)
+    {
+        return;
+    }
+    state.backoffMs = std::clamp(state.backoffMs * 2, kInitialBackoffMs, kMaxBackoffMs);
+    state.pausedUntil = now + std::chrono::milliseconds(state.backoffMs);
+    SRT_LOG_WARN("scheduler", "{} is throttling, pausing requests for {} ms", provider, state.backoffMs);
+}
+
+void ProviderScheduler::lock_share(CURL *, curl_lock_data data, curl_lock_access, void *userData)
+{
+    static_cast<ProviderScheduler *>(userData)->shareMutexes_[data].lock();
+}
+
+void ProviderScheduler::unlock_share(CURL *, curl_lock_data data, void *userData)
+{
+    static_cast<ProviderScheduler *>(userData)->shareMutexes_[data].unlock();
+}
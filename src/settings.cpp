@@ -1,74 +1,107 @@
 #include "settings.h"
 
-Settings::Settings()
-    : settings_()
-{
-}
+#include "settings_service.h"
 
-Settings::Settings(const QString &organization, const QString &application)
-    : settings_(organization, application)
-{
-}
-
-Settings::Settings(QSettings::Format format,
-                   QSettings::Scope scope,
-                   const QString &organization,
-                   const QString &application)
-    : settings_(format, scope, organization, application)
-{
-}
+#include <QSet>
 
 QVariant Settings::value(const QString &key, const QVariant &defaultValue) const
 {
-    return settings_.value(key, defaultValue);
+    return SettingsService::instance().value(qualified(key), defaultValue);
 }
 
 void Settings::setValue(const QString &key, const QVariant &value)
 {
-    settings_.setValue(key, value);
+    SettingsService::instance().set_value(qualified(key), value);
 }
 
 bool Settings::contains(const QString &key) const
 {
-    return settings_.contains(key);
+    return SettingsService::instance().snapshot()->contains(qualified(key));
 }
 
 void Settings::remove(const QString &key)
 {
-    settings_.remove(key);
+    SettingsService::instance().remove(qualified(key));
 }
 
 QStringList Settings::childKeys() const
 {
-    return settings_.childKeys();
+    const QString prefix = groups_.isEmpty() ? QString() : groups_.join(QLatin1Char('/')) + QLatin1Char('/');
+    QStringList keys;
+    const auto snapshot = SettingsService::instance().snapshot();
+    for (auto it = snapshot->constBegin(); it != snapshot->constEnd(); ++it)
+    {
+        if (it.key().startsWith(prefix) && !it.key().mid(prefix.size()).contains(QLatin1Char('/')))
+        {
+            keys.append(it.key().mid(prefix.size()));
+        }
+    }
+    keys.sort();
+    return keys;
 }
 
 QStringList Settings::childGroups() const
 {
-    return settings_.childGroups();
+    const QString prefix = groups_.isEmpty() ? QString() : groups_.join(QLatin1Char('/')) + QLatin1Char('/');
+    QSet<QString> groups;
+    const auto snapshot = SettingsService::instance().snapshot();
+    for (auto it = snapshot->constBegin(); it != snapshot->constEnd(); ++it)
+    {
+        if (!it.key().startsWith(prefix))
+        {
+            continue;
+        }
+        const QString rest = it.key().mid(prefix.size());
+        const int slash = rest.indexOf(QLatin1Char('/'));
+        if (slash > 0)
+        {
+            groups.insert(rest.left(slash));
+        }
+    }
+    QStringList result = groups.values();
+    result.sort();
+    return result;
 }
 
 void Settings::beginGroup(const QString &prefix)
 {
-    settings_.beginGroup(prefix);
+    groups_.append(prefix);
 }
 
 void Settings::endGroup()
 {
-    settings_.endGroup();
+    if (!groups_.isEmpty())
+    {
+        groups_.removeLast();
+    }
 }
 
 void Settings::clear()
 {
-    settings_.clear();
+    // Like QSettings::clear(), limited to the current group.
+    SettingsService::instance().remove(groups_.join(QLatin1Char('/')));
 }
 
 void Settings::sync()
 {
-    settings_.sync();
+    SettingsService::instance().schedule_flush();
+}
+
+void Settings::flush()
+{
+    SettingsService::instance().flush();
 }
 
 QString Settings::fileName() const
 {
-    return settings_.fileName();
+    return SettingsService::instance().file_name();
+}
+
+QString Settings::qualified(const QString &key) const
+{
+    if (groups_.isEmpty())
+    {
+        return key;
+    }
+    return groups_.join(QLatin1Char('/')) + QLatin1Char('/') + key;
 }
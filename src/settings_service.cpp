@@ -0,0 +1,169 @@
+#include "settings_service.h"
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QThread>
+
+#include <atomic>
+#include <utility>
+
+namespace
+{
+// Long enough to absorb typing and spin-box auto-repeat.
+constexpr int kFlushDelayMs = 500;
+} // namespace
+
+SettingsService &SettingsService::instance()
+{
+    static SettingsService service;
+    return service;
+}
+
+SettingsService::SettingsService()
+{
+    auto initial = std::make_shared<Snapshot>();
+    for (const QString &key : store_.allKeys())
+    {
+        initial->insert(key, store_.value(key));
+    }
+    std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(initial)));
+
+    flushTimer_ = new QTimer(this);
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(kFlushDelayMs);
+    connect(flushTimer_, &QTimer::timeout, this, &SettingsService::flush);
+
+    // The first caller may be a worker thread; the debounce timer has to
+    // live on the GUI thread, where the event loop runs.
+    if (QCoreApplication *app = QCoreApplication::instance())
+    {
+        if (thread() != app->thread())
+        {
+            moveToThread(app->thread());
+        }
+        connect(app, &QCoreApplication::aboutToQuit, this, &SettingsService::flush);
+    }
+}
+
+SettingsService::~SettingsService()
+{
+    flush();
+}
+
+std::shared_ptr<const SettingsService::Snapshot> SettingsService::snapshot() const
+{
+    return std::atomic_load(&snapshot_);
+}
+
+QVariant SettingsService::value(const QString &key, const QVariant &defaultValue) const
+{
+    return snapshot()->value(key, defaultValue);
+}
+
+void SettingsService::set_value(const QString &key, const QVariant &value)
+{
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        const auto current = snapshot();
+        const auto it = current->constFind(key);
+        if (it != current->constEnd() && *it == value)
+        {
+            return;
+        }
+
+        auto next = std::make_shared<Snapshot>(*current);
+        next->insert(key, value);
+        dirtyKeys_.insert(key);
+        publish(std::move(next));
+    }
+    emit changed(key);
+}
+
+void SettingsService::remove(const QString &key)
+{
+    QStringList removed;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        const auto current = snapshot();
+        const QString prefix = key + QLatin1Char('/');
+        for (auto it = current->constBegin(); it != current->constEnd(); ++it)
+        {
+            if (key.isEmpty() || it.key() == key || it.key().startsWith(prefix))
+            {
+                removed.append(it.key());
+            }
+        }
+        if (removed.isEmpty())
+        {
+            return;
+        }
+
+        auto next = std::make_shared<Snapshot>(*current);
+        for (const QString &name : removed)
+        {
+            next->remove(name);
+            dirtyKeys_.insert(name);
+        }
+        publish(std::move(next));
+    }
+
+    for (const QString &name : removed)
+    {
+        emit changed(name);
+    }
+}
+
+void SettingsService::clear()
+{
+    remove(QString());
+}
+
+void SettingsService::schedule_flush()
+{
+    if (QThread::currentThread() == thread())
+    {
+        flushTimer_->start();
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() { flushTimer_->start(); }, Qt::QueuedConnection);
+}
+
+void SettingsService::flush()
+{
+    if (QThread::currentThread() == thread())
+    {
+        flushTimer_->stop();
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (dirtyKeys_.isEmpty())
+    {
+        return;
+    }
+
+    const auto current = snapshot();
+    for (const QString &key : std::as_const(dirtyKeys_))
+    {
+        const auto it = current->constFind(key);
+        if (it == current->constEnd())
+        {
+            store_.remove(key);
+        }
+        else
+        {
+            store_.setValue(key, *it);
+        }
+    }
+    dirtyKeys_.clear();
+    store_.sync();
+}
+
+QString SettingsService::file_name() const
+{
+    return store_.fileName();
+}
+
+void SettingsService::publish(std::shared_ptr<const Snapshot> next)
+{
+    std::atomic_store(&snapshot_, std::move(next));
+}
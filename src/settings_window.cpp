@@ -95,6 +95,10 @@ void SettingsWindow::draw_ai_provider_language()
             {
         settings.setValue(apiKeyKey, value);
         settings.sync(); });
+
+    // Keys are written as soon as editing ends rather than on the debounce.
+    connect(apiKeyEdit, &QLineEdit::editingFinished, this, [this]()
+            { settings.flush(); });
 }
 
 void SettingsWindow::draw_ai_provider_text_to_speech()
@@ -116,7 +120,7 @@ void SettingsWindow::draw_ai_provider_text_to_speech()
     auto *providerCombo = new QComboBox(container);
     providerCombo->setObjectName(QStringLiteral("providerCombo"));
     // providerCombo->addItems({tr("OpenAI"), tr("Github Model"), tr("Google Translate"), tr("Gemini")});
-    providerCombo->addItems({tr("ElevenLabs"), tr("OpenAI")});
+    providerCombo->addItems({tr("ElevenLabs"), tr("OpenAI"), tr("Local")});
 
     const QString providerKey = QStringLiteral("ai/audio/provider");
     const QString storedProvider = settings.value(providerKey, providerCombo->itemText(0)).toString();
@@ -132,10 +136,43 @@ void SettingsWindow::draw_ai_provider_text_to_speech()
     const QString apiKeyKey = QStringLiteral("ai/audio/apiKey");
     apiKeyEdit->setText(settings.value(apiKeyKey).toString());
 
+    auto *localExecutableLabel = new QLabel(tr("Local Engine Executable"), container);
+    localExecutableLabel->setObjectName(QStringLiteral("localExecutableLabel"));
+
+    auto *localExecutableEdit = new QLineEdit(container);
+    localExecutableEdit->setObjectName(QStringLiteral("localExecutableEdit"));
+    localExecutableEdit->setPlaceholderText(QStringLiteral("piper"));
+    const QString localExecutableKey = QStringLiteral("tts/local/executable");
+    localExecutableEdit->setText(settings.value(localExecutableKey).toString());
+
+    auto *localModelLabel = new QLabel(tr("Local Voice Model"), container);
+    localModelLabel->setObjectName(QStringLiteral("localModelLabel"));
+
+    auto *localModelEdit = new QLineEdit(container);
+    localModelEdit->setObjectName(QStringLiteral("localModelEdit"));
+    localModelEdit->setPlaceholderText(tr("Path to a Piper .onnx voice"));
+    const QString localModelKey = QStringLiteral("tts/local/model");
+    localModelEdit->setText(settings.value(localModelKey).toString());
+
+    auto *localWorkersLabel = new QLabel(tr("Local Engine Workers"), container);
+    localWorkersLabel->setObjectName(QStringLiteral("localWorkersLabel"));
+
+    auto *localWorkersSpin = new QSpinBox(container);
+    localWorkersSpin->setObjectName(QStringLiteral("localWorkersSpin"));
+    localWorkersSpin->setRange(1, 16);
+    const QString localWorkersKey = QStringLiteral("tts/local/workers");
+    localWorkersSpin->setValue(settings.value(localWorkersKey, 2).toInt());
+
     layout->addWidget(providerLabel);
     layout->addWidget(providerCombo);
     layout->addWidget(apiKeyLabel);
     layout->addWidget(apiKeyEdit);
+    layout->addWidget(localExecutableLabel);
+    layout->addWidget(localExecutableEdit);
+    layout->addWidget(localModelLabel);
+    layout->addWidget(localModelEdit);
+    layout->addWidget(localWorkersLabel);
+    layout->addWidget(localWorkersSpin);
     layout->addStretch(1);
 
     container->setLayout(layout);
@@ -150,4 +187,22 @@ void SettingsWindow::draw_ai_provider_text_to_speech()
             {
         settings.setValue(apiKeyKey, value);
         settings.sync(); });
+
+    connect(apiKeyEdit, &QLineEdit::editingFinished, this, [this]()
+            { settings.flush(); });
+
+    connect(localExecutableEdit, &QLineEdit::textChanged, this, [this, localExecutableKey](const QString &value)
+            {
+        settings.setValue(localExecutableKey, value);
+        settings.sync(); });
+
+    connect(localModelEdit, &QLineEdit::textChanged, this, [this, localModelKey](const QString &value)
+            {
+        settings.setValue(localModelKey, value);
+        settings.sync(); });
+
+    connect(localWorkersSpin, qOverload<int>(&QSpinBox::valueChanged), this, [this, localWorkersKey](int value)
+            {
+        settings.setValue(localWorkersKey, value);
+        settings.sync(); });
 }
@@ -0,0 +1,119 @@
+#include "silence_trimmer.h"
+
+#include "simd.h"
+#include "wav_file.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double kWindowSeconds = 0.010;
+constexpr double kGuardSeconds = 0.030;
+constexpr double kFadeSeconds = 0.005;
+
+// Short fades at the new edges, so a cut inside low-level noise does not click.
+void fadeEdges(std::vector<float> &samples, int channels, int sampleRate)
+{
+    const size_t frames = samples.size() / static_cast<size_t>(channels);
+    const size_t fadeFrames = std::min(frames / 2, static_cast<size_t>(kFadeSeconds * sampleRate));
+    for (size_t frame = 0; frame < fadeFrames; ++frame)
+    {
+        const float gain = static_cast<float>(frame) / static_cast<float>(fadeFrames);
+        for (int c = 0; c < channels; ++c)
+        {
+            samples[frame * static_cast<size_t>(channels) + static_cast<size_t>(c)] *= gain;
+            samples[(frames - 1 - frame) * static_cast<size_t>(channels) + static_cast<size_t>(c)] *= gain;
+        }
+    }
+}
+} // namespace
+
+bool SilenceTrimmer::find_speech(const std::vector<float> &samples,
+                                 int channels,
+                                 int sampleRate,
+                                 double thresholdDb,
+                                 qint64 *begin,
+                                 qint64 *end)
+{
+    if (samples.empty() || channels <= 0 || sampleRate <= 0)
+    {
+        return false;
+    }
+
+    const qint64 frames = static_cast<qint64>(samples.size()) / channels;
+    const qint64 window = std::max<qint64>(1, std::llround(kWindowSeconds * sampleRate));
+    const qint64 windows = (frames + window - 1) / window;
+
+    // Compare mean-square energy against the threshold directly; no log per window.
+    const double thresholdPower = std::pow(10.0, thresholdDb / 10.0);
+    auto isSpeech = [&](qint64 index) {
+        const qint64 first = index * window;
+        const qint64 count = std::min(window, frames - first);
+        const int values = static_cast<int>(count * channels);
+        const double energy = sumOfSquares(samples.data() + first * channels, values);
+        return energy / values >= thresholdPower;
+    };
+
+    qint64 firstWindow = 0;
+    while (firstWindow < windows && !isSpeech(firstWindow))
+    {
+        ++firstWindow;
+    }
+    if (firstWindow == windows)
+    {
+        return false;
+    }
+
+    qint64 lastWindow = windows - 1;
+    while (lastWindow > firstWindow && !isSpeech(lastWindow))
+    {
+        --lastWindow;
+    }
+
+    const qint64 guard = std::llround(kGuardSeconds * sampleRate);
+    *begin = std::max<qint64>(0, firstWindow * window - guard);
+    *end = std::min(frames, (lastWindow + 1) * window + guard);
+    return true;
+}
+
+SilenceTrimmer::Result SilenceTrimmer::trim_file(const QString &path, double thresholdDb)
+{
+    Result result;
+    WavFormat format;
+    std::vector<float> samples;
+    if (!WavFile::is_wav(path) || !WavFile::read(path, &format, &samples) || samples.empty())
+    {
+        return result;
+    }
+
+    const qint64 frames = static_cast<qint64>(samples.size()) / format.channels;
+    qint64 begin = 0;
+    qint64 end = frames;
+    if (!find_speech(samples, format.channels, format.sampleRate, thresholdDb, &begin, &end))
+    {
+        // All silence: leave it alone rather than produce an empty clip.
+        result.ok = true;
+        result.speechSeconds = static_cast<double>(frames) / format.sampleRate;
+        return result;
+    }
+
+    result.leadingSeconds = static_cast<double>(begin) / format.sampleRate;
+    result.trailingSeconds = static_cast<double>(frames - end) / format.sampleRate;
+    result.speechSeconds = static_cast<double>(end - begin) / format.sampleRate;
+
+    if (begin > 0 || end < frames)
+    {
+        std::vector<float> speech(samples.begin() + static_cast<std::ptrdiff_t>(begin * format.channels),
+                                  samples.begin() + static_cast<std::ptrdiff_t>(end * format.channels));
+        fadeEdges(speech, format.channels, format.sampleRate);
+        // Replaced through a temporary file, like every other clip rewrite.
+        if (!WavFile::write(path, format, speech))
+        {
+            return result;
+        }
+    }
+
+    result.ok = true;
+    return result;
+}
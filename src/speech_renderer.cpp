@@ -0,0 +1,101 @@
+#include "speech_renderer.h"
+
+#include "audio.h"
+#include "loudness.h"
+#include "silence_trimmer.h"
+#include "time_stretch.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <string>
+
+bool SpeechRenderer::is_local_provider(const QString &provider)
+{
+    return provider.compare(QStringLiteral("Local"), Qt::CaseInsensitive) == 0;
+}
+
+bool SpeechRenderer::is_supported_provider(const QString &provider)
+{
+    return is_local_provider(provider) ||
+           provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0 ||
+           provider.compare(QStringLiteral("ElevenLabs"), Qt::CaseInsensitive) == 0;
+}
+
+double SpeechRenderer::render(const SpeechJob &job)
+{
+    // Identical text and voice settings are served from the clip cache
+    // without a network round trip.
+    double cachedDuration = 0.0;
+    if (TtsCache::instance().fetch(job.cacheKey, job.filePath, &cachedDuration))
+    {
+        return finalize(job, cachedDuration);
+    }
+
+    // Success is judged by the clip existing afterwards, and the batch tool
+    // reuses its clip paths across runs; a failed request must not leave an
+    // older clip behind to be taken for this one.
+    if (QFile::exists(job.filePath) && !QFile::remove(job.filePath))
+    {
+        return -1.0;
+    }
+
+    Audio audio;
+    const std::string nativeFilePath = QDir::toNativeSeparators(job.filePath).toStdString();
+    const std::string tokenStd = job.token.toStdString();
+
+    if (is_local_provider(job.provider))
+    {
+        audio.local_text_to_speech(job.text, nativeFilePath, job.speed);
+    }
+    else if (job.provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
+    {
+        audio.openai_text_to_speech(job.text, nativeFilePath, job.voice, job.model, tokenStd, job.speed);
+    }
+    else
+    {
+        audio.elevenlabs_text_to_speech(job.text, nativeFilePath, job.voice, job.model, tokenStd, job.speed);
+    }
+
+    if (!QFile::exists(job.filePath))
+    {
+        return -1.0;
+    }
+
+    const double durationSeconds = audio.get_audio_duration_seconds(nativeFilePath);
+
+    // The cache keeps the clip as synthesized; fitting is applied per cue.
+    TtsCache::instance().store(job.cacheKey, job.filePath, durationSeconds);
+    return finalize(job, durationSeconds);
+}
+
+double SpeechRenderer::finalize(const SpeechJob &job, double durationSeconds)
+{
+    // Trim first, so slot fitting works from the length of the speech itself.
+    double seconds = durationSeconds;
+    if (job.trimSilence)
+    {
+        const SilenceTrimmer::Result trim = SilenceTrimmer::trim_file(job.filePath, job.trimThresholdDb);
+        if (trim.ok)
+        {
+            seconds = trim.speechSeconds;
+        }
+    }
+
+    // The clip is replaced through a temporary file, so a copy shared with the
+    // clip cache keeps its original length.
+    if (job.fitToSlot && job.slotMs > 0 && seconds > 0.0)
+    {
+        double fittedSeconds = seconds;
+        if (TimeStretch::fit_clip(job.filePath, job.slotMs / 1000.0, job.maxStretchRatio, &fittedSeconds))
+        {
+            seconds = fittedSeconds;
+        }
+    }
+
+    if (job.normalizeLoudness)
+    {
+        Loudness::normalize_file(job.filePath, job.targetLufs, kTruePeakCeilingDbtp);
+    }
+    return seconds;
+}
@@ -0,0 +1,138 @@
+#include "srt_document.h"
+
+#include "trace.h"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStringList>
+
+namespace
+{
+void appendCue(const QStringList &lines, QVector<SrtCue> *cues)
+{
+    if (lines.size() < 2)
+    {
+        return;
+    }
+
+    QStringList payload = lines;
+    payload.removeFirst(); // subtitle index
+
+    const QString timingLine = payload.takeFirst();
+    static const QRegularExpression timingPattern(
+        QStringLiteral(R"((\d{2}:\d{2}:\d{2},\d{3})\s*-->\s*(\d{2}:\d{2}:\d{2},\d{3}))"));
+    const QRegularExpressionMatch match = timingPattern.match(timingLine);
+    if (!match.hasMatch())
+    {
+        return;
+    }
+
+    cues->push_back(SrtCue{match.captured(1), match.captured(2), payload.join(QStringLiteral("\n"))});
+}
+} // namespace
+
+QVector<SrtCue> SrtDocument::parse(const QString &content)
+{
+    SRT_TRACE_SCOPE("SrtDocument::parse");
+    QVector<SrtCue> cues;
+    QStringList block;
+
+    const int skip = content.startsWith(QChar(0xFEFF)) ? 1 : 0;
+    int lineStart = skip;
+    while (lineStart <= content.size())
+    {
+        int lineEnd = content.indexOf(QLatin1Char('\n'), lineStart);
+        if (lineEnd == -1)
+        {
+            lineEnd = content.size();
+        }
+
+        QString line = content.mid(lineStart, lineEnd - lineStart);
+        if (line.endsWith(QLatin1Char('\r')))
+        {
+            line.chop(1);
+        }
+        if (line.trimmed().isEmpty())
+        {
+            if (!block.isEmpty())
+            {
+                appendCue(block, &cues);
+                block.clear();
+            }
+        }
+        else
+        {
+            block << line;
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    if (!block.isEmpty())
+    {
+        appendCue(block, &cues);
+    }
+
+    return cues;
+}
+
+QString SrtDocument::serialize(const QVector<SrtCue> &cues)
+{
+    SRT_TRACE_SCOPE("SrtDocument::serialize");
+    QString output;
+    int subtitleIndex = 1;
+    for (const SrtCue &cue : cues)
+    {
+        if (cue.start.isEmpty() || cue.end.isEmpty())
+        {
+            continue;
+        }
+
+        if (subtitleIndex > 1)
+        {
+            output += QStringLiteral("\r\n");
+        }
+
+        output += QString::number(subtitleIndex++) + QStringLiteral("\r\n");
+        output += cue.start + QStringLiteral(" --> ") + cue.end + QStringLiteral("\r\n");
+        const QStringList textLines = cue.text.split(QLatin1Char('\n'));
+        for (const QString &textLine : textLines)
+        {
+            output += textLine + QStringLiteral("\r\n");
+        }
+    }
+    return output;
+}
+
+bool SrtDocument::read_file(const QString &path, QVector<SrtCue> *cues, QString *errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (errorMessage)
+        {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    *cues = parse(QString::fromUtf8(file.readAll()));
+    return true;
+}
+
+bool SrtDocument::write_file(const QString &path, const QVector<SrtCue> &cues, QString *errorMessage)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(serialize(cues).toUtf8()) < 0 ||
+        !file.commit())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,167 @@
+#include "srt_timing.h"
+
+#include <QRegularExpression>
+
+#include <cmath>
+
+namespace
+{
+qint64 toMilliseconds(int hours, int minutes, int seconds, int milliseconds)
+{
+    return (((static_cast<qint64>(hours) * 60) + minutes) * 60 + seconds) * 1000 + milliseconds;
+}
+} // namespace
+
+qint64 SrtTiming::parse_srt_timestamp(const QString &value)
+{
+    static const QRegularExpression pattern(QStringLiteral(R"(^(\d{2}):(\d{2}):(\d{2}),(\d{3})$)"));
+    const QRegularExpressionMatch match = pattern.match(value.trimmed());
+    if (!match.hasMatch())
+    {
+        return -1;
+    }
+
+    return toMilliseconds(match.captured(1).toInt(),
+                          match.captured(2).toInt(),
+                          match.captured(3).toInt(),
+                          match.captured(4).toInt());
+}
+
+qint64 SrtTiming::parse_flexible_duration(const QString &value)
+{
+    const QString trimmed = value.trimmed();
+    if (trimmed.isEmpty())
+    {
+        return -1;
+    }
+
+    static const QRegularExpression longPattern(QStringLiteral(R"(^(\d{2}):(\d{2}):(\d{2})[\.,](\d{3})$)"));
+    QRegularExpressionMatch match = longPattern.match(trimmed);
+    if (match.hasMatch())
+    {
+        return toMilliseconds(match.captured(1).toInt(),
+                              match.captured(2).toInt(),
+                              match.captured(3).toInt(),
+                              match.captured(4).toInt());
+    }
+
+    static const QRegularExpression mediumPattern(QStringLiteral(R"(^(\d{2}):(\d{2})[\.,](\d{3})$)"));
+    match = mediumPattern.match(trimmed);
+    if (match.hasMatch())
+    {
+        return toMilliseconds(0,
+                              match.captured(1).toInt(),
+                              match.captured(2).toInt(),
+                              match.captured(3).toInt());
+    }
+
+    static const QRegularExpression secondsPattern(
+        QStringLiteral(R"((\d+)(?:[\.,](\d{1,3}))?\s*s?$)"),
+        QRegularExpression::CaseInsensitiveOption);
+    match = secondsPattern.match(trimmed);
+    if (match.hasMatch())
+    {
+        const qint64 seconds = match.captured(1).toLongLong();
+        QString fraction = match.captured(2);
+        int milliseconds = 0;
+        if (!fraction.isEmpty())
+        {
+            if (fraction.length() > 3)
+            {
+                fraction = fraction.left(3);
+            }
+            while (fraction.length() < 3)
+            {
+                fraction.append(QLatin1Char('0'));
+            }
+            milliseconds = fraction.toInt();
+        }
+
+        return seconds * 1000 + milliseconds;
+    }
+
+    return -1;
+}
+
+QString SrtTiming::milliseconds_to_srt(qint64 msecs)
+{
+    if (msecs < 0)
+    {
+        return {};
+    }
+
+    const int hours = static_cast<int>(msecs / (60 * 60 * 1000));
+    const int minutes = static_cast<int>((msecs / (60 * 1000)) % 60);
+    const int seconds = static_cast<int>((msecs / 1000) % 60);
+    const int milliseconds = static_cast<int>(msecs % 1000);
+
+    return QStringLiteral("%1:%2:%3,%4")
+        .arg(hours, 2, 10, QLatin1Char('0'))
+        .arg(minutes, 2, 10, QLatin1Char('0'))
+        .arg(seconds, 2, 10, QLatin1Char('0'))
+        .arg(milliseconds, 3, 10, QLatin1Char('0'));
+}
+
+QString SrtTiming::compute_duration_string(const QString &start, const QString &end)
+{
+    const qint64 startMs = parse_srt_timestamp(start);
+    const qint64 endMs = parse_srt_timestamp(end);
+    if (startMs < 0 || endMs < 0)
+    {
+        return {};
+    }
+
+    qint64 diff = endMs - startMs;
+    if (diff < 0)
+    {
+        diff += kMillisecondsPerDay;
+    }
+    if (diff < 0)
+    {
+        return {};
+    }
+
+    return milliseconds_to_srt(diff);
+}
+
+QString SrtTiming::add_duration_to_timestamp(const QString &start, const QString &duration)
+{
+    const qint64 startMs = parse_srt_timestamp(start);
+    const qint64 durationMs = parse_srt_timestamp(duration);
+    if (startMs < 0 || durationMs < 0)
+    {
+        return {};
+    }
+
+    qint64 endMs = startMs + durationMs;
+    endMs %= kMillisecondsPerDay;
+    if (endMs < 0)
+    {
+        endMs += kMillisecondsPerDay;
+    }
+
+    return milliseconds_to_srt(endMs);
+}
+
+QString SrtTiming::normalize_duration_from_tts(const QString &rawDuration)
+{
+    const qint64 durationMs = parse_flexible_duration(rawDuration);
+    if (durationMs < 0)
+    {
+        return {};
+    }
+
+    return milliseconds_to_srt(durationMs);
+}
+
+QString SrtTiming::retime_timestamp(const QString &timestamp, qint64 offsetMs, double factor)
+{
+    const qint64 ms = parse_srt_timestamp(timestamp);
+    if (ms < 0)
+    {
+        return {};
+    }
+
+    const qint64 retimed = static_cast<qint64>(std::llround(static_cast<double>(ms) * factor)) + offsetMs;
+    return milliseconds_to_srt(qMax<qint64>(retimed, 0));
+}
@@ -0,0 +1,23 @@
+#include "subtitle_table.h"
+
+#include "srt_timing.h"
+#include "trace.h"
+
+#include <QTableWidgetItem>
+
+void SubtitleTable::populate(QTableWidget *table, const QVector<SrtCue> &cues)
+{
+    SRT_TRACE_SCOPE("SubtitleTable::populate");
+    const int rowCount = static_cast<int>(cues.size());
+    table->setRowCount(0);
+    table->setRowCount(rowCount);
+
+    for (int row = 0; row < rowCount; ++row)
+    {
+        const SrtCue &cue = cues.at(row);
+        table->setItem(row, StartColumn, new QTableWidgetItem(cue.start));
+        table->setItem(row, EndColumn, new QTableWidgetItem(cue.end));
+        table->setItem(row, DurationColumn, new QTableWidgetItem(SrtTiming::compute_duration_string(cue.start, cue.end)));
+        table->setItem(row, TextColumn, new QTableWidgetItem(cue.text));
+    }
+}
@@ -0,0 +1,142 @@
+#include "text_chunker.h"
+
+#include <QTextBoundaryFinder>
+
+#include <algorithm>
+
+namespace
+{
+bool isClauseBreak(QChar ch)
+{
+    switch (ch.unicode())
+    {
+    case ',':
+    case ';':
+    case ':':
+    case ')':
+    case 0x2013: // en dash
+    case 0x2014: // em dash
+    case 0x3001: // ideographic comma
+    case 0xFF0C: // fullwidth comma
+    case 0xFF1B: // fullwidth semicolon
+        return true;
+    default:
+        return false;
+    }
+}
+
+QStringList sentencesOf(const QString &text)
+{
+    QStringList sentences;
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Sentence, text);
+    int start = 0;
+    for (int end = finder.toNextBoundary(); end != -1; end = finder.toNextBoundary())
+    {
+        const QString sentence = text.mid(start, end - start).trimmed();
+        if (!sentence.isEmpty())
+        {
+            sentences.append(sentence);
+        }
+        start = end;
+    }
+    return sentences;
+}
+
+// Position to cut an over-long sentence at, no further than maxChars.
+int findCut(const QString &text, int maxChars)
+{
+    // A clause break in the back half keeps both pieces reasonably sized.
+    for (int i = maxChars - 1; i >= maxChars / 2; --i)
+    {
+        if (isClauseBreak(text.at(i)))
+        {
+            return i + 1;
+        }
+    }
+
+    for (int i = maxChars; i > 0; --i)
+    {
+        if (text.at(i).isSpace())
+        {
+            return i;
+        }
+    }
+
+    // No break at all (e.g. CJK without punctuation); never split a
+    // surrogate pair.
+    return text.at(maxChars - 1).isHighSurrogate() ? maxChars - 1 : maxChars;
+}
+
+void appendSplitSentence(QString sentence, int maxChars, QStringList *pieces)
+{
+    while (sentence.size() > maxChars)
+    {
+        const int cut = findCut(sentence, maxChars);
+        pieces->append(sentence.left(cut).trimmed());
+        sentence = sentence.mid(cut).trimmed();
+    }
+    if (!sentence.isEmpty())
+    {
+        pieces->append(sentence);
+    }
+}
+} // namespace
+
+QStringList TextChunker::split(const QString &text, int maxChars)
+{
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty())
+    {
+        return {};
+    }
+    if (maxChars <= 1 || trimmed.size() <= maxChars)
+    {
+        return {trimmed};
+    }
+
+    QStringList pieces;
+    for (const QString &sentence : sentencesOf(trimmed))
+    {
+        appendSplitSentence(sentence, maxChars, &pieces);
+    }
+
+    // Pack whole sentences greedily so requests stay as few as the limit allows.
+    QStringList chunks;
+    QString current;
+    for (const QString &piece : pieces)
+    {
+        if (current.isEmpty())
+        {
+            current = piece;
+        }
+        else if (current.size() + 1 + piece.size() <= maxChars)
+        {
+            current += QLatin1Char(' ') + piece;
+        }
+        else
+        {
+            chunks.append(current);
+            current = piece;
+        }
+    }
+    if (!current.isEmpty())
+    {
+        chunks.append(current);
+    }
+    return chunks;
+}
+
+QStringList TextChunker::split_balanced(const QString &text, int targetChars, int maxChars)
+{
+    const int length = text.trimmed().size();
+    if (targetChars <= 0 || length <= targetChars)
+    {
+        return split(text, maxChars);
+    }
+
+    // Aim for equal chunks with some slack, so sentence packing does not
+    // leave a short straggler at the end.
+    const int chunkCount = (length + targetChars - 1) / targetChars;
+    const int limit = (length + chunkCount - 1) / chunkCount + targetChars / 4;
+    return split(text, std::min(limit, maxChars));
+}
@@ -0,0 +1,450 @@
+#include "text_index.h"
+
+#include "parallel.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+// Rows per parallel task, large enough that scheduling is noise next to the
+// string work.
+constexpr int kBuildChunkRows = 16384;
+constexpr int kVerifyChunkRows = 4096;
+
+// Index of the ']' closing the character class opened at start, or the end
+// of the pattern when it is unterminated.
+int classEnd(const QString &pattern, int start)
+{
+    int i = start + 1;
+    if (i < pattern.size() && pattern.at(i) == QLatin1Char('^'))
+    {
+        ++i;
+    }
+    // A ']' right after the opening bracket is a literal.
+    if (i < pattern.size() && pattern.at(i) == QLatin1Char(']'))
+    {
+        ++i;
+    }
+    for (; i < pattern.size(); ++i)
+    {
+        if (pattern.at(i) == QLatin1Char('\\'))
+        {
+            ++i;
+        }
+        else if (pattern.at(i) == QLatin1Char(']'))
+        {
+            return i;
+        }
+    }
+    return pattern.size();
+}
+
+// Index of the last character of the escape whose backslash is at start.
+// Escapes with operands (\p{Lu}, \x41, \x{263a}, \k<name>, \cA, \012) are
+// skipped whole, so no part of them is taken for literal text.
+int escapeEnd(const QString &pattern, int start)
+{
+    const int last = pattern.size() - 1;
+    const int i = start + 1;
+    if (i > last)
+    {
+        return last;
+    }
+
+    const QChar kind = pattern.at(i);
+    const QChar next = i < last ? pattern.at(i + 1) : QChar();
+    const auto closedBy = [&pattern, last, i](QChar close) {
+        const int end = pattern.indexOf(close, i + 2);
+        return end == -1 ? last : end;
+    };
+    const auto skipWhile = [&pattern, last](int from, int limit, const auto &accept) {
+        int end = from - 1;
+        while (end < last && end + 1 - from < limit && accept(pattern.at(end + 1)))
+        {
+            ++end;
+        }
+        return end;
+    };
+    const auto isOctal = [](QChar ch) { return ch >= QLatin1Char('0') && ch <= QLatin1Char('7'); };
+    const auto isHex = [](QChar ch) {
+        return ch.isDigit() || (ch.toLower() >= QLatin1Char('a') && ch.toLower() <= QLatin1Char('f'));
+    };
+
+    if (next == QLatin1Char('{') && QStringLiteral("pPxogkN").contains(kind))
+    {
+        return closedBy(QLatin1Char('}'));
+    }
+    if ((kind == QLatin1Char('k') || kind == QLatin1Char('g')) && next == QLatin1Char('<'))
+    {
+        return closedBy(QLatin1Char('>'));
+    }
+    if ((kind == QLatin1Char('k') || kind == QLatin1Char('g')) && next == QLatin1Char('\''))
+    {
+        return closedBy(QLatin1Char('\''));
+    }
+    if (kind == QLatin1Char('p') || kind == QLatin1Char('P') || kind == QLatin1Char('c'))
+    {
+        // \pL and \cA take exactly one operand character.
+        return std::min(i + 1, last);
+    }
+    if (kind == QLatin1Char('x'))
+    {
+        return skipWhile(i + 1, 2, isHex);
+    }
+    if (kind == QLatin1Char('g'))
+    {
+        const int sign = next == QLatin1Char('-') || next == QLatin1Char('+') ? i + 1 : i;
+        return skipWhile(sign + 1, pattern.size(), [](QChar ch) { return ch.isDigit(); });
+    }
+    if (kind == QLatin1Char('0'))
+    {
+        return skipWhile(i + 1, 2, isOctal);
+    }
+    if (kind.isDigit())
+    {
+        // A back reference, or an octal escape when there are not that many
+        // groups; either way every following digit belongs to it.
+        return skipWhile(i + 1, pattern.size(), [](QChar ch) { return ch.isDigit(); });
+    }
+    return i;
+}
+} // namespace
+
+TextIndex::Matcher::Matcher(const Query &query)
+    : query_(query)
+{
+    if (query_.mode == Mode::Regex)
+    {
+        regex_ = QRegularExpression(query_.pattern,
+                                    query_.caseSensitive ? QRegularExpression::NoPatternOption
+                                                         : QRegularExpression::CaseInsensitiveOption);
+        // Compile now rather than in whichever verifying thread gets there first.
+        regex_.optimize();
+    }
+}
+
+const TextIndex::Query &TextIndex::Matcher::query() const
+{
+    return query_;
+}
+
+bool TextIndex::Matcher::is_valid() const
+{
+    return !query_.pattern.isEmpty() && (query_.mode == Mode::Substring || regex_.isValid());
+}
+
+QString TextIndex::Matcher::error() const
+{
+    return query_.mode == Mode::Regex && !regex_.isValid() ? regex_.errorString() : QString();
+}
+
+bool TextIndex::Matcher::matches(const QString &text) const
+{
+    if (query_.mode == Mode::Substring)
+    {
+        return text.contains(query_.pattern, query_.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    }
+    return regex_.match(text).hasMatch();
+}
+
+void TextIndex::reset(const QStringList &texts)
+{
+    SRT_TRACE_SCOPE("TextIndex::reset");
+    texts_ = texts;
+    postings_.clear();
+
+    const int rowCount = static_cast<int>(texts_.size());
+    const int chunkCount = (rowCount + kBuildChunkRows - 1) / kBuildChunkRows;
+    std::vector<QHash<Trigram, QVector<int>>> chunkPostings(chunkCount);
+    parallelFor(chunkCount, [this, rowCount, &chunkPostings](int chunk) {
+        QHash<Trigram, QVector<int>> &local = chunkPostings[chunk];
+        const int end = std::min(rowCount, (chunk + 1) * kBuildChunkRows);
+        for (int row = chunk * kBuildChunkRows; row < end; ++row)
+        {
+            for (const Trigram trigram : trigrams(texts_.at(row)))
+            {
+                local[trigram].push_back(row);
+            }
+        }
+    });
+
+    // Chunks cover ascending row ranges, so appending them in order keeps
+    // every posting list sorted.
+    for (QHash<Trigram, QVector<int>> &local : chunkPostings)
+    {
+        for (auto it = local.begin(); it != local.end(); ++it)
+        {
+            QVector<int> &rows = postings_[it.key()];
+            if (rows.isEmpty())
+            {
+                rows = std::move(it.value());
+            }
+            else
+            {
+                rows += it.value();
+            }
+        }
+        local.clear();
+    }
+}
+
+void TextIndex::set_text(int row, const QString &text)
+{
+    if (row < 0 || row >= texts_.size())
+    {
+        return;
+    }
+
+    const QVector<Trigram> before = trigrams(texts_.at(row));
+    const QVector<Trigram> after = trigrams(text);
+    texts_[row] = text;
+
+    QVector<Trigram> removed;
+    QVector<Trigram> added;
+    std::set_difference(before.cbegin(), before.cend(), after.cbegin(), after.cend(), std::back_inserter(removed));
+    std::set_difference(after.cbegin(), after.cend(), before.cbegin(), before.cend(), std::back_inserter(added));
+
+    for (const Trigram trigram : removed)
+    {
+        auto it = postings_.find(trigram);
+        if (it == postings_.end())
+        {
+            continue;
+        }
+        QVector<int> &rows = it.value();
+        const auto position = std::lower_bound(rows.begin(), rows.end(), row);
+        if (position != rows.end() && *position == row)
+        {
+            rows.erase(position);
+        }
+        if (rows.isEmpty())
+        {
+            postings_.erase(it);
+        }
+    }
+
+    for (const Trigram trigram : added)
+    {
+        QVector<int> &rows = postings_[trigram];
+        const auto position = std::lower_bound(rows.begin(), rows.end(), row);
+        if (position == rows.end() || *position != row)
+        {
+            rows.insert(position, row);
+        }
+    }
+}
+
+int TextIndex::size() const
+{
+    return static_cast<int>(texts_.size());
+}
+
+QString TextIndex::text(int row) const
+{
+    return texts_.value(row);
+}
+
+QVector<int> TextIndex::find(const Matcher &matcher) const
+{
+    SRT_TRACE_SCOPE("TextIndex::find");
+    if (!matcher.is_valid())
+    {
+        return {};
+    }
+
+    bool allRows = false;
+    const QVector<int> rows = candidates(matcher.query(), &allRows);
+    const int count = allRows ? size() : static_cast<int>(rows.size());
+    const int chunkCount = (count + kVerifyChunkRows - 1) / kVerifyChunkRows;
+
+    std::vector<QVector<int>> chunkHits(chunkCount);
+    parallelFor(chunkCount, [this, &rows, allRows, count, &matcher, &chunkHits](int chunk) {
+        QVector<int> &hits = chunkHits[chunk];
+        const int end = std::min(count, (chunk + 1) * kVerifyChunkRows);
+        for (int i = chunk * kVerifyChunkRows; i < end; ++i)
+        {
+            const int row = allRows ? i : rows.at(i);
+            if (matcher.matches(texts_.at(row)))
+            {
+                hits.push_back(row);
+            }
+        }
+    });
+
+    QVector<int> hits;
+    for (const QVector<int> &chunk : chunkHits)
+    {
+        hits += chunk;
+    }
+    return hits;
+}
+
+QStringList TextIndex::required_literals(const QString &pattern)
+{
+    // Only literals outside groups count, and any top-level alternation or
+    // inline option (which may switch on free spacing) gives up entirely. A
+    // missed literal only costs speed; a wrong one would lose matches.
+    // \Q...\E quoting can hide any metacharacter, so it gives up too.
+    if (pattern.contains(QStringLiteral("\\Q")))
+    {
+        return {};
+    }
+
+    QStringList literals;
+    QString run;
+    int depth = 0;
+    const auto flush = [&literals, &run]() {
+        if (run.size() >= 3)
+        {
+            literals.append(run);
+        }
+        run.clear();
+    };
+
+    for (int i = 0; i < pattern.size(); ++i)
+    {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('['))
+        {
+            flush();
+            i = classEnd(pattern, i);
+            continue;
+        }
+        if (c == QLatin1Char('('))
+        {
+            if (pattern.mid(i + 1, 1) == QStringLiteral("?") && pattern.mid(i + 2, 1) != QStringLiteral(":"))
+            {
+                return {};
+            }
+            flush();
+            ++depth;
+            continue;
+        }
+        if (c == QLatin1Char(')'))
+        {
+            depth = std::max(0, depth - 1);
+            continue;
+        }
+        if (c == QLatin1Char('|') && depth == 0)
+        {
+            return {};
+        }
+        if (depth > 0)
+        {
+            if (c == QLatin1Char('\\'))
+            {
+                i = escapeEnd(pattern, i);
+            }
+            continue;
+        }
+
+        if (c == QLatin1Char('\\'))
+        {
+            const QChar escaped = i + 1 < pattern.size() ? pattern.at(i + 1) : QChar();
+            // \d, \b, \1, \p{Lu} and friends are classes, anchors, references
+            // or code points spelled out, none of them literal text.
+            if (escaped.isNull() || escaped.isLetterOrNumber())
+            {
+                flush();
+                i = escapeEnd(pattern, i);
+            }
+            else
+            {
+                run.append(escaped);
+                ++i;
+            }
+        }
+        else if (c == QLatin1Char('*') || c == QLatin1Char('?'))
+        {
+            run.chop(1);
+            flush();
+        }
+        else if (c == QLatin1Char('{') && i + 1 < pattern.size() && pattern.at(i + 1).isDigit())
+        {
+            if (pattern.at(i + 1) == QLatin1Char('0'))
+            {
+                run.chop(1);
+            }
+            flush();
+            const int close = pattern.indexOf(QLatin1Char('}'), i);
+            i = close == -1 ? pattern.size() : close;
+        }
+        else if (c == QLatin1Char('+') || c == QLatin1Char('.') || c == QLatin1Char('^') || c == QLatin1Char('$'))
+        {
+            flush();
+        }
+        else
+        {
+            run.append(c);
+        }
+    }
+    flush();
+    return literals;
+}
+
+QVector<TextIndex::Trigram> TextIndex::trigrams(const QString &text)
+{
+    const QString folded = text.toCaseFolded();
+    QVector<Trigram> result;
+    if (folded.size() < 3)
+    {
+        return result;
+    }
+
+    result.reserve(folded.size() - 2);
+    const QChar *data = folded.constData();
+    for (int i = 0; i + 2 < folded.size(); ++i)
+    {
+        result.push_back((Trigram(data[i].unicode()) << 32) | (Trigram(data[i + 1].unicode()) << 16) | Trigram(data[i + 2].unicode()));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QVector<int> TextIndex::candidates(const Query &query, bool *all_rows) const
+{
+    const QStringList literals = query.mode == Mode::Substring ? QStringList{query.pattern}
+                                                               : required_literals(query.pattern);
+    QVector<Trigram> required;
+    for (const QString &literal : literals)
+    {
+        required += trigrams(literal);
+    }
+    std::sort(required.begin(), required.end());
+    required.erase(std::unique(required.begin(), required.end()), required.end());
+
+    // Queries shorter than a trigram have nothing to narrow by.
+    *all_rows = required.isEmpty();
+    if (*all_rows)
+    {
+        return {};
+    }
+
+    QVector<const QVector<int> *> lists;
+    lists.reserve(required.size());
+    for (const Trigram trigram : required)
+    {
+        const auto it = postings_.constFind(trigram);
+        if (it == postings_.constEnd())
+        {
+            return {};
+        }
+        lists.push_back(&it.value());
+    }
+
+    // Intersect from the rarest trigram up so the working set only shrinks.
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) { return a->size() < b->size(); });
+    QVector<int> rows = *lists.first();
+    for (int i = 1; i < lists.size() && !rows.isEmpty(); ++i)
+    {
+        QVector<int> narrowed;
+        narrowed.reserve(rows.size());
+        std::set_intersection(rows.cbegin(), rows.cend(), lists.at(i)->cbegin(), lists.at(i)->cend(), std::back_inserter(narrowed));
+        rows.swap(narrowed);
+    }
+    return rows;
+}
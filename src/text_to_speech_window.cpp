@@ -1,6 +1,14 @@
 #include "text_to_speech_window.h"
 
 #include "audio.h"
+#include "audio_probe.h"
+#include "executor.h"
+#include "logger.h"
+#include "loudness.h"
+#include "provider_catalog.h"
+#include "timeline_mixer.h"
+#include "trace.h"
+#include "translator.h"
 
 #include <algorithm>
 #include <cmath>
@@ -10,20 +18,46 @@
 #include <QComboBox>
 #include <QDateTime>
 #include <QDir>
+#include <QDoubleSpinBox>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QHash>
 #include <QHeaderView>
+#include <QJsonObject>
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QPlainTextEdit>
+#include <QPointer>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QRegularExpression>
+#include <QSignalBlocker>
 #include <QSlider>
 #include <QSpinBox>
 #include <QTableWidgetItem>
 #include <QTime>
 #include <QtGlobal>
 
+namespace
+{
+constexpr int kMaxConcurrentConversions = 4;
+// Translation providers throttle separately from speech ones, so a dub keeps
+// this many rows translating while the conversions run.
+constexpr int kMaxConcurrentTranslations = 4;
+
+// Swaps in a refreshed list without losing the user's pick when it survives.
+void replaceComboItems(QComboBox *combo, const QStringList &items)
+{
+    const QString current = combo->currentText();
+    const QSignalBlocker blocker(combo);
+    combo->clear();
+    combo->addItems(items);
+    const int index = combo->findText(current);
+    combo->setCurrentIndex(index == -1 ? 0 : index);
+}
+} // namespace
+
 TextToSpeechWindow::TextToSpeechWindow(QWidget *parent)
     : QDialog(parent), ui(std::make_unique<Ui::TextToSpeechWindow>())
 {
@@ -33,6 +67,8 @@ TextToSpeechWindow::TextToSpeechWindow(QWidget *parent)
     connect(ui->btnCancle, &QPushButton::clicked, this, &TextToSpeechWindow::close);
     connect(ui->pushButtonOutputDir, &QPushButton::clicked, this, &TextToSpeechWindow::select_output_directory);
     connect(ui->btnConvertAll, &QPushButton::clicked, this, &TextToSpeechWindow::convert_all_rows);
+    connect(ui->btnExportTrack, &QPushButton::clicked, this, &TextToSpeechWindow::export_track);
+    connect(ui->btnNormalizeLoudness, &QPushButton::clicked, this, &TextToSpeechWindow::normalize_all_clips);
 
     auto *header = ui->textTable->horizontalHeader();
     header->setSectionResizeMode(0, QHeaderView::Stretch);
@@ -46,10 +82,16 @@ TextToSpeechWindow::TextToSpeechWindow(QWidget *parent)
     init_elevenlabs_settings();
 }
 
-TextToSpeechWindow::~TextToSpeechWindow() = default;
+TextToSpeechWindow::~TextToSpeechWindow()
+{
+    // Rows still queued on the executor are dropped; running ones finish
+    // their clip, and their results are discarded.
+    conversionCancel_.cancel();
+}
 
 void TextToSpeechWindow::init_general_settings()
 {
+    SRT_TRACE_SCOPE("TextToSpeechWindow::init_general_settings");
     const QString provider = settings.value(QStringLiteral("ai/audio/provider"), QStringLiteral("ElevenLabs")).toString();
 
     QList<QString> voices;
@@ -57,11 +99,41 @@ void TextToSpeechWindow::init_general_settings()
 
     const bool useElevenLabs = provider.compare(QStringLiteral("ElevenLabs"), Qt::CaseInsensitive) == 0;
     const QString token = settings.value(QStringLiteral("ai/audio/apiKey")).toString();
-    if (useElevenLabs)
+    if (useElevenLabs && !token.trimmed().isEmpty())
+    {
+        // Open from the catalog cache; stale or missing lists are fetched in
+        // the background and swapped in when they arrive.
+        ProviderCatalog &catalog = ProviderCatalog::instance();
+        const QString voicesKey = ProviderCatalog::make_key(provider, QStringLiteral("voices"), token);
+        const QString modelsKey = ProviderCatalog::make_key(provider, QStringLiteral("models"), token);
+        voices = catalog.cached(voicesKey);
+        models = catalog.cached(modelsKey);
+
+        connect(&catalog, &ProviderCatalog::updated, this, [this, voicesKey, modelsKey](const QString &key, const QStringList &items) {
+            if (key == voicesKey)
+            {
+                replaceComboItems(ui->comboBoxVoices, items);
+            }
+            else if (key == modelsKey)
+            {
+                replaceComboItems(ui->comboBoxModels, items);
+            }
+        });
+        catalog.refresh(voicesKey, [token]() {
+            Audio audio;
+            return audio.elevenlabs_get_voices(token, true);
+        });
+        catalog.refresh(modelsKey, [token]() {
+            Audio audio;
+            return audio.elevenlabs_get_models(token, true);
+        });
+    }
+    else if (SpeechRenderer::is_local_provider(provider))
     {
-        Audio audio;
-        voices = audio.elevenlabs_get_voices(token);
-        models = audio.elevenlabs_get_models(token);
+        // The voice is baked into the configured model file.
+        const QString localModel = settings.value(QStringLiteral("tts/local/model")).toString();
+        voices = {QFileInfo(localModel).completeBaseName()};
+        models = {QStringLiteral("piper")};
     }
 
     if (voices.isEmpty())
@@ -109,6 +181,53 @@ void TextToSpeechWindow::init_general_settings()
         settings.sync();
     });
 
+    const QString trimKey = QStringLiteral("tts/trim/enabled");
+    const QString trimThresholdKey = QStringLiteral("tts/trim/threshold_db");
+    ui->checkBoxTrimSilence->setChecked(settings.value(trimKey, false).toBool());
+    ui->doubleSpinBoxTrimThreshold->setValue(settings.value(trimThresholdKey, -45.0).toDouble());
+
+    connect(ui->checkBoxTrimSilence, &QCheckBox::toggled, this, [this, trimKey](bool checked) {
+        settings.setValue(trimKey, checked);
+        settings.sync();
+    });
+
+    connect(ui->doubleSpinBoxTrimThreshold, qOverload<double>(&QDoubleSpinBox::valueChanged), this, [this, trimThresholdKey](double value) {
+        settings.setValue(trimThresholdKey, value);
+        settings.sync();
+    });
+
+    const QString fitToSlotKey = QStringLiteral("tts/general/fit_to_slot");
+    const QString maxStretchKey = QStringLiteral("tts/general/max_stretch_ratio");
+    ui->checkBoxFitToSlot->setChecked(settings.value(fitToSlotKey, false).toBool());
+    ui->doubleSpinBoxMaxStretch->setValue(settings.value(maxStretchKey, 1.3).toDouble());
+    ui->doubleSpinBoxMaxStretch->setEnabled(ui->checkBoxFitToSlot->isChecked());
+
+    connect(ui->checkBoxFitToSlot, &QCheckBox::toggled, this, [this, fitToSlotKey](bool checked) {
+        ui->doubleSpinBoxMaxStretch->setEnabled(checked);
+        settings.setValue(fitToSlotKey, checked);
+        settings.sync();
+    });
+
+    connect(ui->doubleSpinBoxMaxStretch, qOverload<double>(&QDoubleSpinBox::valueChanged), this, [this, maxStretchKey](double value) {
+        settings.setValue(maxStretchKey, value);
+        settings.sync();
+    });
+
+    const QString normalizeKey = QStringLiteral("tts/loudness/enabled");
+    const QString targetLufsKey = QStringLiteral("tts/loudness/target_lufs");
+    ui->checkBoxNormalizeLoudness->setChecked(settings.value(normalizeKey, false).toBool());
+    ui->doubleSpinBoxTargetLufs->setValue(settings.value(targetLufsKey, -16.0).toDouble());
+
+    connect(ui->checkBoxNormalizeLoudness, &QCheckBox::toggled, this, [this, normalizeKey](bool checked) {
+        settings.setValue(normalizeKey, checked);
+        settings.sync();
+    });
+
+    connect(ui->doubleSpinBoxTargetLufs, qOverload<double>(&QDoubleSpinBox::valueChanged), this, [this, targetLufsKey](double value) {
+        settings.setValue(targetLufsKey, value);
+        settings.sync();
+    });
+
     const QString outputDirKey = QStringLiteral("tts/general/output_directory");
     outputDirectory_ = settings.value(outputDirKey).toString();
 
@@ -205,9 +324,21 @@ void TextToSpeechWindow::update_speed_label(int value)
 
 void TextToSpeechWindow::set_entries(const QVector<Entry> &entries)
 {
+    SRT_TRACE_SCOPE("TextToSpeechWindow::set_entries");
     ui->textTable->clearContents();
     ui->textTable->setRowCount(entries.size());
 
+    startTimes_.clear();
+    startTimes_.reserve(entries.size());
+    slotDurations_.clear();
+    slotDurations_.reserve(entries.size());
+    for (const Entry &entry : entries)
+    {
+        startTimes_.push_back(entry.startMs);
+        slotDurations_.push_back(entry.slotMs);
+    }
+
+    QStringList clipPaths;
     for (int row = 0; row < entries.size(); ++row)
     {
         const Entry &entry = entries.at(row);
@@ -224,6 +355,10 @@ void TextToSpeechWindow::set_entries(const QVector<Entry> &entries)
         ui->textTable->setItem(row, 0, createItem(entry.text, false));
         ui->textTable->setItem(row, 1, createItem(entry.duration, true));
         ui->textTable->setItem(row, 2, createItem(entry.filePath, false));
+        if (!entry.filePath.isEmpty())
+        {
+            clipPaths.append(entry.filePath);
+        }
 
         if (QWidget *existing = ui->textTable->cellWidget(row, 3))
         {
@@ -240,6 +375,38 @@ void TextToSpeechWindow::set_entries(const QVector<Entry> &entries)
             }
         });
     }
+
+    // Rows that already have a clip show its real length once the probe,
+    // which reads every clip's headers, comes back.
+    const int generation = ++clipProbeGeneration_;
+    if (clipPaths.isEmpty())
+    {
+        return;
+    }
+    const QPointer<TextToSpeechWindow> self(this);
+    Executor::instance().submit([self, generation, clipPaths]() {
+        const QHash<QString, double> durations = AudioProbe::probe_durations(clipPaths);
+        postToGui(self, [self, generation, durations]() { self->apply_clip_durations(generation, durations); });
+    }, Executor::Priority::Normal, conversionCancel_);
+}
+
+void TextToSpeechWindow::apply_clip_durations(int generation, const QHash<QString, double> &durations)
+{
+    if (generation != clipProbeGeneration_)
+    {
+        return;
+    }
+
+    for (int row = 0; row < ui->textTable->rowCount(); ++row)
+    {
+        // A row converted meanwhile holds a new clip and its length already.
+        const QTableWidgetItem *fileItem = ui->textTable->item(row, 2);
+        const double clipSeconds = fileItem ? durations.value(fileItem->text(), -1.0) : -1.0;
+        if (clipSeconds > 0.0)
+        {
+            update_table_cell(row, 1, format_duration(clipSeconds));
+        }
+    }
 }
 
 QVector<TextToSpeechWindow::Entry> TextToSpeechWindow::entries() const
@@ -250,25 +417,48 @@ QVector<TextToSpeechWindow::Entry> TextToSpeechWindow::entries() const
 
     for (int row = 0; row < rowCount; ++row)
     {
-        Entry entry;
+        rows.push_back(entry(row));
+    }
 
-        if (QTableWidgetItem *textItem = ui->textTable->item(row, 0))
-        {
-            entry.text = textItem->text();
-        }
-        if (QTableWidgetItem *durationItem = ui->textTable->item(row, 1))
-        {
-            entry.duration = durationItem->text();
-        }
-        if (QTableWidgetItem *fileItem = ui->textTable->item(row, 2))
-        {
-            entry.filePath = fileItem->text();
-        }
+    return rows;
+}
 
-        rows.push_back(entry);
+TextToSpeechWindow::Entry TextToSpeechWindow::entry(int row) const
+{
+    Entry entry;
+    if (row < 0 || row >= ui->textTable->rowCount())
+    {
+        return entry;
     }
 
-    return rows;
+    if (QTableWidgetItem *textItem = ui->textTable->item(row, 0))
+    {
+        entry.text = textItem->text();
+    }
+    if (QTableWidgetItem *durationItem = ui->textTable->item(row, 1))
+    {
+        entry.duration = durationItem->text();
+    }
+    if (QTableWidgetItem *fileItem = ui->textTable->item(row, 2))
+    {
+        entry.filePath = fileItem->text();
+    }
+    entry.startMs = startTimes_.value(row, -1);
+    entry.slotMs = slotDurations_.value(row, -1);
+    return entry;
+}
+
+void TextToSpeechWindow::set_translation(const Translation &translation)
+{
+    translation_ = translation;
+    translatedRows_.clear();
+    setWindowTitle(tr("Dub into %1").arg(QString::fromStdString(translation_.targetLanguage)));
+    ui->btnConvertAll->setText(tr("Translate && Convert All"));
+}
+
+bool TextToSpeechWindow::is_dubbing() const
+{
+    return !translation_.provider.isEmpty();
 }
 
 void TextToSpeechWindow::refresh_output_directory_button()
@@ -319,23 +509,17 @@ bool TextToSpeechWindow::ensure_output_directory_selected()
     return false;
 }
 
-QString TextToSpeechWindow::generate_output_file_path(const QString &text, int row) const
+QString TextToSpeechWindow::generate_output_file_path(const QString &text, int row)
 {
     if (outputDirectory_.isEmpty())
     {
         return {};
     }
 
-    QString extension = ui->comboBoxOutputType->currentText().trimmed();
-    if (extension.startsWith(QLatin1Char('.')))
-    {
-        extension.remove(0, 1);
-    }
-    if (extension.isEmpty())
-    {
-        extension = QStringLiteral("mp3");
-    }
-    extension = extension.toLower();
+    // The provider encodes to whatever the extension names, so it must be
+    // one the provider can actually produce.
+    const QString provider = settings.value(QStringLiteral("ai/audio/provider"), QStringLiteral("ElevenLabs")).toString();
+    const QString extension = Audio::output_extension(provider, ui->comboBoxOutputType->currentText());
 
     QString slug = text.simplified();
     slug = slug.left(40);
@@ -352,14 +536,52 @@ QString TextToSpeechWindow::generate_output_file_path(const QString &text, int r
     QDir dir(outputDirectory_);
     QString candidate = dir.filePath(QStringLiteral("%1.%2").arg(baseName, extension));
     int counter = 1;
-    while (QFile::exists(candidate))
+    // Paths handed to conversions that have not written their file yet are
+    // taken as well, so a batch never assigns one path to two rows.
+    while (QFile::exists(candidate) || reservedOutputPaths_.contains(candidate))
     {
         candidate = dir.filePath(QStringLiteral("%1_%2.%3").arg(baseName).arg(counter++).arg(extension));
     }
 
+    reservedOutputPaths_.insert(candidate);
     return candidate;
 }
 
+TtsCache::Key TextToSpeechWindow::make_cache_key(const QString &text,
+                                                  const QString &provider,
+                                                  const QString &voice,
+                                                  const QString &model) const
+{
+    TtsCache::Key key;
+    key.text = text;
+    key.provider = provider;
+    key.voice = voice;
+    key.model = model;
+    key.outputFormat = Audio::output_extension(provider, ui->comboBoxOutputType->currentText());
+    key.speed = ui->horizontalSliderSpeed->value();
+
+    if (SpeechRenderer::is_local_provider(provider))
+    {
+        // The combo only shows the model name; key on the file itself.
+        key.voice = settings.value(QStringLiteral("tts/local/model")).toString();
+    }
+    else if (provider.compare(QStringLiteral("ElevenLabs"), Qt::CaseInsensitive) == 0)
+    {
+        key.voiceSettings = QJsonObject{
+            {QStringLiteral("language_code"), ui->lineEditLanguageCode->text().trimmed()},
+            {QStringLiteral("stability"), ui->spinBoxStability->value()},
+            {QStringLiteral("similarity_boost"), ui->spinBoxSimilarityBoost->value()},
+            {QStringLiteral("style"), ui->spinBoxStyle->value()},
+            {QStringLiteral("use_speaker_boost"), ui->checkBoxUseSpeakerBoost->isChecked()},
+            {QStringLiteral("improve_previous"), ui->checkBoxImproveByPrevious->isChecked()},
+            {QStringLiteral("improve_next"), ui->checkBoxImproveByNext->isChecked()},
+            {QStringLiteral("text_normalization"), ui->checkBoxApplyTextNormalization->isChecked()},
+            {QStringLiteral("language_text_normalization"), ui->checkBoxApplyLanguageTextNormalization->isChecked()}};
+    }
+
+    return key;
+}
+
 void TextToSpeechWindow::update_table_cell(int row, int column, const QString &value)
 {
     if (row < 0 || row >= ui->textTable->rowCount())
@@ -420,16 +642,38 @@ int TextToSpeechWindow::row_for_button(const QWidget *button) const
     return -1;
 }
 
-void TextToSpeechWindow::convert_row(int row, bool warn_if_text_missing)
+bool TextToSpeechWindow::check_speech_provider()
+{
+    const QString provider = settings.value(QStringLiteral("ai/audio/provider"), QStringLiteral("ElevenLabs")).toString();
+    if (!SpeechRenderer::is_supported_provider(provider))
+    {
+        QMessageBox::warning(this,
+                             tr("Unsupported provider"),
+                             tr("Audio provider \"%1\" is not supported.").arg(provider));
+        return false;
+    }
+
+    const QString token = settings.value(QStringLiteral("ai/audio/apiKey")).toString().trimmed();
+    if (token.isEmpty() && !SpeechRenderer::is_local_provider(provider))
+    {
+        QMessageBox::warning(this,
+                             tr("Missing API key"),
+                             tr("Please configure an API key in Settings ▸ Audio before converting."));
+        return false;
+    }
+    return true;
+}
+
+bool TextToSpeechWindow::prepare_conversion(int row, bool warn_if_text_missing, ConversionJob *job)
 {
     if (row < 0 || row >= ui->textTable->rowCount())
     {
-        return;
+        return false;
     }
 
     if (!ensure_output_directory_selected())
     {
-        return;
+        return false;
     }
 
     QTableWidgetItem *textItem = ui->textTable->item(row, 0);
@@ -442,66 +686,358 @@ void TextToSpeechWindow::convert_row(int row, bool warn_if_text_missing)
                                      tr("Nothing to convert"),
                                      tr("Row %1 does not contain any text.").arg(row + 1));
         }
-        return;
+        return false;
     }
 
-    const QString token = settings.value(QStringLiteral("ai/audio/apiKey")).toString().trimmed();
-    if (token.isEmpty())
+    if (!check_speech_provider())
     {
-        QMessageBox::warning(this,
-                             tr("Missing API key"),
-                             tr("Please configure an API key in Settings ▸ Audio before converting."));
-        return;
+        return false;
     }
 
     const QString provider = settings.value(QStringLiteral("ai/audio/provider"), QStringLiteral("ElevenLabs")).toString();
-    const QString voice = ui->comboBoxVoices->currentText();
-    const QString model = ui->comboBoxModels->currentText();
+    const QString token = settings.value(QStringLiteral("ai/audio/apiKey")).toString().trimmed();
     const QString filePath = generate_output_file_path(text, row);
     if (filePath.isEmpty())
     {
-        return;
+        return false;
     }
 
-    Audio audio;
-    const std::string nativeFilePath = QDir::toNativeSeparators(filePath).toStdString();
-    const std::string tokenStd = token.toStdString();
+    job->row = row;
+    job->text = text;
+    job->provider = provider;
+    job->voice = ui->comboBoxVoices->currentText();
+    job->model = ui->comboBoxModels->currentText();
+    job->token = token;
+    job->filePath = filePath;
+    job->speed = ui->horizontalSliderSpeed->value() / 100.0;
+    job->cacheKey = make_cache_key(text, provider, job->voice, job->model);
+    job->trimSilence = ui->checkBoxTrimSilence->isChecked();
+    job->trimThresholdDb = ui->doubleSpinBoxTrimThreshold->value();
+    job->slotMs = slotDurations_.value(row, -1);
+    job->fitToSlot = ui->checkBoxFitToSlot->isChecked();
+    job->maxStretchRatio = ui->doubleSpinBoxMaxStretch->value();
+    job->normalizeLoudness = ui->checkBoxNormalizeLoudness->isChecked();
+    job->targetLufs = ui->doubleSpinBoxTargetLufs->value();
+    return true;
+}
 
-    if (provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
+void TextToSpeechWindow::set_row_busy(int row, bool busy)
+{
+    if (auto *button = qobject_cast<QPushButton *>(ui->textTable->cellWidget(row, 3)))
     {
-        audio.openai_text_to_speech(text, nativeFilePath, voice, model, tokenStd);
+        button->setEnabled(!busy);
+        button->setText(busy ? tr("Converting...") : tr("Convert"));
     }
-    else if (provider.compare(QStringLiteral("ElevenLabs"), Qt::CaseInsensitive) == 0)
+}
+
+void TextToSpeechWindow::start_conversion(const ConversionJob &job, Executor::Priority priority)
+{
+    ++conversionsInFlight_;
+    set_row_busy(job.row, true);
+    emit conversion_started(job.row);
+
+    const QPointer<TextToSpeechWindow> self(this);
+    Executor::io().submit([self, job]() {
+        const double seconds = SpeechRenderer::render(job);
+        postToGui(self, [self, job, seconds]() { self->finish_conversion(job, seconds); });
+    }, priority, conversionCancel_);
+}
+
+void TextToSpeechWindow::finish_conversion(const ConversionJob &job, double seconds)
+{
+    --conversionsInFlight_;
+    reservedOutputPaths_.remove(job.filePath);
+    set_row_busy(job.row, false);
+
+    if (seconds >= 0.0)
     {
-        audio.elevenlabs_text_to_speech(text, nativeFilePath, voice, model, tokenStd);
+        SRT_LOG_DEBUG("tts", "row {} converted, {} s of speech", job.row + 1, seconds);
+        update_table_cell(job.row, 2, QDir::toNativeSeparators(job.filePath));
+        update_table_cell(job.row, 1, format_duration(seconds));
     }
     else
     {
-        QMessageBox::warning(this,
-                             tr("Unsupported provider"),
-                             tr("Audio provider \"%1\" is not supported.").arg(provider));
+        SRT_LOG_WARN("tts", "row {} conversion failed", job.row + 1);
+    }
+    emit conversion_finished(job.row, seconds >= 0.0);
+
+    start_queued_conversions();
+    finish_batch_if_idle();
+}
+
+void TextToSpeechWindow::start_queued_conversions()
+{
+    // Providers throttle concurrent requests per key, so only a few rows are
+    // in flight at once; each completion starts the next queued row.
+    while (!conversionQueue_.isEmpty() && conversionsInFlight_ < kMaxConcurrentConversions)
+    {
+        start_conversion(conversionQueue_.takeFirst(), Executor::Priority::Normal);
+    }
+}
+
+void TextToSpeechWindow::start_translation(int row, Executor::Priority priority)
+{
+    const QTableWidgetItem *textItem = ui->textTable->item(row, 0);
+    const QString source = textItem ? textItem->text().trimmed() : QString();
+    if (source.isEmpty())
+    {
         return;
     }
 
-    if (!QFile::exists(filePath))
+    ++translationsInFlight_;
+    set_row_busy(row, true);
+
+    const QPointer<TextToSpeechWindow> self(this);
+    const Translation translation = translation_;
+    Executor::io().submit([self, row, source, translation]() {
+        Translator translator;
+        QString error;
+        const QString translated = translator.translate(translation.provider, source, translation.sourceLanguage, translation.targetLanguage, translation.token, &error);
+        postToGui(self, [self, row, translated, error]() { self->finish_translation(row, translated, error); });
+    }, priority, conversionCancel_);
+}
+
+void TextToSpeechWindow::finish_translation(int row, const QString &translated, const QString &error)
+{
+    --translationsInFlight_;
+    set_row_busy(row, false);
+
+    // A row may translate to itself (a name, a number), so only the
+    // translator's error marks a failure.
+    const QString text = translated.trimmed();
+    const bool succeeded = error.isEmpty() && !text.isEmpty();
+    const bool showError = !error.isEmpty() && !translationErrorShown_;
+    if (showError)
     {
+        translationErrorShown_ = true;
+    }
+    if (succeeded)
+    {
+        translatedRows_.insert(row);
+        update_table_cell(row, 0, text);
+        update_table_cell(row, 1, QString());
+        update_table_cell(row, 2, QString());
+    }
+    else
+    {
+        SRT_LOG_WARN("tts", "row {} translation failed, not speaking it", row + 1);
+    }
+    emit row_translated(row, succeeded);
+
+    // The row goes straight to the speech stage instead of waiting for the
+    // rest of the translations.
+    ConversionJob job;
+    if (succeeded && prepare_conversion(row, false, &job))
+    {
+        conversionQueue_.push_back(job);
+        start_queued_conversions();
+    }
+
+    while (!translationQueue_.isEmpty() && translationsInFlight_ < kMaxConcurrentTranslations)
+    {
+        start_translation(translationQueue_.takeFirst(), Executor::Priority::Normal);
+    }
+    finish_batch_if_idle();
+
+    // Last, because the dialog's event loop delivers the other rows' results.
+    if (showError)
+    {
+        QMessageBox::warning(this, tr("Translation failed"), error);
+    }
+}
+
+void TextToSpeechWindow::finish_batch_if_idle()
+{
+    if (conversionQueue_.isEmpty() && conversionsInFlight_ == 0 && translationQueue_.isEmpty() && translationsInFlight_ == 0)
+    {
+        translationErrorShown_ = false;
+        ui->btnConvertAll->setEnabled(true);
+        // The clip cache writes its index only every few seconds while
+        // clips are stored; write what this batch left.
+        Executor::instance().submit([]() { TtsCache::instance().save(); }, Executor::Priority::Low);
+        emit batch_finished();
+    }
+}
+
+void TextToSpeechWindow::convert_row(int row, bool warn_if_text_missing)
+{
+    if (is_dubbing() && !translatedRows_.contains(row))
+    {
+        if (ensure_output_directory_selected() && check_speech_provider())
+        {
+            start_translation(row, Executor::Priority::High);
+        }
         return;
     }
 
-    update_table_cell(row, 2, QDir::toNativeSeparators(filePath));
-    const double durationSeconds = audio.get_audio_duration_seconds(nativeFilePath);
-    update_table_cell(row, 1, format_duration(durationSeconds));
+    ConversionJob job;
+    if (prepare_conversion(row, warn_if_text_missing, &job))
+    {
+        // A click on one row jumps ahead of a running batch.
+        start_conversion(job, Executor::Priority::High);
+    }
 }
 
 void TextToSpeechWindow::convert_all_rows()
 {
-    if (!ensure_output_directory_selected())
+    SRT_TRACE_SCOPE("TextToSpeechWindow::convert_all_rows");
+    if (!ensure_output_directory_selected() || !check_speech_provider())
+    {
+        return;
+    }
+
+    for (int row = 0; row < ui->textTable->rowCount(); ++row)
+    {
+        const QTableWidgetItem *textItem = ui->textTable->item(row, 0);
+        if (is_dubbing() && !translatedRows_.contains(row) && textItem && !textItem->text().trimmed().isEmpty())
+        {
+            translationQueue_.push_back(row);
+            continue;
+        }
+
+        ConversionJob job;
+        if (prepare_conversion(row, false, &job))
+        {
+            conversionQueue_.push_back(job);
+        }
+    }
+    if (conversionQueue_.isEmpty() && translationQueue_.isEmpty())
     {
         return;
     }
 
+    // Both stages run at once: translations under their own cap, and every
+    // finished translation joins the conversion queue right away. Per
+    // provider rate limits are applied underneath by ProviderScheduler.
+    ui->btnConvertAll->setEnabled(false);
+    while (!translationQueue_.isEmpty() && translationsInFlight_ < kMaxConcurrentTranslations)
+    {
+        start_translation(translationQueue_.takeFirst(), Executor::Priority::Normal);
+    }
+    start_queued_conversions();
+}
+
+void TextToSpeechWindow::normalize_all_clips()
+{
+    QStringList clipPaths;
     for (int row = 0; row < ui->textTable->rowCount(); ++row)
     {
-        convert_row(row, false);
+        const QTableWidgetItem *fileItem = ui->textTable->item(row, 2);
+        if (fileItem && !fileItem->text().isEmpty())
+        {
+            clipPaths.append(QDir::fromNativeSeparators(fileItem->text()));
+        }
+    }
+    clipPaths.removeDuplicates();
+
+    if (clipPaths.isEmpty())
+    {
+        QMessageBox::information(this,
+                                 tr("Nothing to normalize"),
+                                 tr("Convert at least one row before normalizing loudness."));
+        return;
+    }
+
+    // Measuring and rewriting every clip takes seconds on a long project, so
+    // it runs on the executor and the button stays off until it is done.
+    ui->btnNormalizeLoudness->setEnabled(false);
+    const double targetLufs = ui->doubleSpinBoxTargetLufs->value();
+    const QPointer<TextToSpeechWindow> self(this);
+    Executor::instance().submit([self, clipPaths, targetLufs]() {
+        const Loudness::Report report = Loudness::normalize_files(clipPaths, targetLufs, SpeechRenderer::kTruePeakCeilingDbtp);
+        const int clipCount = clipPaths.size();
+        postToGui(self, [self, report, clipCount, targetLufs]() { self->finish_normalization(report, clipCount, targetLufs); });
+    }, Executor::Priority::Normal);
+}
+
+void TextToSpeechWindow::finish_normalization(const Loudness::Report &report, int clipCount, double targetLufs)
+{
+    ui->btnNormalizeLoudness->setEnabled(true);
+
+    QString summary = tr("Adjusted %1 of %2 clips to %3 LUFS.")
+                          .arg(report.adjusted)
+                          .arg(clipCount)
+                          .arg(targetLufs, 0, 'f', 1);
+    if (report.skipped > 0)
+    {
+        summary += QStringLiteral("\n") + tr("%1 clips were already on target, silent, or not WAV.").arg(report.skipped);
+    }
+    if (report.failed > 0)
+    {
+        summary += QStringLiteral("\n") + tr("%1 clips could not be rewritten.").arg(report.failed);
+    }
+    QMessageBox::information(this, tr("Loudness normalized"), summary);
+}
+
+void TextToSpeechWindow::export_track()
+{
+    QVector<TimelineMixer::Cue> cues;
+    QString firstClip;
+    for (int row = 0; row < ui->textTable->rowCount(); ++row)
+    {
+        const QTableWidgetItem *fileItem = ui->textTable->item(row, 2);
+        const qint64 startMs = startTimes_.value(row, -1);
+        if (!fileItem || fileItem->text().isEmpty() || startMs < 0)
+        {
+            continue;
+        }
+
+        const QString clipPath = QDir::fromNativeSeparators(fileItem->text());
+        if (firstClip.isEmpty())
+        {
+            firstClip = clipPath;
+        }
+        cues.push_back(TimelineMixer::Cue{startMs, clipPath});
+    }
+
+    if (cues.isEmpty())
+    {
+        QMessageBox::information(this,
+                                 tr("Nothing to export"),
+                                 tr("Convert at least one row with a start time before exporting a track."));
+        return;
+    }
+
+    const bool clipsAreMp3 = QFileInfo(firstClip).suffix().compare(QStringLiteral("mp3"), Qt::CaseInsensitive) == 0;
+    const QString initialDir = outputDirectory_.isEmpty() ? QDir::homePath() : outputDirectory_;
+    const QString suggested = QDir(initialDir).filePath(clipsAreMp3 ? QStringLiteral("track.mp3") : QStringLiteral("track.wav"));
+    const QString filter = clipsAreMp3 ? tr("MP3 Audio (*.mp3);;WAV Audio (*.wav)") : tr("WAV Audio (*.wav);;MP3 Audio (*.mp3)");
+    const QString outputPath = QFileDialog::getSaveFileName(this, tr("Export Track"), suggested, filter);
+    if (outputPath.isEmpty())
+    {
+        return;
+    }
+
+    QProgressDialog progressDialog(tr("Assembling track..."), tr("Cancel"), 0, static_cast<int>(cues.size()), this);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(500);
+
+    const auto progress = [&progressDialog](int done, int total) {
+        Q_UNUSED(total);
+        progressDialog.setValue(done);
+        return !progressDialog.wasCanceled();
+    };
+
+    TimelineMixer::Report report;
+    const bool toMp3 = QFileInfo(outputPath).suffix().compare(QStringLiteral("mp3"), Qt::CaseInsensitive) == 0;
+    const bool ok = toMp3 ? TimelineMixer::concat_mp3(cues, outputPath, &report, progress)
+                          : TimelineMixer::mix_to_wav(cues, outputPath, &report, progress);
+    progressDialog.reset();
+
+    if (!ok)
+    {
+        QMessageBox::warning(this, tr("Export failed"), report.error);
+        return;
+    }
+
+    QString summary = tr("Placed %1 clips into %2.").arg(report.placed).arg(QDir::toNativeSeparators(outputPath));
+    if (report.skipped > 0)
+    {
+        summary += QStringLiteral("\n") + tr("%1 clips could not be read in the track format and were skipped.").arg(report.skipped);
+    }
+    if (report.overlapMs > 0)
+    {
+        summary += QStringLiteral("\n") + tr("Clips overran their cues by %1 ms in total.").arg(report.overlapMs);
     }
+    QMessageBox::information(this, tr("Track exported"), summary);
 }
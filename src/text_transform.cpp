@@ -0,0 +1,262 @@
+#include "text_transform.h"
+
+#include "parallel.h"
+#include "trace.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Rows per parallel task; a rule pass over one row is well under a
+// microsecond for literal rules, so tasks have to be coarse.
+constexpr int kChunkRows = 2048;
+
+QString sentenceCase(const QString &text)
+{
+    QString result = text.toLower();
+    bool sentenceStart = true;
+    for (QChar &c : result)
+    {
+        if (sentenceStart && c.isLetter())
+        {
+            c = c.toUpper();
+            sentenceStart = false;
+        }
+        else if (c == QLatin1Char('.') || c == QLatin1Char('!') || c == QLatin1Char('?'))
+        {
+            sentenceStart = true;
+        }
+        else if (c.isLetterOrNumber())
+        {
+            sentenceStart = false;
+        }
+    }
+    return result;
+}
+
+QString mapCase(const QString &text, TextTransform::Kind kind)
+{
+    switch (kind)
+    {
+    case TextTransform::Kind::Upper:
+        return text.toUpper();
+    case TextTransform::Kind::Lower:
+        return text.toLower();
+    case TextTransform::Kind::Sentence:
+        return sentenceCase(text);
+    default:
+        return text;
+    }
+}
+
+// Maps only the spans regex matches, leaving the rest of text as it is.
+QString mapMatches(const QString &text, const QRegularExpression &regex, TextTransform::Kind kind)
+{
+    QString mapped;
+    int last = 0;
+    QRegularExpressionMatchIterator matches = regex.globalMatch(text);
+    while (matches.hasNext())
+    {
+        const QRegularExpressionMatch match = matches.next();
+        mapped += text.mid(last, match.capturedStart() - last);
+        mapped += mapCase(match.captured(), kind);
+        last = match.capturedEnd();
+    }
+    if (last == 0)
+    {
+        return text;
+    }
+    mapped += text.mid(last);
+    return mapped;
+}
+
+bool isCaseKind(TextTransform::Kind kind)
+{
+    return kind == TextTransform::Kind::Upper || kind == TextTransform::Kind::Lower || kind == TextTransform::Kind::Sentence;
+}
+} // namespace
+
+TextTransform::TextTransform(const QVector<Rule> &rules)
+{
+    for (int i = 0; i < rules.size(); ++i)
+    {
+        const Rule &rule = rules.at(i);
+        if (!rule.enabled || (rule.find.isEmpty() && !isCaseKind(rule.kind)))
+        {
+            continue;
+        }
+
+        Step step{rule, QRegularExpression()};
+        if (rule.kind != Kind::Literal && !rule.find.isEmpty())
+        {
+            step.regex = QRegularExpression(rule.find,
+                                            rule.caseSensitive ? QRegularExpression::NoPatternOption
+                                                               : QRegularExpression::CaseInsensitiveOption);
+            if (!step.regex.isValid())
+            {
+                if (error_.isEmpty())
+                {
+                    error_ = QStringLiteral("Rule %1: %2").arg(i + 1).arg(step.regex.errorString());
+                }
+                continue;
+            }
+            // Compile now rather than in whichever worker gets there first.
+            step.regex.optimize();
+        }
+        steps_.push_back(step);
+    }
+}
+
+bool TextTransform::is_valid() const
+{
+    return error_.isEmpty();
+}
+
+QString TextTransform::error() const
+{
+    return error_;
+}
+
+QString TextTransform::apply(const QString &text) const
+{
+    QString result = text;
+    for (const Step &step : steps_)
+    {
+        const Rule &rule = step.rule;
+        switch (rule.kind)
+        {
+        case Kind::Literal:
+            result.replace(rule.find, rule.replace, rule.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+            break;
+        case Kind::Regex:
+            result.replace(step.regex, rule.replace);
+            break;
+        case Kind::Upper:
+        case Kind::Lower:
+        case Kind::Sentence:
+            result = rule.find.isEmpty() ? mapCase(result, rule.kind) : mapMatches(result, step.regex, rule.kind);
+            break;
+        }
+    }
+    return result;
+}
+
+QVector<TextTransform::Change> TextTransform::run(const QStringList &texts) const
+{
+    SRT_TRACE_SCOPE("TextTransform::run");
+    const int rowCount = static_cast<int>(texts.size());
+    const int chunkCount = (rowCount + kChunkRows - 1) / kChunkRows;
+    std::vector<QVector<Change>> chunkChanges(chunkCount);
+    parallelFor(chunkCount, [this, &texts, rowCount, &chunkChanges](int chunk) {
+        QVector<Change> &changes = chunkChanges[chunk];
+        const int end = std::min(rowCount, (chunk + 1) * kChunkRows);
+        for (int row = chunk * kChunkRows; row < end; ++row)
+        {
+            const QString &before = texts.at(row);
+            QString after = apply(before);
+            if (after != before)
+            {
+                changes.push_back(Change{row, before, std::move(after)});
+            }
+        }
+    });
+
+    QVector<Change> changes;
+    for (const QVector<Change> &chunk : chunkChanges)
+    {
+        changes += chunk;
+    }
+    return changes;
+}
+
+QVector<TextTransform::Preset> TextTransform::presets()
+{
+    const auto regex = [](const QString &find, const QString &replace, bool caseSensitive = true) {
+        Rule rule;
+        rule.kind = Kind::Regex;
+        rule.find = find;
+        rule.replace = replace;
+        rule.caseSensitive = caseSensitive;
+        return rule;
+    };
+
+    return {
+        {QStringLiteral("Remove hearing-impaired tags"), regex(QStringLiteral("\\[[^\\]]*\\]|\\([^)]*\\)"), QString())},
+        {QStringLiteral("Remove speaker labels"), regex(QStringLiteral("(?m)^[A-Z][A-Z0-9 .'-]*:\\s*"), QString())},
+        {QStringLiteral("Strip <i> tags"), regex(QStringLiteral("</?i>"), QString(), false)},
+        {QStringLiteral("Normalize ellipses"), regex(QStringLiteral("\\x{2026}|\\.{4,}"), QStringLiteral("..."))},
+        {QStringLiteral("Straighten double quotes"), regex(QStringLiteral("[\\x{201C}\\x{201D}\\x{201E}]"), QStringLiteral("\""))},
+        {QStringLiteral("Straighten single quotes"), regex(QStringLiteral("[\\x{2018}\\x{2019}]"), QStringLiteral("'"))},
+        {QStringLiteral("Collapse repeated spaces"), regex(QStringLiteral("[ \\t]{2,}"), QStringLiteral(" "))},
+        {QStringLiteral("Trim lines"), regex(QStringLiteral("(?m)^[ \\t]+|[ \\t]+$"), QString())},
+        {QStringLiteral("Remove empty lines"), regex(QStringLiteral("\\n\\s*(?=\\n)|^\\s*\\n|\\n\\s*$"), QString())},
+    };
+}
+
+QString TextTransform::kind_name(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::Literal:
+        return QStringLiteral("literal");
+    case Kind::Regex:
+        return QStringLiteral("regex");
+    case Kind::Upper:
+        return QStringLiteral("upper");
+    case Kind::Lower:
+        return QStringLiteral("lower");
+    case Kind::Sentence:
+        return QStringLiteral("sentence");
+    }
+    return QStringLiteral("literal");
+}
+
+TextTransform::Kind TextTransform::kind_from_name(const QString &name)
+{
+    for (const Kind kind : {Kind::Literal, Kind::Regex, Kind::Upper, Kind::Lower, Kind::Sentence})
+    {
+        if (kind_name(kind) == name)
+        {
+            return kind;
+        }
+    }
+    return Kind::Literal;
+}
+
+QByteArray TextTransform::to_json(const QVector<Rule> &rules)
+{
+    QJsonArray array;
+    for (const Rule &rule : rules)
+    {
+        array.append(QJsonObject{
+            {QStringLiteral("kind"), kind_name(rule.kind)},
+            {QStringLiteral("find"), rule.find},
+            {QStringLiteral("replace"), rule.replace},
+            {QStringLiteral("match_case"), rule.caseSensitive},
+            {QStringLiteral("enabled"), rule.enabled}});
+    }
+    return QJsonDocument(array).toJson(QJsonDocument::Compact);
+}
+
+QVector<TextTransform::Rule> TextTransform::from_json(const QByteArray &json)
+{
+    QVector<Rule> rules;
+    const QJsonArray array = QJsonDocument::fromJson(json).array();
+    for (const QJsonValue &value : array)
+    {
+        const QJsonObject object = value.toObject();
+        Rule rule;
+        rule.kind = kind_from_name(object.value(QStringLiteral("kind")).toString());
+        rule.find = object.value(QStringLiteral("find")).toString();
+        rule.replace = object.value(QStringLiteral("replace")).toString();
+        rule.caseSensitive = object.value(QStringLiteral("match_case")).toBool(true);
+        rule.enabled = object.value(QStringLiteral("enabled")).toBool(true);
+        rules.push_back(rule);
+    }
+    return rules;
+}
@@ -0,0 +1,255 @@
+#include "text_transform_window.h"
+
+#include "logger.h"
+#include "trace.h"
+
+#include <QApplication>
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidgetItem>
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+enum RuleColumn
+{
+    kEnabledColumn = 0,
+    kTypeColumn = 1,
+    kFindColumn = 2,
+    kReplaceColumn = 3,
+    kMatchCaseColumn = 4
+};
+
+// Filling the preview table costs far more than computing it, and nobody
+// reads past the first screens anyway.
+constexpr int kPreviewRowLimit = 2000;
+
+const QString kRulesKey = QStringLiteral("transform/rules");
+
+QTableWidgetItem *checkCell(bool checked)
+{
+    auto *item = new QTableWidgetItem();
+    item->setFlags((item->flags() | Qt::ItemIsUserCheckable) & ~Qt::ItemIsEditable);
+    item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    return item;
+}
+
+QTableWidgetItem *readOnlyCell(const QString &text)
+{
+    auto *item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    return item;
+}
+} // namespace
+
+TextTransformWindow::TextTransformWindow(QWidget *parent)
+    : QDialog(parent), ui(std::make_unique<Ui::TextTransformWindow>())
+{
+    ui->setupUi(this);
+
+    auto *rulesHeader = ui->rulesTable->horizontalHeader();
+    rulesHeader->setSectionResizeMode(kEnabledColumn, QHeaderView::ResizeToContents);
+    rulesHeader->setSectionResizeMode(kTypeColumn, QHeaderView::ResizeToContents);
+    rulesHeader->setSectionResizeMode(kFindColumn, QHeaderView::Stretch);
+    rulesHeader->setSectionResizeMode(kReplaceColumn, QHeaderView::Stretch);
+    rulesHeader->setSectionResizeMode(kMatchCaseColumn, QHeaderView::ResizeToContents);
+
+    auto *previewHeader = ui->previewTable->horizontalHeader();
+    previewHeader->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    previewHeader->setSectionResizeMode(1, QHeaderView::Stretch);
+    previewHeader->setSectionResizeMode(2, QHeaderView::Stretch);
+    ui->previewTable->verticalHeader()->setVisible(false);
+
+    for (const TextTransform::Preset &preset : TextTransform::presets())
+    {
+        ui->comboBoxPresets->addItem(preset.name);
+    }
+
+    connect(ui->btnAddRule, &QPushButton::clicked, this, &TextTransformWindow::add_rule);
+    connect(ui->btnRemoveRule, &QPushButton::clicked, this, &TextTransformWindow::remove_rule);
+    connect(ui->btnAddPreset, &QPushButton::clicked, this, &TextTransformWindow::add_preset);
+    connect(ui->btnPreview, &QPushButton::clicked, this, &TextTransformWindow::preview);
+    connect(ui->btnApply, &QPushButton::clicked, this, &TextTransformWindow::apply);
+    connect(ui->btnCancel, &QPushButton::clicked, this, &QDialog::reject);
+
+    for (const TextTransform::Rule &rule : TextTransform::from_json(settings.value(kRulesKey).toString().toUtf8()))
+    {
+        add_rule_row(rule);
+    }
+    connect(ui->rulesTable, &QTableWidget::itemChanged, this, &TextTransformWindow::rules_edited);
+}
+
+TextTransformWindow::~TextTransformWindow() = default;
+
+void TextTransformWindow::set_texts(const QStringList &texts)
+{
+    texts_ = texts;
+    changes_.clear();
+    previewCurrent_ = false;
+}
+
+QVector<TextTransform::Change> TextTransformWindow::changes() const
+{
+    return changes_;
+}
+
+void TextTransformWindow::add_rule_row(const TextTransform::Rule &rule)
+{
+    const int row = ui->rulesTable->rowCount();
+    ui->rulesTable->insertRow(row);
+    ui->rulesTable->setItem(row, kEnabledColumn, checkCell(rule.enabled));
+    ui->rulesTable->setItem(row, kFindColumn, new QTableWidgetItem(rule.find));
+    ui->rulesTable->setItem(row, kReplaceColumn, new QTableWidgetItem(rule.replace));
+    ui->rulesTable->setItem(row, kMatchCaseColumn, checkCell(rule.caseSensitive));
+
+    auto *typeCombo = new QComboBox(ui->rulesTable);
+    typeCombo->addItem(tr("Literal"), TextTransform::kind_name(TextTransform::Kind::Literal));
+    typeCombo->addItem(tr("Regex"), TextTransform::kind_name(TextTransform::Kind::Regex));
+    typeCombo->addItem(tr("Upper case"), TextTransform::kind_name(TextTransform::Kind::Upper));
+    typeCombo->addItem(tr("Lower case"), TextTransform::kind_name(TextTransform::Kind::Lower));
+    typeCombo->addItem(tr("Sentence case"), TextTransform::kind_name(TextTransform::Kind::Sentence));
+    typeCombo->setCurrentIndex(typeCombo->findData(TextTransform::kind_name(rule.kind)));
+    typeCombo->setToolTip(tr("Case rules map what Find matches, or the whole text when Find is empty."));
+    ui->rulesTable->setCellWidget(row, kTypeColumn, typeCombo);
+    connect(typeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TextTransformWindow::rules_edited);
+
+    rules_edited();
+}
+
+void TextTransformWindow::add_rule()
+{
+    add_rule_row(TextTransform::Rule());
+    ui->rulesTable->setCurrentCell(ui->rulesTable->rowCount() - 1, kFindColumn);
+    ui->rulesTable->editItem(ui->rulesTable->item(ui->rulesTable->rowCount() - 1, kFindColumn));
+}
+
+void TextTransformWindow::remove_rule()
+{
+    QList<int> rows;
+    for (const QModelIndex &index : ui->rulesTable->selectionModel()->selectedRows())
+    {
+        rows.append(index.row());
+    }
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    for (const int row : rows)
+    {
+        ui->rulesTable->removeRow(row);
+    }
+    rules_edited();
+}
+
+void TextTransformWindow::add_preset()
+{
+    const QVector<TextTransform::Preset> presets = TextTransform::presets();
+    const int index = ui->comboBoxPresets->currentIndex();
+    if (index >= 0 && index < presets.size())
+    {
+        add_rule_row(presets.at(index).rule);
+    }
+}
+
+QVector<TextTransform::Rule> TextTransformWindow::rules() const
+{
+    QVector<TextTransform::Rule> rules;
+    for (int row = 0; row < ui->rulesTable->rowCount(); ++row)
+    {
+        TextTransform::Rule rule;
+        if (const auto *typeCombo = qobject_cast<const QComboBox *>(ui->rulesTable->cellWidget(row, kTypeColumn)))
+        {
+            rule.kind = TextTransform::kind_from_name(typeCombo->currentData().toString());
+        }
+        const QTableWidgetItem *enabledItem = ui->rulesTable->item(row, kEnabledColumn);
+        const QTableWidgetItem *findItem = ui->rulesTable->item(row, kFindColumn);
+        const QTableWidgetItem *replaceItem = ui->rulesTable->item(row, kReplaceColumn);
+        const QTableWidgetItem *matchCaseItem = ui->rulesTable->item(row, kMatchCaseColumn);
+        rule.enabled = enabledItem && enabledItem->checkState() == Qt::Checked;
+        rule.find = findItem ? findItem->text() : QString();
+        rule.replace = replaceItem ? replaceItem->text() : QString();
+        rule.caseSensitive = matchCaseItem && matchCaseItem->checkState() == Qt::Checked;
+        rules.push_back(rule);
+    }
+    return rules;
+}
+
+void TextTransformWindow::save_rules()
+{
+    settings.setValue(kRulesKey, QString::fromUtf8(TextTransform::to_json(rules())));
+    settings.sync();
+}
+
+void TextTransformWindow::rules_edited()
+{
+    previewCurrent_ = false;
+}
+
+bool TextTransformWindow::compute_changes()
+{
+    SRT_TRACE_SCOPE("TextTransformWindow::compute_changes");
+    const TextTransform transform(rules());
+    if (!transform.is_valid())
+    {
+        QMessageBox::warning(this, tr("Invalid rule"), transform.error());
+        return false;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QElapsedTimer timer;
+    timer.start();
+    changes_ = transform.run(texts_);
+    const qint64 elapsedMs = timer.elapsed();
+    QApplication::restoreOverrideCursor();
+
+    SRT_LOG_INFO("transform", "{} rules changed {} of {} subtitles in {} ms", rules().size(), changes_.size(), texts_.size(), elapsedMs);
+    ui->labelSummary->setText(tr("%1 of %2 subtitles change (%3 ms).").arg(changes_.size()).arg(texts_.size()).arg(elapsedMs));
+    previewCurrent_ = true;
+    return true;
+}
+
+void TextTransformWindow::preview()
+{
+    if (!compute_changes())
+    {
+        return;
+    }
+    save_rules();
+
+    const int shown = std::min(static_cast<int>(changes_.size()), kPreviewRowLimit);
+    ui->previewTable->setRowCount(0);
+    ui->previewTable->setRowCount(shown);
+    for (int i = 0; i < shown; ++i)
+    {
+        const TextTransform::Change &change = changes_.at(i);
+        ui->previewTable->setItem(i, 0, readOnlyCell(QString::number(change.row + 1)));
+        ui->previewTable->setItem(i, 1, readOnlyCell(change.before));
+        ui->previewTable->setItem(i, 2, readOnlyCell(change.after));
+    }
+    ui->previewTable->resizeRowsToContents();
+
+    if (shown < changes_.size())
+    {
+        ui->labelSummary->setText(ui->labelSummary->text() + QStringLiteral(" ") + tr("Showing the first %1.").arg(shown));
+    }
+}
+
+void TextTransformWindow::apply()
+{
+    // Rules edited after the preview are run again, so what is applied is
+    // always what the rules say now.
+    if (!previewCurrent_ && !compute_changes())
+    {
+        return;
+    }
+    save_rules();
+
+    if (changes_.isEmpty())
+    {
+        QMessageBox::information(this, tr("Nothing to change"), tr("The rules do not change any subtitle."));
+        return;
+    }
+    accept();
+}
@@ -0,0 +1,145 @@
+#include "time_stretch.h"
+
+#include "simd.h"
+#include "wav_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr double kFrameSeconds = 0.025;
+constexpr double kToleranceSeconds = 0.008;
+constexpr double kPi = 3.14159265358979323846;
+} // namespace
+
+std::vector<float> TimeStretch::wsola(const std::vector<float> &input, int channels, int sampleRate, double ratio)
+{
+    if (input.empty() || channels <= 0 || sampleRate <= 0 || ratio <= 0.0 || std::abs(ratio - 1.0) < 1e-3)
+    {
+        return input;
+    }
+
+    const int frameLength = std::max(64, static_cast<int>(std::lround(kFrameSeconds * sampleRate)) & ~1);
+    const int synthesisHop = frameLength / 2;
+    const int tolerance = static_cast<int>(std::lround(kToleranceSeconds * sampleRate));
+    const double analysisHop = synthesisHop / ratio;
+
+    const qint64 inFrames = static_cast<qint64>(input.size()) / channels;
+    const qint64 outFrames = std::llround(static_cast<double>(inFrames) * ratio);
+    // Zero padding lets every window and search read past the end safely.
+    const qint64 padded = inFrames + frameLength + 2 * tolerance + synthesisHop;
+
+    std::vector<std::vector<float>> planar(static_cast<size_t>(channels), std::vector<float>(static_cast<size_t>(padded), 0.0f));
+    std::vector<float> mono(static_cast<size_t>(padded), 0.0f);
+    for (qint64 frame = 0; frame < inFrames; ++frame)
+    {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c)
+        {
+            const float sample = input[static_cast<size_t>(frame * channels + c)];
+            planar[static_cast<size_t>(c)][static_cast<size_t>(frame)] = sample;
+            sum += sample;
+        }
+        mono[static_cast<size_t>(frame)] = sum / static_cast<float>(channels);
+    }
+
+    std::vector<float> window(static_cast<size_t>(frameLength));
+    for (int i = 0; i < frameLength; ++i)
+    {
+        window[static_cast<size_t>(i)] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / frameLength));
+    }
+
+    const qint64 outCapacity = outFrames + frameLength;
+    std::vector<std::vector<float>> output(static_cast<size_t>(channels), std::vector<float>(static_cast<size_t>(outCapacity), 0.0f));
+    std::vector<float> windowSum(static_cast<size_t>(outCapacity), 0.0f);
+    const std::vector<float> ones(static_cast<size_t>(frameLength), 1.0f);
+
+    qint64 previous = 0;
+    for (qint64 hop = 0; hop * synthesisHop < outFrames; ++hop)
+    {
+        const qint64 outPosition = hop * synthesisHop;
+        qint64 position = 0;
+        if (hop > 0)
+        {
+            const qint64 nominal = std::llround(hop * analysisHop);
+            const qint64 natural = std::min(previous + synthesisHop, inFrames);
+            const qint64 first = std::max<qint64>(0, nominal - tolerance);
+            const qint64 last = std::min<qint64>(inFrames, nominal + tolerance);
+
+            position = std::clamp<qint64>(nominal, 0, inFrames);
+            float best = -std::numeric_limits<float>::infinity();
+            for (qint64 candidate = first; candidate <= last; ++candidate)
+            {
+                const float score = dotProduct(mono.data() + candidate, mono.data() + natural, frameLength);
+                if (score > best)
+                {
+                    best = score;
+                    position = candidate;
+                }
+            }
+        }
+
+        for (int c = 0; c < channels; ++c)
+        {
+            windowedAdd(output[static_cast<size_t>(c)].data() + outPosition,
+                        planar[static_cast<size_t>(c)].data() + position,
+                        window.data(),
+                        frameLength);
+        }
+        windowedAdd(windowSum.data() + outPosition, ones.data(), window.data(), frameLength);
+        previous = position;
+    }
+
+    std::vector<float> result(static_cast<size_t>(outFrames * channels));
+    for (qint64 frame = 0; frame < outFrames; ++frame)
+    {
+        const float norm = windowSum[static_cast<size_t>(frame)];
+        const float gain = norm > 1e-3f ? 1.0f / norm : 1.0f;
+        for (int c = 0; c < channels; ++c)
+        {
+            result[static_cast<size_t>(frame * channels + c)] = output[static_cast<size_t>(c)][static_cast<size_t>(frame)] * gain;
+        }
+    }
+    return result;
+}
+
+bool TimeStretch::fit_clip(const QString &path, double targetSeconds, double maxRatio, double *resultSeconds)
+{
+    if (targetSeconds <= 0.0 || !WavFile::is_wav(path))
+    {
+        return false;
+    }
+
+    WavFormat format;
+    std::vector<float> samples;
+    if (!WavFile::read(path, &format, &samples) || samples.empty())
+    {
+        return false;
+    }
+
+    const double currentSeconds = static_cast<double>(samples.size() / static_cast<size_t>(format.channels)) / format.sampleRate;
+    const double limit = std::max(1.0, maxRatio);
+    const double ratio = std::clamp(targetSeconds / currentSeconds, 1.0 / limit, limit);
+    if (std::abs(ratio - 1.0) < 0.01)
+    {
+        if (resultSeconds)
+        {
+            *resultSeconds = currentSeconds;
+        }
+        return true;
+    }
+
+    const std::vector<float> stretched = wsola(samples, format.channels, format.sampleRate, ratio);
+    if (!WavFile::write(path, format, stretched))
+    {
+        return false;
+    }
+
+    if (resultSeconds)
+    {
+        *resultSeconds = static_cast<double>(stretched.size() / static_cast<size_t>(format.channels)) / format.sampleRate;
+    }
+    return true;
+}
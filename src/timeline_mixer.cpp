@@ -0,0 +1,542 @@
+#include "timeline_mixer.h"
+
+#include "audio_probe.h"
+#include "wav_file.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr int kSilentFramesPerWrite = 64;
+
+void sortByStart(QVector<TimelineMixer::Cue> &cues)
+{
+    std::stable_sort(cues.begin(), cues.end(), [](const TimelineMixer::Cue &a, const TimelineMixer::Cue &b) {
+        return a.startMs < b.startMs;
+    });
+}
+
+void setError(TimelineMixer::Report *report, const QString &message)
+{
+    if (report)
+    {
+        report->error = message;
+    }
+}
+
+// Maps a clip to the output channel layout.
+std::vector<float> remixChannels(const std::vector<float> &input, int inChannels, int outChannels)
+{
+    if (inChannels == outChannels)
+    {
+        return input;
+    }
+
+    const size_t frames = input.size() / static_cast<size_t>(inChannels);
+    std::vector<float> output(frames * static_cast<size_t>(outChannels), 0.0f);
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        const float *in = input.data() + frame * static_cast<size_t>(inChannels);
+        float *out = output.data() + frame * static_cast<size_t>(outChannels);
+        if (outChannels == 1)
+        {
+            float sum = 0.0f;
+            for (int c = 0; c < inChannels; ++c)
+            {
+                sum += in[c];
+            }
+            out[0] = sum / static_cast<float>(inChannels);
+        }
+        else if (inChannels == 1)
+        {
+            std::fill(out, out + outChannels, in[0]);
+        }
+        else
+        {
+            std::copy(in, in + std::min(inChannels, outChannels), out);
+        }
+    }
+    return output;
+}
+
+std::vector<float> resampleLinear(const std::vector<float> &input, int channels, int inRate, int outRate)
+{
+    if (inRate == outRate || input.empty())
+    {
+        return input;
+    }
+
+    const qint64 inFrames = static_cast<qint64>(input.size()) / channels;
+    const qint64 outFrames = inFrames * outRate / inRate;
+    std::vector<float> output(static_cast<size_t>(outFrames * channels));
+    const double step = static_cast<double>(inRate) / outRate;
+    for (qint64 frame = 0; frame < outFrames; ++frame)
+    {
+        const double position = frame * step;
+        const qint64 index = static_cast<qint64>(position);
+        const qint64 next = std::min(index + 1, inFrames - 1);
+        const float fraction = static_cast<float>(position - static_cast<double>(index));
+        for (int c = 0; c < channels; ++c)
+        {
+            const float a = input[static_cast<size_t>(index * channels + c)];
+            const float b = input[static_cast<size_t>(next * channels + c)];
+            output[static_cast<size_t>(frame * channels + c)] = a + (b - a) * fraction;
+        }
+    }
+    return output;
+}
+
+struct MappedFile
+{
+    QFile file;
+    uchar *data = nullptr;
+    qint64 size = 0;
+
+    bool open(const QString &path)
+    {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+        size = file.size();
+        data = size > 0 ? file.map(0, size) : nullptr;
+        return data != nullptr;
+    }
+
+    ~MappedFile()
+    {
+        if (data)
+        {
+            file.unmap(data);
+        }
+    }
+};
+
+// A Layer III frame whose side information is all zero decodes to silence:
+// no granule carries any Huffman data and main_data_begin points nowhere.
+QByteArray buildSilentFrame(const unsigned char *reference, AudioProbe::Mp3Frame *silent)
+{
+    unsigned char header[4] = {reference[0], reference[1], reference[2], reference[3]};
+    header[1] |= 0x01;                                           // no CRC
+    header[2] = static_cast<unsigned char>((header[2] & 0x0C) | 0x10); // lowest bitrate, no padding
+    if (!AudioProbe::parse_mp3_header(header, silent))
+    {
+        return {};
+    }
+
+    QByteArray frame(silent->length, '\0');
+    std::copy(header, header + 4, reinterpret_cast<unsigned char *>(frame.data()));
+    return frame;
+}
+
+// Locates the audio frames of a clip as one byte range, leaving out the
+// Xing/VBRI frame that describes the source file only. Returns the frame
+// count, or -1 if the clip does not match the reference stream.
+qint64 findAudioFrames(const MappedFile &clip, const AudioProbe::Mp3Frame &reference, qint64 *begin, qint64 *end)
+{
+    AudioProbe::Mp3Frame frame;
+    const qint64 first = AudioProbe::find_first_mp3_frame(clip.data, clip.size, &frame);
+    if (first < 0 || frame.sampleRate != reference.sampleRate || frame.layer != reference.layer ||
+        frame.version != reference.version)
+    {
+        return -1;
+    }
+
+    *begin = first;
+    if (AudioProbe::is_mp3_info_frame(clip.data, clip.size, first, frame))
+    {
+        *begin += frame.length;
+    }
+
+    qint64 frames = 0;
+    *end = *begin;
+    while (*end + 4 <= clip.size && AudioProbe::parse_mp3_header(clip.data + *end, &frame) &&
+           *end + frame.length <= clip.size && frame.sampleRate == reference.sampleRate)
+    {
+        *end += frame.length;
+        ++frames;
+    }
+    return frames;
+}
+
+bool joinMp3(const QStringList &clipPaths, const QString &outputPath)
+{
+    AudioProbe::Mp3Frame reference;
+    QSaveFile output(outputPath);
+    bool haveReference = false;
+    for (const QString &path : clipPaths)
+    {
+        MappedFile clip;
+        if (!clip.open(path))
+        {
+            return false;
+        }
+        if (!haveReference)
+        {
+            if (AudioProbe::find_first_mp3_frame(clip.data, clip.size, &reference) < 0 ||
+                !output.open(QIODevice::WriteOnly))
+            {
+                return false;
+            }
+            haveReference = true;
+        }
+
+        qint64 begin = 0;
+        qint64 end = 0;
+        if (findAudioFrames(clip, reference, &begin, &end) < 0 ||
+            output.write(reinterpret_cast<const char *>(clip.data + begin), end - begin) != end - begin)
+        {
+            output.cancelWriting();
+            return false;
+        }
+    }
+    return haveReference && output.commit();
+}
+
+// Ogg streams may be chained and ADTS AAC is a plain frame sequence, so both
+// join by appending whole files.
+bool joinBytes(const QStringList &clipPaths, const QString &outputPath)
+{
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    for (const QString &path : clipPaths)
+    {
+        QFile clip(path);
+        if (!clip.open(QIODevice::ReadOnly))
+        {
+            output.cancelWriting();
+            return false;
+        }
+        while (!clip.atEnd())
+        {
+            const QByteArray block = clip.read(256 * 1024);
+            if (block.isEmpty() || output.write(block) != block.size())
+            {
+                output.cancelWriting();
+                return false;
+            }
+        }
+    }
+    return output.commit();
+}
+
+bool joinWav(const QStringList &clipPaths, const QString &outputPath, int crossfadeMs)
+{
+    WavFormat format;
+    std::vector<float> joined;
+    for (const QString &path : clipPaths)
+    {
+        WavFormat clipFormat;
+        std::vector<float> clip;
+        if (!WavFile::read(path, &clipFormat, &clip))
+        {
+            return false;
+        }
+        if (format.sampleRate <= 0)
+        {
+            format = clipFormat;
+            joined = std::move(clip);
+            continue;
+        }
+
+        clip = remixChannels(clip, clipFormat.channels, format.channels);
+        clip = resampleLinear(clip, format.channels, clipFormat.sampleRate, format.sampleRate);
+
+        // Equal-power fade: the summed energy stays level across the seam.
+        const size_t channels = static_cast<size_t>(format.channels);
+        const size_t fadeFrames = std::min({static_cast<size_t>(crossfadeMs) * static_cast<size_t>(format.sampleRate) / 1000,
+                                            joined.size() / channels / 2,
+                                            clip.size() / channels / 2});
+        const size_t overlapStart = joined.size() - fadeFrames * channels;
+        for (size_t frame = 0; frame < fadeFrames; ++frame)
+        {
+            const double t = (frame + 0.5) / static_cast<double>(fadeFrames);
+            const float fadeIn = static_cast<float>(std::sin(t * 1.5707963267948966));
+            const float fadeOut = static_cast<float>(std::cos(t * 1.5707963267948966));
+            for (size_t c = 0; c < channels; ++c)
+            {
+                float &sample = joined[overlapStart + frame * channels + c];
+                sample = sample * fadeOut + clip[frame * channels + c] * fadeIn;
+            }
+        }
+        joined.insert(joined.end(), clip.begin() + static_cast<std::ptrdiff_t>(fadeFrames * channels), clip.end());
+    }
+
+    return format.sampleRate > 0 && WavFile::write(outputPath, format, joined);
+}
+} // namespace
+
+bool TimelineMixer::mix_to_wav(QVector<Cue> cues,
+                               const QString &outputPath,
+                               Report *report,
+                               const ProgressCallback &progress)
+{
+    sortByStart(cues);
+
+    WavFormat outFormat;
+    for (const Cue &cue : cues)
+    {
+        WavReader probe;
+        if (probe.open(cue.clipPath))
+        {
+            outFormat = probe.format();
+            break;
+        }
+    }
+
+    if (outFormat.sampleRate <= 0)
+    {
+        setError(report, QObject::tr("None of the clips is a readable WAV file."));
+        return false;
+    }
+
+    WavWriter writer;
+    if (!writer.open(outputPath, outFormat))
+    {
+        setError(report, QObject::tr("Unable to write %1.").arg(outputPath));
+        return false;
+    }
+
+    const int channels = outFormat.channels;
+    const qint64 sampleRate = outFormat.sampleRate;
+
+    // Mix window: everything before pendingStart is already on disk. Since cues
+    // are sorted, no later clip can land before the current cue's start.
+    std::vector<float> pending;
+    qint64 pendingStart = 0;
+
+    auto flushUntil = [&](qint64 frame) {
+        const qint64 pendingFrames = static_cast<qint64>(pending.size()) / channels;
+        const qint64 fromPending = std::min(frame - pendingStart, pendingFrames);
+        if (fromPending > 0)
+        {
+            if (!writer.write(pending.data(), fromPending))
+            {
+                return false;
+            }
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(fromPending * channels));
+        }
+        if (!writer.write_silence(frame - pendingStart - std::max<qint64>(fromPending, 0)))
+        {
+            return false;
+        }
+        pendingStart = frame;
+        return true;
+    };
+
+    for (int index = 0; index < cues.size(); ++index)
+    {
+        const Cue &cue = cues.at(index);
+        const qint64 target = std::max<qint64>(0, cue.startMs) * sampleRate / 1000;
+
+        if (target > pendingStart && !flushUntil(target))
+        {
+            writer.cancel();
+            setError(report, QObject::tr("Unable to write %1.").arg(outputPath));
+            return false;
+        }
+
+        WavFormat clipFormat;
+        std::vector<float> clip;
+        if (!WavFile::read(cue.clipPath, &clipFormat, &clip) || clip.empty())
+        {
+            if (report)
+            {
+                ++report->skipped;
+            }
+        }
+        else
+        {
+            clip = remixChannels(clip, clipFormat.channels, channels);
+            clip = resampleLinear(clip, channels, clipFormat.sampleRate, outFormat.sampleRate);
+
+            const size_t offset = static_cast<size_t>((target - pendingStart) * channels);
+            if (report && pending.size() > offset)
+            {
+                report->overlapMs += static_cast<qint64>(pending.size() - offset) / channels * 1000 / sampleRate;
+            }
+            if (pending.size() < offset + clip.size())
+            {
+                pending.resize(offset + clip.size(), 0.0f);
+            }
+            for (size_t i = 0; i < clip.size(); ++i)
+            {
+                pending[offset + i] += clip[i];
+            }
+
+            if (report)
+            {
+                ++report->placed;
+            }
+        }
+
+        if (progress && !progress(index + 1, static_cast<int>(cues.size())))
+        {
+            writer.cancel();
+            setError(report, QObject::tr("Mixdown cancelled."));
+            return false;
+        }
+    }
+
+    const qint64 tail = pendingStart + static_cast<qint64>(pending.size()) / channels;
+    if (!flushUntil(tail) || !writer.commit())
+    {
+        writer.cancel();
+        setError(report, QObject::tr("Unable to write %1.").arg(outputPath));
+        return false;
+    }
+
+    return true;
+}
+
+bool TimelineMixer::concat_mp3(QVector<Cue> cues,
+                               const QString &outputPath,
+                               Report *report,
+                               const ProgressCallback &progress)
+{
+    sortByStart(cues);
+
+    AudioProbe::Mp3Frame reference;
+    QByteArray silentFrame;
+    AudioProbe::Mp3Frame silent;
+    for (const Cue &cue : cues)
+    {
+        MappedFile clip;
+        if (!clip.open(cue.clipPath))
+        {
+            continue;
+        }
+        const qint64 first = AudioProbe::find_first_mp3_frame(clip.data, clip.size, &reference);
+        if (first >= 0 && reference.layer == 3)
+        {
+            silentFrame = buildSilentFrame(clip.data + first, &silent);
+            break;
+        }
+    }
+
+    if (silentFrame.isEmpty())
+    {
+        setError(report, QObject::tr("None of the clips is a readable MP3 file."));
+        return false;
+    }
+
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly))
+    {
+        setError(report, QObject::tr("Unable to write %1.").arg(outputPath));
+        return false;
+    }
+
+    const QByteArray silentBlock = silentFrame.repeated(kSilentFramesPerWrite);
+    const double msPerFrame = 1000.0 * reference.samplesPerFrame / reference.sampleRate;
+    qint64 framesWritten = 0;
+    bool writeFailed = false;
+
+    auto writeSilence = [&](qint64 frames) {
+        while (frames > 0 && !writeFailed)
+        {
+            const qint64 batch = std::min<qint64>(frames, kSilentFramesPerWrite);
+            const qint64 bytes = batch * silentFrame.size();
+            writeFailed = output.write(silentBlock.constData(), bytes) != bytes;
+            framesWritten += batch;
+            frames -= batch;
+        }
+    };
+
+    for (int index = 0; index < cues.size() && !writeFailed; ++index)
+    {
+        const Cue &cue = cues.at(index);
+        const qint64 target = std::llround(std::max<qint64>(0, cue.startMs) / msPerFrame);
+        if (target > framesWritten)
+        {
+            writeSilence(target - framesWritten);
+        }
+        else if (report && target < framesWritten)
+        {
+            report->overlapMs += static_cast<qint64>((framesWritten - target) * msPerFrame);
+        }
+
+        MappedFile clip;
+        qint64 begin = 0;
+        qint64 end = 0;
+        const qint64 clipFrames = clip.open(cue.clipPath) ? findAudioFrames(clip, reference, &begin, &end) : -1;
+        if (clipFrames < 0)
+        {
+            if (report)
+            {
+                ++report->skipped;
+            }
+        }
+        else
+        {
+            if (end > begin)
+            {
+                const qint64 bytes = end - begin;
+                writeFailed = output.write(reinterpret_cast<const char *>(clip.data + begin), bytes) != bytes;
+                framesWritten += clipFrames;
+            }
+
+            if (report)
+            {
+                ++report->placed;
+            }
+        }
+
+        if (progress && !progress(index + 1, static_cast<int>(cues.size())))
+        {
+            output.cancelWriting();
+            setError(report, QObject::tr("Mixdown cancelled."));
+            return false;
+        }
+    }
+
+    if (writeFailed || !output.commit())
+    {
+        setError(report, QObject::tr("Unable to write %1.").arg(outputPath));
+        return false;
+    }
+
+    return true;
+}
+
+bool TimelineMixer::join_clips(const QStringList &clipPaths,
+                               const QString &outputPath,
+                               int crossfadeMs,
+                               QString *errorMessage)
+{
+    if (clipPaths.isEmpty())
+    {
+        return false;
+    }
+
+    bool ok = false;
+    if (WavFile::is_wav(clipPaths.first()))
+    {
+        ok = joinWav(clipPaths, outputPath, crossfadeMs);
+    }
+    else if (QFileInfo(clipPaths.first()).suffix().compare(QStringLiteral("mp3"), Qt::CaseInsensitive) == 0)
+    {
+        ok = joinMp3(clipPaths, outputPath);
+    }
+    else
+    {
+        ok = joinBytes(clipPaths, outputPath);
+    }
+    if (!ok && errorMessage)
+    {
+        *errorMessage = QObject::tr("Unable to join the synthesized parts into %1.").arg(outputPath);
+    }
+    return ok;
+}
@@ -0,0 +1,183 @@
+#include "trace.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+constexpr std::uint64_t kRingCapacity = 1u << 14; // per thread, power of two
+
+// One span slot. The sequence number works as a per-slot seqlock: odd while
+// the owning thread writes, even once the slot is complete, so export can
+// detect and skip a slot overwritten while it was being copied.
+struct Slot
+{
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<std::int64_t> startNs{0};
+    std::atomic<std::int64_t> endNs{0};
+};
+
+struct ThreadRing
+{
+    int tid = 0;
+    QString name;
+    std::atomic<std::uint64_t> head{0};
+    std::unique_ptr<Slot[]> slots{new Slot[kRingCapacity]};
+};
+
+// Rings are registered once per thread and never freed, so spans from
+// threads that have exited still appear in the export.
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadRing &threadRing()
+{
+    thread_local ThreadRing *ring = []() {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto created = std::make_unique<ThreadRing>();
+        created->tid = static_cast<int>(reg.rings.size()) + 1;
+        reg.rings.push_back(std::move(created));
+        return reg.rings.back().get();
+    }();
+    return *ring;
+}
+
+thread_local std::atomic<const char *> activeScope{nullptr};
+
+const std::chrono::steady_clock::time_point &epoch()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return start;
+}
+} // namespace
+
+bool Trace::enabled()
+{
+#ifdef SRT_EDITOR_ENABLE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::int64_t Trace::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch()).count();
+}
+
+void Trace::record(const char *name, std::int64_t startNs, std::int64_t endNs)
+{
+    ThreadRing &ring = threadRing();
+    const std::uint64_t index = ring.head.load(std::memory_order_relaxed);
+    Slot &slot = ring.slots[index & (kRingCapacity - 1)];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void Trace::set_thread_name(const QString &name)
+{
+    ThreadRing &ring = threadRing();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.name = name;
+}
+
+bool Trace::write_chrome_json(const QString &path, QString *errorMessage)
+{
+    QJsonArray events;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto &ring : reg.rings)
+        {
+            if (!ring->name.isEmpty())
+            {
+                events.append(QJsonObject{{QStringLiteral("name"), QStringLiteral("thread_name")},
+                                          {QStringLiteral("ph"), QStringLiteral("M")},
+                                          {QStringLiteral("pid"), 1},
+                                          {QStringLiteral("tid"), ring->tid},
+                                          {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), ring->name}}}});
+            }
+
+            const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            const std::uint64_t first = head > kRingCapacity ? head - kRingCapacity : 0;
+            for (std::uint64_t index = first; index < head; ++index)
+            {
+                const Slot &slot = ring->slots[index & (kRingCapacity - 1)];
+                const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+                const char *name = slot.name.load(std::memory_order_relaxed);
+                const std::int64_t startNs = slot.startNs.load(std::memory_order_relaxed);
+                const std::int64_t endNs = slot.endNs.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const std::uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+                if (before != 2 * index + 2 || after != before || !name)
+                {
+                    continue; // overwritten while we were reading it
+                }
+
+                events.append(QJsonObject{{QStringLiteral("name"), QString::fromLatin1(name)},
+                                          {QStringLiteral("ph"), QStringLiteral("X")},
+                                          {QStringLiteral("pid"), 1},
+                                          {QStringLiteral("tid"), ring->tid},
+                                          {QStringLiteral("ts"), static_cast<double>(startNs) / 1000.0},
+                                          {QStringLiteral("dur"), static_cast<double>(endNs - startNs) / 1000.0}});
+            }
+        }
+    }
+
+    const QJsonObject root{{QStringLiteral("traceEvents"), events},
+                           {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 ||
+        !file.commit())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+const std::atomic<const char *> *Trace::active_scope_slot()
+{
+    return &activeScope;
+}
+
+const char *Trace::enter_scope(const char *name)
+{
+    return activeScope.exchange(name, std::memory_order_relaxed);
+}
+
+void Trace::leave_scope(const char *previous)
+{
+    activeScope.store(previous, std::memory_order_relaxed);
+}
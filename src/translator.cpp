@@ -1,5 +1,11 @@
 #include "translator.h"
 
+#include "logger.h"
+#include "provider_endpoints.h"
+#include "provider_metrics.h"
+#include "provider_scheduler.h"
+#include "trace.h"
+
 namespace
 {
 size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
@@ -49,6 +55,51 @@ QString extractMessageContent(const QJsonObject &messageObj)
 
     return {};
 }
+
+void recordTokenUsage(const MetricLabels &labels, const QJsonObject &responseObj)
+{
+    const QJsonObject usage = responseObj.value(QStringLiteral("usage")).toObject();
+    if (usage.isEmpty())
+    {
+        return;
+    }
+    ProviderMetrics::instance().add_tokens(labels,
+                                           static_cast<std::uint64_t>(usage.value(QStringLiteral("prompt_tokens")).toDouble()),
+                                           static_cast<std::uint64_t>(usage.value(QStringLiteral("completion_tokens")).toDouble()));
+}
+
+// Translation runs on executor threads, where no dialog may be opened; the
+// caller decides how to show the message.
+void reportError(QString *error, const QString &message)
+{
+    SRT_LOG_WARN("translator", "{}", message);
+    if (error)
+    {
+        *error = message;
+    }
+}
+
+QString missingKeyMessage(const QString &providerName)
+{
+    return QObject::tr("Please configure an API key for %1 before translating.").arg(providerName);
+}
+
+QString notSupportedMessage(const QString &providerName)
+{
+    return QObject::tr("Translating with %1 is not supported yet.").arg(providerName);
+}
+
+// Chat completion APIs answer a rejected request with {"error": {"message"}}
+// instead of choices.
+QString responseError(const QString &providerName, const QJsonObject &responseObj)
+{
+    const QString message = responseObj.value(QStringLiteral("error")).toObject().value(QStringLiteral("message")).toString();
+    if (message.isEmpty())
+    {
+        return QObject::tr("%1 sent no translation.").arg(providerName);
+    }
+    return QObject::tr("%1 rejected the request: %2").arg(providerName, message);
+}
 } // namespace
 
 Translator::Translator(/* args */)
@@ -59,7 +110,37 @@ Translator::~Translator()
 {
 }
 
-QString Translator::translate_by_github_model(QString input, std::string src_lang, std::string target_lang, const QString &token)
+QString Translator::translate(const QString &provider, QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error)
+{
+    if (provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
+    {
+        return translate_by_openai(input, src_lang, target_lang, token, error);
+    }
+    if (provider.compare(QStringLiteral("Github Model"), Qt::CaseInsensitive) == 0)
+    {
+        return translate_by_github_model(input, src_lang, target_lang, token, error);
+    }
+    if (provider.compare(QStringLiteral("Gemini"), Qt::CaseInsensitive) == 0)
+    {
+        return translate_by_gemini(input, src_lang, target_lang, token, error);
+    }
+    return translate_by_google_translate(input, src_lang, target_lang, token, error);
+}
+
+MetricLabels Translator::metric_labels(const QString &provider, const QString &token)
+{
+    if (provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
+    {
+        return ProviderMetrics::labels(QStringLiteral("openai"), QStringLiteral("chat/completions"), token.trimmed());
+    }
+    if (provider.compare(QStringLiteral("Github Model"), Qt::CaseInsensitive) == 0)
+    {
+        return ProviderMetrics::labels(QStringLiteral("github"), QStringLiteral("chat/completions"), token.trimmed());
+    }
+    return {};
+}
+
+QString Translator::translate_by_github_model(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error)
 {
     if (input.isEmpty())
     {
@@ -69,9 +150,7 @@ QString Translator::translate_by_github_model(QString input, std::string src_lan
     const QString trimmedToken = token.trimmed();
     if (trimmedToken.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("Please configure an API key for Github Model before translating."));
+        reportError(error, missingKeyMessage(QStringLiteral("Github Model")));
         return input;
     }
 
@@ -80,6 +159,7 @@ QString Translator::translate_by_github_model(QString input, std::string src_lan
     CURL *curl = curl_easy_init();
     if (!curl)
     {
+        reportError(error, QObject::tr("Could not start a request to %1.").arg(QStringLiteral("Github Model")));
         return input;
     }
 
@@ -114,8 +194,9 @@ QString Translator::translate_by_github_model(QString input, std::string src_lan
         {"messages", messages}};
 
     const QByteArray jsonBytes = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    const QByteArray url = ProviderEndpoints::url(QStringLiteral("github"), QStringLiteral("inference/chat/completions"));
 
-    curl_easy_setopt(curl, CURLOPT_URL, "https://models.github.ai/inference/chat/completions");
+    curl_easy_setopt(curl, CURLOPT_URL, url.constData());
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     curl_easy_setopt(curl, CURLOPT_POST, 1L);
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonBytes.constData());
@@ -125,26 +206,41 @@ QString Translator::translate_by_github_model(QString input, std::string src_lan
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
 
-    res = curl_easy_perform(curl);
+    // The permit is held for the transfer only, so the metrics below still
+    // time the request itself and not the wait for a slot.
+    ProviderScheduler &scheduler = ProviderScheduler::instance();
+    scheduler.share_caches(curl);
+    {
+        const ProviderScheduler::Permit permit = scheduler.acquire(QStringLiteral("github"));
+        SRT_TRACE_SCOPE("Translator::github_model_request");
+        res = curl_easy_perform(curl);
+        permit.complete(curl);
+    }
+    const MetricLabels metricLabels = metric_labels(QStringLiteral("Github Model"), trimmedToken);
+    ProviderMetrics::instance().record_curl(metricLabels, curl, res);
 
     curl_slist_free_all(headers);
     curl_easy_cleanup(curl);
 
     if (res != CURLE_OK)
     {
+        reportError(error, QObject::tr("The request to %1 failed: %2").arg(QStringLiteral("Github Model"), QString::fromUtf8(curl_easy_strerror(res))));
         return input;
     }
 
     const QJsonDocument responseDoc = QJsonDocument::fromJson(QByteArray::fromStdString(responseBuffer));
     if (!responseDoc.isObject())
     {
+        reportError(error, QObject::tr("%1 sent a response that is not JSON.").arg(QStringLiteral("Github Model")));
         return input;
     }
 
     const QJsonObject responseObj = responseDoc.object();
+    recordTokenUsage(metricLabels, responseObj);
     const QJsonArray choices = responseObj.value(QStringLiteral("choices")).toArray();
     if (choices.isEmpty())
     {
+        reportError(error, responseError(QStringLiteral("Github Model"), responseObj));
         return input;
     }
 
@@ -154,13 +250,14 @@ QString Translator::translate_by_github_model(QString input, std::string src_lan
 
     if (content.trimmed().isEmpty())
     {
+        reportError(error, QObject::tr("%1 sent an empty translation.").arg(QStringLiteral("Github Model")));
         return input;
     }
 
     return content.trimmed();
 }
 
-QString Translator::translate_by_openai(QString input, std::string src_lang, std::string target_lang, const QString &token)
+QString Translator::translate_by_openai(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error)
 {
     if (input.isEmpty())
     {
@@ -170,9 +267,7 @@ QString Translator::translate_by_openai(QString input, std::string src_lang, std
     const QString trimmedToken = token.trimmed();
     if (trimmedToken.isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("Please configure an API key for OpenAI before translating."));
+        reportError(error, missingKeyMessage(QStringLiteral("OpenAI")));
         return input;
     }
 
@@ -181,6 +276,7 @@ QString Translator::translate_by_openai(QString input, std::string src_lang, std
     CURL *curl = curl_easy_init();
     if (!curl)
     {
+        reportError(error, QObject::tr("Could not start a request to %1.").arg(QStringLiteral("OpenAI")));
         return input;
     }
 
@@ -214,8 +310,9 @@ QString Translator::translate_by_openai(QString input, std::string src_lang, std
         {"messages", messages}};
 
     const QByteArray jsonBytes = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    const QByteArray url = ProviderEndpoints::url(QStringLiteral("openai"), QStringLiteral("chat/completions"));
 
-    curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/chat/completions");
+    curl_easy_setopt(curl, CURLOPT_URL, url.constData());
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     curl_easy_setopt(curl, CURLOPT_POST, 1L);
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonBytes.constData());
@@ -225,25 +322,40 @@ QString Translator::translate_by_openai(QString input, std::string src_lang, std
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
 
-    const CURLcode res = curl_easy_perform(curl);
+    CURLcode res = CURLE_OK;
+    ProviderScheduler &scheduler = ProviderScheduler::instance();
+    scheduler.share_caches(curl);
+    {
+        const ProviderScheduler::Permit permit = scheduler.acquire(QStringLiteral("openai"));
+        SRT_TRACE_SCOPE("Translator::openai_request");
+        res = curl_easy_perform(curl);
+        permit.complete(curl);
+    }
+    const MetricLabels metricLabels = metric_labels(QStringLiteral("OpenAI"), trimmedToken);
+    ProviderMetrics::instance().record_curl(metricLabels, curl, res);
 
     curl_slist_free_all(headers);
     curl_easy_cleanup(curl);
 
     if (res != CURLE_OK)
     {
+        reportError(error, QObject::tr("The request to %1 failed: %2").arg(QStringLiteral("OpenAI"), QString::fromUtf8(curl_easy_strerror(res))));
         return input;
     }
 
     const QJsonDocument responseDoc = QJsonDocument::fromJson(QByteArray::fromStdString(responseBuffer));
     if (!responseDoc.isObject())
     {
+        reportError(error, QObject::tr("%1 sent a response that is not JSON.").arg(QStringLiteral("OpenAI")));
         return input;
     }
 
-    const QJsonArray choices = responseDoc.object().value(QStringLiteral("choices")).toArray();
+    const QJsonObject responseObj = responseDoc.object();
+    recordTokenUsage(metricLabels, responseObj);
+    const QJsonArray choices = responseObj.value(QStringLiteral("choices")).toArray();
     if (choices.isEmpty())
     {
+        reportError(error, responseError(QStringLiteral("OpenAI"), responseObj));
         return input;
     }
 
@@ -252,30 +364,31 @@ QString Translator::translate_by_openai(QString input, std::string src_lang, std
 
     if (content.trimmed().isEmpty())
     {
+        reportError(error, QObject::tr("%1 sent an empty translation.").arg(QStringLiteral("OpenAI")));
         return input;
     }
 
     return content.trimmed();
 }
 
-QString Translator::translate_by_gemini(QString input, std::string src_lang, std::string target_lang, const QString &token)
+QString Translator::translate_by_gemini(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error)
 {
     if (token.trimmed().isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("Please configure an API key for Gemini before translating."));
+        reportError(error, missingKeyMessage(QStringLiteral("Gemini")));
+        return input;
     }
+    reportError(error, notSupportedMessage(QStringLiteral("Gemini")));
     return input;
 }
 
-QString Translator::translate_by_google_translate(QString input, std::string src_lang, std::string target_lang, const QString &token)
+QString Translator::translate_by_google_translate(QString input, std::string src_lang, std::string target_lang, const QString &token, QString *error)
 {
     if (token.trimmed().isEmpty())
     {
-        QMessageBox::warning(nullptr,
-                             QObject::tr("Missing API key"),
-                             QObject::tr("Please configure an API key for Google Translate before translating."));
+        reportError(error, missingKeyMessage(QStringLiteral("Google Translate")));
+        return input;
     }
+    reportError(error, notSupportedMessage(QStringLiteral("Google Translate")));
     return input;
 }
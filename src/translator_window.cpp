@@ -1,13 +1,20 @@
 #include "translator_window.h"
 
+#include "logger.h"
+#include "provider_catalog.h"
+#include "provider_endpoints.h"
+#include "provider_metrics.h"
+#include "settings_service.h"
+#include "trace.h"
 #include "ui_translator_window.h"
 
 #include <QComboBox>
-#include <QDebug>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QPoint>
+#include <QPointer>
 #include <QPushButton>
+#include <QSignalBlocker>
 #include <QTableWidgetItem>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -24,6 +31,8 @@
 
 namespace
 {
+    constexpr int kMaxConcurrentTranslations = 4;
+
     size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
     {
         const size_t totalSize = size * nmemb;
@@ -39,7 +48,7 @@ namespace
                        { curl_global_init(CURL_GLOBAL_DEFAULT); });
     }
 
-    QByteArray performGetRequest(const QByteArray &url, const QList<QByteArray> &headers = {})
+    QByteArray performGetRequest(const QByteArray &url, const MetricLabels &metricLabels, const QList<QByteArray> &headers = {})
     {
         ensureCurlInitialized();
 
@@ -72,7 +81,12 @@ namespace
         curl_easy_setopt(curl, CURLOPT_USERAGENT, "SRT-Editor/1.0");
         curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 
-        const CURLcode res = curl_easy_perform(curl);
+        CURLcode res = CURLE_OK;
+        {
+            SRT_TRACE_SCOPE("TranslatorWindow::model_list_request");
+            res = curl_easy_perform(curl);
+        }
+        ProviderMetrics::instance().record_curl(metricLabels, curl, res);
         long statusCode = 0;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
 
@@ -285,7 +299,9 @@ namespace
         headers << QByteArray("Accept: application/vnd.github+json");
         headers << QByteArray("X-GitHub-Api-Version: 2022-11-28");
 
-        const QByteArray response = performGetRequest(QByteArrayLiteral("https://models.github.ai/catalog/models"), headers);
+        const QByteArray response = performGetRequest(ProviderEndpoints::url(QStringLiteral("github"), QStringLiteral("catalog/models")),
+                                                      ProviderMetrics::labels(QStringLiteral("github"), QStringLiteral("models"), token),
+                                                      headers);
         return parseGithubModelNames(response);
     }
 
@@ -300,7 +316,9 @@ namespace
         headers << QByteArray("Authorization: Bearer ") + token.toUtf8();
         headers << QByteArray("Accept: application/json");
 
-        const QByteArray response = performGetRequest(QByteArrayLiteral("https://api.openai.com/v1/models"), headers);
+        const QByteArray response = performGetRequest(ProviderEndpoints::url(QStringLiteral("openai"), QStringLiteral("models")),
+                                                      ProviderMetrics::labels(QStringLiteral("openai"), QStringLiteral("models"), token),
+                                                      headers);
         return parseOpenAIModelNames(response);
     }
 
@@ -317,7 +335,7 @@ namespace
         QList<QByteArray> headers;
         headers << QByteArray("Accept: application/json");
 
-        const QByteArray response = performGetRequest(url, headers);
+        const QByteArray response = performGetRequest(url, ProviderMetrics::labels(QStringLiteral("gemini"), QStringLiteral("models"), apiKey), headers);
         return parseOpenAIModelNames(response);
     }
 } // namespace
@@ -335,6 +353,13 @@ TranslatorWindow::TranslatorWindow(QWidget *parent)
     connect(ui->btnCancle, &QPushButton::clicked, this, &TranslatorWindow::close);
     connect(ui->btnTranslateAll, &QPushButton::clicked, this, &TranslatorWindow::translateAll);
     connect(ui->btnOk, &QPushButton::clicked, this, &TranslatorWindow::accept);
+    connect(&ProviderCatalog::instance(), &ProviderCatalog::updated, this, &TranslatorWindow::applyCatalogUpdate);
+    connect(&SettingsService::instance(), &SettingsService::changed, this, [this](const QString &key) {
+        if (key == QStringLiteral("ai/lang/provider"))
+        {
+            refreshModelList(settings.value(key).toString().trimmed());
+        }
+    });
 
     const QString provider = settings.value("ai/lang/provider").toString().trimmed();
     if (!provider.isEmpty())
@@ -343,10 +368,14 @@ TranslatorWindow::TranslatorWindow(QWidget *parent)
     }
 }
 
-TranslatorWindow::~TranslatorWindow() = default;
+TranslatorWindow::~TranslatorWindow()
+{
+    translationCancel.cancel();
+}
 
 void TranslatorWindow::setSourceTexts(const QStringList &sourceTexts)
 {
+    SRT_TRACE_SCOPE("TranslatorWindow::setSourceTexts");
     ui->subtitleTable->clearContents();
     ui->subtitleTable->setRowCount(sourceTexts.size());
 
@@ -399,26 +428,39 @@ void TranslatorWindow::handleTranslateButton()
 
     QTableWidgetItem *sourceItem = ui->subtitleTable->item(row, 0);
     const QString sourceText = sourceItem ? sourceItem->text() : QString();
-    const int displayRow = row + 1;
-    qDebug().noquote() << QStringLiteral("Translate row %1: %2").arg(displayRow).arg(sourceText);
+    SRT_LOG_DEBUG("translator", "translate row {} ({} chars)", row + 1, sourceText.size());
 
-    if (!validateLanguageInputs())
+    TranslationRequest request;
+    if (!prepareTranslation(&request))
     {
         return;
     }
 
+    SRT_LOG_DEBUG("translator", "languages {} -> {} via {}", request.sourceLanguage, request.targetLanguage, request.provider);
+
+    // A single row jumps ahead of a running batch.
+    startTranslation(row, request, Executor::Priority::High);
+}
+
+bool TranslatorWindow::prepareTranslation(TranslationRequest *request)
+{
+    if (!validateLanguageInputs())
+    {
+        return false;
+    }
+
     const QString provider = settings.value("ai/lang/provider").toString().trimmed();
     if (provider.isEmpty())
     {
         QMessageBox::warning(this, tr("Missing provider"), tr("Please select an AI provider before translating."));
-        return;
+        return false;
     }
 
     const QString apiToken = settings.value("ai/lang/apiKey").toString().trimmed();
     if (apiToken.isEmpty())
     {
         QMessageBox::warning(this, tr("Missing API key"), tr("Please configure an API key before translating."));
-        return;
+        return false;
     }
 
     const bool isOpenAI = provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0;
@@ -429,51 +471,94 @@ void TranslatorWindow::handleTranslateButton()
     if (!isOpenAI && !isGithub && !isGemini && !isGoogle)
     {
         QMessageBox::warning(this, tr("Unsupported provider"), tr("The selected provider is not supported for translation."));
-        return;
+        return false;
     }
 
-    const std::string sourceLanguage = ui->srcLang->text().trimmed().toStdString();
-    const std::string targetLanguage = ui->targetLang->text().trimmed().toStdString();
+    request->provider = provider;
+    request->token = apiToken;
+    request->sourceLanguage = ui->srcLang->text().trimmed().toStdString();
+    request->targetLanguage = ui->targetLang->text().trimmed().toStdString();
+    return true;
+}
 
-    QString translated;
-    if (isOpenAI)
+QString TranslatorWindow::translateText(const TranslationRequest &request, const QString &sourceText, QString *error)
+{
+    // Runs on executor threads; a failure comes back in *error and is shown
+    // by finishTranslation() on the GUI thread.
+    Translator translator;
+    return translator.translate(request.provider, sourceText, request.sourceLanguage, request.targetLanguage, request.token, error);
+}
+
+void TranslatorWindow::startTranslation(int row, const TranslationRequest &request, Executor::Priority priority)
+{
+    const QTableWidgetItem *sourceItem = ui->subtitleTable->item(row, 0);
+    const QString sourceText = sourceItem ? sourceItem->text() : QString();
+
+    ++translationsInFlight;
+    emit translationStarted(row);
+    if (auto *button = qobject_cast<QPushButton *>(ui->subtitleTable->cellWidget(row, 2)))
     {
-        translated = translator.translate_by_openai(sourceText, sourceLanguage, targetLanguage, apiToken);
+        button->setEnabled(false);
+        button->setText(tr("Translating..."));
     }
-    else if (isGithub)
+
+    const QPointer<TranslatorWindow> self(this);
+    Executor::io().submit([self, row, request, sourceText]() {
+        QString error;
+        const QString translated = translateText(request, sourceText, &error);
+        postToGui(self, [self, row, translated, error]() { self->finishTranslation(row, translated, error); });
+    }, priority, translationCancel);
+}
+
+void TranslatorWindow::finishTranslation(int row, const QString &translated, const QString &error)
+{
+    --translationsInFlight;
+    if (auto *button = qobject_cast<QPushButton *>(ui->subtitleTable->cellWidget(row, 2)))
     {
-        translated = translator.translate_by_github_model(sourceText, sourceLanguage, targetLanguage, apiToken);
+        button->setEnabled(true);
+        button->setText(tr("Translate"));
     }
-    else if (isGemini)
+
+    const bool showError = !error.isEmpty() && !translationErrorShown;
+    if (showError)
     {
-        translated = translator.translate_by_gemini(sourceText, sourceLanguage, targetLanguage, apiToken);
+        translationErrorShown = true;
     }
-    else if (isGoogle)
+    if (error.isEmpty() && !translated.isEmpty() && row < ui->subtitleTable->rowCount())
     {
-        translated = translator.translate_by_google_translate(sourceText, sourceLanguage, targetLanguage, apiToken);
+        auto *targetItem = ui->subtitleTable->item(row, 1);
+        if (!targetItem)
+        {
+            targetItem = new QTableWidgetItem();
+            ui->subtitleTable->setItem(row, 1, targetItem);
+        }
+        targetItem->setText(translated);
+        SRT_LOG_DEBUG("translator", "row {} translated ({} chars)", row + 1, translated.size());
     }
+    emit translationFinished(row);
 
-    if (translated.isEmpty())
+    if (!pendingRows.isEmpty())
     {
-        return;
+        startTranslation(pendingRows.takeFirst(), batchRequest, Executor::Priority::Normal);
     }
-
-    auto *targetItem = ui->subtitleTable->item(row, 1);
-    if (!targetItem)
+    else if (translationsInFlight == 0)
     {
-        targetItem = new QTableWidgetItem();
-        ui->subtitleTable->setItem(row, 1, targetItem);
+        translationErrorShown = false;
+        ui->btnTranslateAll->setEnabled(true);
+        emit batchFinished();
     }
-    targetItem->setText(translated);
 
-    qDebug() << "sourceLanguage:" << ui->srcLang->text().trimmed();
-    qDebug() << "targetLanguage:" << ui->targetLang->text().trimmed();
-    qDebug() << "sourceText:" << sourceText;
-    qDebug() << "translated:" << translated;
+    // Shown last: the dialog spins an event loop that delivers the other
+    // rows' results, and this row's bookkeeping must be done by then.
+    if (showError)
+    {
+        QMessageBox::warning(this, tr("Translation failed"), error);
+    }
 }
 
 void TranslatorWindow::refreshModelList(const QString &service)
 {
+    SRT_TRACE_SCOPE("TranslatorWindow::refreshModelList");
     ui->modelList->clear();
 
     // const bool isGoogleTranslate = service.compare(QStringLiteral("Google Translate"), Qt::CaseInsensitive) == 0;
@@ -490,101 +575,81 @@ void TranslatorWindow::refreshModelList(const QString &service)
         return;
     }
 
-    QStringList models;
+    ProviderCatalog::Fetcher fetcher;
     if (service.compare(QStringLiteral("Github Model"), Qt::CaseInsensitive) == 0)
     {
-        models = fetchGithubModels(token);
+        fetcher = [token]() { return fetchGithubModels(token); };
     }
     else if (service.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0)
     {
-        models = fetchOpenAIModels(token);
+        fetcher = [token]() { return fetchOpenAIModels(token); };
     }
     // else if (service.compare(QStringLiteral("Gemini"), Qt::CaseInsensitive) == 0)
     // {
-    //     models = fetchGeminiModels(token);
+    //     fetcher = [token]() { return fetchGeminiModels(token); };
     // }
 
-    if (!models.isEmpty())
-    {
-        ui->modelList->addItems(models);
-    }
-}
-
-void TranslatorWindow::translateAll()
-{
-    if (!validateLanguageInputs())
+    if (!fetcher)
     {
         return;
     }
 
-    const QString provider = settings.value("ai/lang/provider").toString().trimmed();
-    if (provider.isEmpty())
+    // Show the cached list straight away; a stale one is refreshed in the
+    // background and swapped in by the catalog's updated() signal.
+    ProviderCatalog &catalog = ProviderCatalog::instance();
+    modelCatalogKey = ProviderCatalog::make_key(service, QStringLiteral("models"), token);
+    const QStringList models = catalog.cached(modelCatalogKey);
+    if (!models.isEmpty())
     {
-        QMessageBox::warning(this, tr("Missing provider"), tr("Please select an AI provider before translating."));
-        return;
+        ui->modelList->addItems(models);
     }
+    catalog.refresh(modelCatalogKey, fetcher);
+}
 
-    const QString apiToken = settings.value("ai/lang/apiKey").toString().trimmed();
-    if (apiToken.isEmpty())
+void TranslatorWindow::applyCatalogUpdate(const QString &key, const QStringList &models)
+{
+    if (key != modelCatalogKey)
     {
-        QMessageBox::warning(this, tr("Missing API key"), tr("Please configure an API key before translating."));
         return;
     }
 
-    const bool isOpenAI = provider.compare(QStringLiteral("OpenAI"), Qt::CaseInsensitive) == 0;
-    const bool isGithub = provider.compare(QStringLiteral("Github Model"), Qt::CaseInsensitive) == 0;
-    const bool isGemini = provider.compare(QStringLiteral("Gemini"), Qt::CaseInsensitive) == 0;
-    const bool isGoogle = provider.compare(QStringLiteral("Google Translate"), Qt::CaseInsensitive) == 0;
+    const QString current = ui->modelList->currentText();
+    const QSignalBlocker blocker(ui->modelList);
+    ui->modelList->clear();
+    ui->modelList->addItems(models);
+    const int index = ui->modelList->findText(current);
+    ui->modelList->setCurrentIndex(index == -1 ? 0 : index);
+}
 
-    if (!isOpenAI && !isGithub && !isGemini && !isGoogle)
+void TranslatorWindow::translateAll()
+{
+    SRT_TRACE_SCOPE("TranslatorWindow::translateAll");
+    if (!prepareTranslation(&batchRequest))
     {
-        QMessageBox::warning(this, tr("Unsupported provider"), tr("The selected provider is not supported for translation."));
         return;
     }
 
-    const std::string sourceLanguage = ui->srcLang->text().trimmed().toStdString();
-    const std::string targetLanguage = ui->targetLang->text().trimmed().toStdString();
-
+    pendingRows.clear();
     const int rowCount = ui->subtitleTable->rowCount();
     for (int row = 0; row < rowCount; ++row)
     {
         const QTableWidgetItem *sourceItem = ui->subtitleTable->item(row, 0);
-        const QString sourceText = sourceItem ? sourceItem->text() : QString();
-        if (sourceText.trimmed().isEmpty())
-        {
-            continue;
-        }
-
-        QString translated;
-        if (isOpenAI)
-        {
-            translated = translator.translate_by_openai(sourceText, sourceLanguage, targetLanguage, apiToken);
-        }
-        else if (isGithub)
-        {
-            translated = translator.translate_by_github_model(sourceText, sourceLanguage, targetLanguage, apiToken);
-        }
-        else if (isGemini)
-        {
-            translated = translator.translate_by_gemini(sourceText, sourceLanguage, targetLanguage, apiToken);
-        }
-        else if (isGoogle)
-        {
-            translated = translator.translate_by_google_translate(sourceText, sourceLanguage, targetLanguage, apiToken);
-        }
-
-        if (translated.isEmpty())
+        if (sourceItem && !sourceItem->text().trimmed().isEmpty())
         {
-            continue;
+            pendingRows.append(row);
         }
+    }
+    if (pendingRows.isEmpty())
+    {
+        return;
+    }
 
-        auto *targetItem = ui->subtitleTable->item(row, 1);
-        if (!targetItem)
-        {
-            targetItem = new QTableWidgetItem();
-            ui->subtitleTable->setItem(row, 1, targetItem);
-        }
-        targetItem->setText(translated);
+    // Only a few rows are in flight at once, to stay inside provider rate
+    // limits; each completion starts the next pending row.
+    ui->btnTranslateAll->setEnabled(false);
+    while (!pendingRows.isEmpty() && translationsInFlight < kMaxConcurrentTranslations)
+    {
+        startTranslation(pendingRows.takeFirst(), batchRequest, Executor::Priority::Normal);
     }
 }
 
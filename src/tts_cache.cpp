@@ -0,0 +1,368 @@
+#include "tts_cache.h"
+
+#include "settings.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+constexpr int kIndexVersion = 1;
+constexpr qint64 kDefaultMaxSizeMb = 2048;
+// A batch stores one clip per cue; rewriting the whole index each time would
+// cost O(n^2) over the batch, so stores only flush it this often. save()
+// writes whatever is left.
+constexpr qint64 kIndexFlushMs = 5000;
+
+std::filesystem::path toFsPath(const QString &path)
+{
+#ifdef _WIN32
+    return std::filesystem::path(path.toStdWString());
+#else
+    return std::filesystem::path(QFile::encodeName(path).toStdString());
+#endif
+}
+
+QByteArray hashFileContents(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file))
+    {
+        return {};
+    }
+    return hash.result().toHex();
+}
+
+// Hard links make a hit free; copying is the fallback for filesystems (or
+// cache locations on another volume) that cannot link.
+bool linkOrCopy(const QString &sourcePath, const QString &destinationPath)
+{
+    const QFileInfo destinationInfo(destinationPath);
+    QDir destinationDir = destinationInfo.dir();
+    if (!destinationDir.exists() && !destinationDir.mkpath(QStringLiteral(".")))
+    {
+        return false;
+    }
+
+    if (QFile::exists(destinationPath))
+    {
+        QFile::remove(destinationPath);
+    }
+
+    std::error_code error;
+    std::filesystem::create_hard_link(toFsPath(sourcePath), toFsPath(destinationPath), error);
+    if (!error)
+    {
+        return true;
+    }
+
+    return QFile::copy(sourcePath, destinationPath);
+}
+
+QString indexPath(const QString &directory)
+{
+    return QDir(directory).filePath(QStringLiteral("index.json"));
+}
+} // namespace
+
+QString TtsCache::Key::digest() const
+{
+    // QJsonObject keeps its keys sorted, which gives a canonical encoding.
+    const QJsonObject canonical{
+        {QStringLiteral("text"), text.trimmed()},
+        {QStringLiteral("provider"), provider.trimmed().toLower()},
+        {QStringLiteral("voice"), voice.trimmed()},
+        {QStringLiteral("model"), model.trimmed()},
+        {QStringLiteral("format"), outputFormat.trimmed().toLower()},
+        {QStringLiteral("speed"), speed},
+        {QStringLiteral("voice_settings"), voiceSettings}};
+
+    const QByteArray bytes = QJsonDocument(canonical).toJson(QJsonDocument::Compact);
+    return QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex());
+}
+
+TtsCache &TtsCache::instance()
+{
+    static TtsCache cache = []() {
+        Settings settings;
+        const qint64 maxMb = settings.value(QStringLiteral("tts/cache/max_size_mb"), kDefaultMaxSizeMb).toLongLong();
+        const QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        return TtsCache(QDir(root).filePath(QStringLiteral("tts")), std::max<qint64>(maxMb, 0) * 1024 * 1024);
+    }();
+    return cache;
+}
+
+TtsCache::TtsCache(const QString &directory, qint64 maxBytes)
+    : directory_(directory), maxBytes_(maxBytes)
+{
+    QDir().mkpath(directory_);
+    load();
+    sinceSave_.start();
+}
+
+TtsCache::~TtsCache()
+{
+    save();
+}
+
+QString TtsCache::directory() const
+{
+    return directory_;
+}
+
+void TtsCache::set_max_size(qint64 maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_ = maxBytes;
+    evict_to_fit();
+}
+
+bool TtsCache::fetch(const Key &key, const QString &destinationPath, double *durationSeconds)
+{
+    const QString digest = key.digest();
+
+    // Hashing the clip and linking it run without the lock, so concurrent
+    // conversions do not queue behind each other's disk reads. A clip
+    // dropped meanwhile just fails the link and counts as a miss.
+    Record record;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = records_.constFind(digest);
+        if (it == records_.constEnd())
+        {
+            return false;
+        }
+        record = it.value();
+    }
+
+    const bool valid = verify(record);
+    const bool linked = valid && linkOrCopy(QDir(directory_).filePath(record.fileName), destinationPath);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = records_.find(digest);
+    // Only touch the entry if it still describes the clip that was checked.
+    const bool current = it != records_.end() && it->contentHash == record.contentHash;
+    if (!valid)
+    {
+        if (current)
+        {
+            drop(digest);
+        }
+        return false;
+    }
+    if (!linked)
+    {
+        return false;
+    }
+
+    if (current)
+    {
+        it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+        dirty_ = true;
+    }
+    if (durationSeconds)
+    {
+        *durationSeconds = record.durationSeconds;
+    }
+    return true;
+}
+
+bool TtsCache::store(const Key &key, const QString &sourcePath, double durationSeconds)
+{
+    const QFileInfo sourceInfo(sourcePath);
+    if (!sourceInfo.exists() || sourceInfo.size() <= 0)
+    {
+        return false;
+    }
+
+    const QString digest = key.digest();
+    QString suffix = sourceInfo.suffix().toLower();
+    const QString fileName = suffix.isEmpty() ? digest : QStringLiteral("%1.%2").arg(digest, suffix);
+
+    // The cached copy is a link to (or a copy of) the same bytes, so the
+    // hash is taken from the source before the lock.
+    const QByteArray contentHash = hashFileContents(sourcePath);
+    if (contentHash.isEmpty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (records_.contains(digest))
+    {
+        drop(digest);
+    }
+
+    const QString cachedPath = QDir(directory_).filePath(fileName);
+    if (!linkOrCopy(sourcePath, cachedPath))
+    {
+        return false;
+    }
+
+    Record record;
+    record.fileName = fileName;
+    record.size = QFileInfo(cachedPath).size();
+    record.contentHash = contentHash;
+    record.durationSeconds = durationSeconds;
+    record.lastUsed = QDateTime::currentMSecsSinceEpoch();
+
+    records_.insert(digest, record);
+    totalBytes_ += record.size;
+    dirty_ = true;
+
+    evict_to_fit();
+    if (sinceSave_.elapsed() >= kIndexFlushMs)
+    {
+        save_locked();
+    }
+    return true;
+}
+
+bool TtsCache::verify(const Record &record) const
+{
+    const QString cachedPath = QDir(directory_).filePath(record.fileName);
+    const QFileInfo info(cachedPath);
+    if (!info.exists() || info.size() != record.size)
+    {
+        return false;
+    }
+
+    return hashFileContents(cachedPath) == record.contentHash;
+}
+
+void TtsCache::drop(const QString &digest)
+{
+    auto it = records_.find(digest);
+    if (it == records_.end())
+    {
+        return;
+    }
+
+    QFile::remove(QDir(directory_).filePath(it->fileName));
+    totalBytes_ -= it->size;
+    records_.erase(it);
+    dirty_ = true;
+}
+
+void TtsCache::evict_to_fit()
+{
+    if (maxBytes_ <= 0 || totalBytes_ <= maxBytes_)
+    {
+        return;
+    }
+
+    std::vector<std::pair<qint64, QString>> byAge;
+    byAge.reserve(static_cast<size_t>(records_.size()));
+    for (auto it = records_.cbegin(); it != records_.cend(); ++it)
+    {
+        byAge.emplace_back(it->lastUsed, it.key());
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto &entry : byAge)
+    {
+        if (totalBytes_ <= maxBytes_)
+        {
+            break;
+        }
+        drop(entry.second);
+    }
+}
+
+void TtsCache::load()
+{
+    QFile file(indexPath(directory_));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    const QJsonObject root = doc.object();
+    if (root.value(QStringLiteral("version")).toInt() != kIndexVersion)
+    {
+        return;
+    }
+
+    const QJsonObject entries = root.value(QStringLiteral("entries")).toObject();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    {
+        const QJsonObject obj = it.value().toObject();
+        Record record;
+        record.fileName = obj.value(QStringLiteral("file")).toString();
+        record.size = static_cast<qint64>(obj.value(QStringLiteral("size")).toDouble());
+        record.contentHash = obj.value(QStringLiteral("sha256")).toString().toLatin1();
+        record.durationSeconds = obj.value(QStringLiteral("duration")).toDouble();
+        record.lastUsed = static_cast<qint64>(obj.value(QStringLiteral("last_used")).toDouble());
+
+        // Cheap existence/size check on load; content hashes are verified on use.
+        const QFileInfo info(QDir(directory_).filePath(record.fileName));
+        if (record.fileName.isEmpty() || !info.exists() || info.size() != record.size)
+        {
+            dirty_ = true;
+            continue;
+        }
+
+        records_.insert(it.key(), record);
+        totalBytes_ += record.size;
+    }
+
+    evict_to_fit();
+}
+
+void TtsCache::save()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    save_locked();
+}
+
+void TtsCache::save_locked()
+{
+    if (!dirty_ || directory_.isEmpty())
+    {
+        return;
+    }
+
+    QJsonObject entries;
+    for (auto it = records_.cbegin(); it != records_.cend(); ++it)
+    {
+        entries.insert(it.key(),
+                       QJsonObject{{QStringLiteral("file"), it->fileName},
+                                   {QStringLiteral("size"), static_cast<double>(it->size)},
+                                   {QStringLiteral("sha256"), QString::fromLatin1(it->contentHash)},
+                                   {QStringLiteral("duration"), it->durationSeconds},
+                                   {QStringLiteral("last_used"), static_cast<double>(it->lastUsed)}});
+    }
+
+    const QJsonObject root{{QStringLiteral("version"), kIndexVersion},
+                           {QStringLiteral("entries"), entries}};
+
+    QSaveFile file(indexPath(directory_));
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (file.commit())
+    {
+        dirty_ = false;
+    }
+    sinceSave_.restart();
+}
@@ -0,0 +1,189 @@
+#include "ui_watchdog.h"
+
+#include "logger.h"
+#include "trace.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+constexpr auto kMonitorInterval = std::chrono::milliseconds(10);
+constexpr std::int64_t kNsPerMs = 1000000;
+
+double lagMs(std::int64_t micros)
+{
+    return static_cast<double>(micros) / 1000.0;
+}
+} // namespace
+
+UiWatchdog::UiWatchdog(int intervalMs, int stallThresholdMs, QObject *parent)
+    : QObject(parent),
+      intervalMs_(std::max(intervalMs, 1)),
+      stallThresholdMs_(std::max(stallThresholdMs, intervalMs_)),
+      guiScope_(Trace::active_scope_slot())
+{
+    session_.start();
+    const std::int64_t now = Trace::now_ns();
+    lastBeatNs_.store(now, std::memory_order_relaxed);
+    expectedBeatNs_ = now + intervalMs_ * kNsPerMs;
+
+    timer_.setTimerType(Qt::PreciseTimer);
+    connect(&timer_, &QTimer::timeout, this, &UiWatchdog::beat);
+    timer_.start(intervalMs_);
+
+    monitor_ = std::thread(&UiWatchdog::monitor_loop, this);
+}
+
+UiWatchdog::~UiWatchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(monitorMutex_);
+        stopping_ = true;
+    }
+    monitorWake_.notify_one();
+    monitor_.join();
+}
+
+void UiWatchdog::beat()
+{
+    const std::int64_t now = Trace::now_ns();
+    const std::int64_t lateNs = std::max<std::int64_t>(now - expectedBeatNs_, 0);
+    lag_.record(lateNs / 1000);
+    lastBeatNs_.store(now, std::memory_order_relaxed);
+    expectedBeatNs_ = now + intervalMs_ * kNsPerMs;
+
+    // The monitor's sample belongs to this stall; drop it either way so a
+    // stale scope never leaks into the next one.
+    const char *scope = stallScope_.exchange(nullptr, std::memory_order_relaxed);
+    const qint64 lateMs = lateNs / kNsPerMs;
+    if (lateMs < stallThresholdMs_)
+    {
+        return;
+    }
+
+    Stall stall;
+    stall.startedAtMs = QDateTime::currentMSecsSinceEpoch() - lateMs;
+    stall.durationMs = lateMs;
+    stall.scope = scope ? QString::fromLatin1(scope) : tr("(outside traced scopes)");
+
+    ++stallCount_;
+    stalledMs_ += lateMs;
+    if (stalls_.size() < kMaxStallsKept)
+    {
+        stalls_.append(stall);
+    }
+    SRT_LOG_WARN("watchdog", "event loop stalled for {} ms in {}", lateMs, stall.scope);
+}
+
+void UiWatchdog::monitor_loop()
+{
+    const std::int64_t stallNs = (intervalMs_ + stallThresholdMs_) * kNsPerMs;
+
+    std::unique_lock<std::mutex> lock(monitorMutex_);
+    while (!stopping_)
+    {
+        monitorWake_.wait_for(lock, kMonitorInterval);
+
+        const std::int64_t sinceBeat = Trace::now_ns() - lastBeatNs_.load(std::memory_order_relaxed);
+        if (sinceBeat < stallNs)
+        {
+            continue;
+        }
+
+        // Keep the first scope seen; the loop is blocked, so it rarely moves.
+        const char *scope = guiScope_->load(std::memory_order_relaxed);
+        const char *expected = nullptr;
+        if (scope)
+        {
+            stallScope_.compare_exchange_strong(expected, scope, std::memory_order_relaxed);
+        }
+    }
+}
+
+QByteArray UiWatchdog::report_json() const
+{
+    struct ScopeTotals
+    {
+        qint64 count = 0;
+        qint64 totalMs = 0;
+        qint64 maxMs = 0;
+    };
+
+    QHash<QString, ScopeTotals> byScope;
+    QJsonArray stallList;
+    qint64 longestMs = 0;
+    for (const Stall &stall : stalls_)
+    {
+        ScopeTotals &totals = byScope[stall.scope];
+        ++totals.count;
+        totals.totalMs += stall.durationMs;
+        totals.maxMs = std::max(totals.maxMs, stall.durationMs);
+        longestMs = std::max(longestMs, stall.durationMs);
+
+        stallList.append(QJsonObject{
+            {QStringLiteral("startedAt"), QDateTime::fromMSecsSinceEpoch(stall.startedAtMs).toString(Qt::ISODateWithMs)},
+            {QStringLiteral("durationMs"), stall.durationMs},
+            {QStringLiteral("scope"), stall.scope}});
+    }
+
+    QVector<QPair<QString, ScopeTotals>> scopes;
+    for (auto it = byScope.constBegin(); it != byScope.constEnd(); ++it)
+    {
+        scopes.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(scopes.begin(), scopes.end(), [](const auto &a, const auto &b) {
+        return a.second.totalMs > b.second.totalMs;
+    });
+
+    QJsonArray scopeList;
+    for (const auto &scope : scopes)
+    {
+        scopeList.append(QJsonObject{{QStringLiteral("scope"), scope.first},
+                                     {QStringLiteral("count"), scope.second.count},
+                                     {QStringLiteral("totalMs"), scope.second.totalMs},
+                                     {QStringLiteral("maxMs"), scope.second.maxMs}});
+    }
+
+    const qint64 sessionMs = std::max<qint64>(session_.elapsed(), 1);
+    const QJsonObject root{
+        {QStringLiteral("sessionSeconds"), static_cast<double>(sessionMs) / 1000.0},
+        {QStringLiteral("intervalMs"), intervalMs_},
+        {QStringLiteral("stallThresholdMs"), stallThresholdMs_},
+        {QStringLiteral("beats"), static_cast<qint64>(lag_.count())},
+        {QStringLiteral("lagMs"), QJsonObject{{QStringLiteral("p50"), lagMs(lag_.value_at_percentile(50.0))},
+                                              {QStringLiteral("p90"), lagMs(lag_.value_at_percentile(90.0))},
+                                              {QStringLiteral("p99"), lagMs(lag_.value_at_percentile(99.0))},
+                                              {QStringLiteral("max"), lagMs(lag_.max())}}},
+        {QStringLiteral("stallCount"), stallCount_},
+        {QStringLiteral("stalledMs"), stalledMs_},
+        {QStringLiteral("stalledPercent"), 100.0 * static_cast<double>(stalledMs_) / static_cast<double>(sessionMs)},
+        {QStringLiteral("longestStallMs"), longestMs},
+        {QStringLiteral("byScope"), scopeList},
+        {QStringLiteral("stalls"), stallList}};
+
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+bool UiWatchdog::write_report(const QString &path, QString *errorMessage) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(report_json()) < 0 ||
+        !file.commit())
+    {
+        if (errorMessage)
+        {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,392 @@
+#include "wav_file.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+constexpr int kHeaderSize = 44;
+constexpr quint16 kFormatPcm = 1;
+constexpr quint16 kFormatFloat = 3;
+constexpr quint16 kFormatExtensible = 0xFFFE;
+constexpr qint64 kReadBlockFrames = 16384;
+
+quint32 readLittleEndian32(const unsigned char *p)
+{
+    return (static_cast<quint32>(p[3]) << 24) | (static_cast<quint32>(p[2]) << 16) |
+           (static_cast<quint32>(p[1]) << 8) | static_cast<quint32>(p[0]);
+}
+
+quint16 readLittleEndian16(const unsigned char *p)
+{
+    return static_cast<quint16>(p[0] | (p[1] << 8));
+}
+
+void putLittleEndian32(char *p, quint32 value)
+{
+    p[0] = static_cast<char>(value & 0xFF);
+    p[1] = static_cast<char>((value >> 8) & 0xFF);
+    p[2] = static_cast<char>((value >> 16) & 0xFF);
+    p[3] = static_cast<char>((value >> 24) & 0xFF);
+}
+
+void putLittleEndian16(char *p, quint16 value)
+{
+    p[0] = static_cast<char>(value & 0xFF);
+    p[1] = static_cast<char>((value >> 8) & 0xFF);
+}
+
+qint16 floatToPcm16(float sample)
+{
+    const float scaled = std::round(sample * 32768.0f);
+    return static_cast<qint16>(std::clamp(scaled, -32768.0f, 32767.0f));
+}
+} // namespace
+
+bool WavReader::open(const QString &path)
+{
+    close();
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    unsigned char riff[12];
+    if (file_.read(reinterpret_cast<char *>(riff), 12) != 12 || std::memcmp(riff, "RIFF", 4) != 0 ||
+        std::memcmp(riff + 8, "WAVE", 4) != 0)
+    {
+        close();
+        return false;
+    }
+
+    bool haveFormat = false;
+    unsigned char chunkHeader[8];
+    while (file_.read(reinterpret_cast<char *>(chunkHeader), 8) == 8)
+    {
+        const qint64 chunkSize = readLittleEndian32(chunkHeader + 4);
+        const qint64 body = file_.pos();
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            unsigned char fmt[40] = {};
+            const qint64 toRead = std::min<qint64>(chunkSize, sizeof(fmt));
+            if (toRead < 16 || file_.read(reinterpret_cast<char *>(fmt), toRead) != toRead)
+            {
+                break;
+            }
+
+            quint16 tag = readLittleEndian16(fmt);
+            if (tag == kFormatExtensible && toRead >= 26)
+            {
+                tag = readLittleEndian16(fmt + 24);
+            }
+
+            format_.channels = readLittleEndian16(fmt + 2);
+            format_.sampleRate = static_cast<int>(readLittleEndian32(fmt + 4));
+            format_.bitsPerSample = readLittleEndian16(fmt + 14);
+            format_.isFloat = tag == kFormatFloat;
+            haveFormat = (tag == kFormatPcm || tag == kFormatFloat) && format_.channels > 0 &&
+                         format_.sampleRate > 0 &&
+                         (format_.isFloat ? format_.bitsPerSample == 32
+                                          : (format_.bitsPerSample == 8 || format_.bitsPerSample == 16 ||
+                                             format_.bitsPerSample == 24 || format_.bitsPerSample == 32));
+        }
+        else if (std::memcmp(chunkHeader, "data", 4) == 0)
+        {
+            if (!haveFormat)
+            {
+                break;
+            }
+
+            dataOffset_ = body;
+            // Streaming writers may leave the size unset; use what is on disk.
+            const qint64 available = file_.size() - body;
+            dataBytes_ = (chunkSize == 0 || chunkSize > available) ? available : chunkSize;
+            dataBytes_ -= dataBytes_ % format_.bytes_per_frame();
+            position_ = 0;
+            return true;
+        }
+
+        if (!file_.seek(body + chunkSize + (chunkSize & 1)))
+        {
+            break;
+        }
+    }
+
+    close();
+    return false;
+}
+
+void WavReader::close()
+{
+    if (file_.isOpen())
+    {
+        file_.close();
+    }
+    format_ = WavFormat();
+    dataOffset_ = 0;
+    dataBytes_ = 0;
+    position_ = 0;
+}
+
+qint64 WavReader::frame_count() const
+{
+    const int frameBytes = format_.bytes_per_frame();
+    return frameBytes > 0 ? dataBytes_ / frameBytes : 0;
+}
+
+bool WavReader::seek_frame(qint64 frame)
+{
+    const qint64 offset = std::clamp<qint64>(frame, 0, frame_count()) * format_.bytes_per_frame();
+    if (!file_.seek(dataOffset_ + offset))
+    {
+        return false;
+    }
+    position_ = offset;
+    return true;
+}
+
+qint64 WavReader::read(float *out, qint64 maxFrames)
+{
+    const int frameBytes = format_.bytes_per_frame();
+    if (!file_.isOpen() || frameBytes <= 0 || maxFrames <= 0)
+    {
+        return 0;
+    }
+
+    const qint64 remainingFrames = (dataBytes_ - position_) / frameBytes;
+    const qint64 frames = std::min(maxFrames, remainingFrames);
+    if (frames <= 0)
+    {
+        return 0;
+    }
+
+    const qint64 bytes = frames * frameBytes;
+    scratch_.resize(static_cast<size_t>(bytes));
+    const qint64 got = file_.read(scratch_.data(), bytes);
+    if (got <= 0)
+    {
+        return 0;
+    }
+
+    const qint64 framesRead = got / frameBytes;
+    position_ += framesRead * frameBytes;
+
+    const qint64 samples = framesRead * format_.channels;
+    const auto *raw = reinterpret_cast<const unsigned char *>(scratch_.data());
+    if (format_.isFloat)
+    {
+        std::memcpy(out, raw, static_cast<size_t>(samples) * sizeof(float));
+    }
+    else if (format_.bitsPerSample == 16)
+    {
+        for (qint64 i = 0; i < samples; ++i)
+        {
+            const qint16 value = static_cast<qint16>(raw[2 * i] | (raw[2 * i + 1] << 8));
+            out[i] = static_cast<float>(value) * (1.0f / 32768.0f);
+        }
+    }
+    else if (format_.bitsPerSample == 24)
+    {
+        for (qint64 i = 0; i < samples; ++i)
+        {
+            const unsigned char *p = raw + 3 * i;
+            const qint32 value = static_cast<qint32>((static_cast<quint32>(p[0]) << 8) |
+                                                     (static_cast<quint32>(p[1]) << 16) |
+                                                     (static_cast<quint32>(p[2]) << 24)) >> 8;
+            out[i] = static_cast<float>(value) * (1.0f / 8388608.0f);
+        }
+    }
+    else if (format_.bitsPerSample == 32)
+    {
+        for (qint64 i = 0; i < samples; ++i)
+        {
+            const qint32 value = static_cast<qint32>(readLittleEndian32(raw + 4 * i));
+            out[i] = static_cast<float>(value) * (1.0f / 2147483648.0f);
+        }
+    }
+    else
+    {
+        for (qint64 i = 0; i < samples; ++i)
+        {
+            out[i] = (static_cast<float>(raw[i]) - 128.0f) * (1.0f / 128.0f);
+        }
+    }
+
+    return framesRead;
+}
+
+bool WavWriter::open(const QString &path, const WavFormat &format)
+{
+    format_ = format;
+    format_.bitsPerSample = 16;
+    format_.isFloat = false;
+    framesWritten_ = 0;
+
+    if (format_.channels <= 0 || format_.sampleRate <= 0)
+    {
+        return false;
+    }
+
+    QDir dir = QFileInfo(path).dir();
+    if (!dir.exists() && !dir.mkpath(QStringLiteral(".")))
+    {
+        return false;
+    }
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    // Sizes are patched in commit() once the data length is known.
+    return write_header(0);
+}
+
+bool WavWriter::write_header(qint64 dataBytes)
+{
+    const QByteArray header = WavFile::pcm16_header(format_, dataBytes);
+    return file_.write(header) == header.size();
+}
+
+bool WavWriter::write(const float *samples, qint64 frameCount)
+{
+    if (frameCount <= 0)
+    {
+        return true;
+    }
+
+    const qint64 sampleCount = frameCount * format_.channels;
+    scratch_.resize(static_cast<size_t>(sampleCount));
+    for (qint64 i = 0; i < sampleCount; ++i)
+    {
+        scratch_[static_cast<size_t>(i)] = qToLittleEndian(floatToPcm16(samples[i]));
+    }
+
+    const qint64 bytes = sampleCount * static_cast<qint64>(sizeof(qint16));
+    if (file_.write(reinterpret_cast<const char *>(scratch_.data()), bytes) != bytes)
+    {
+        return false;
+    }
+
+    framesWritten_ += frameCount;
+    return true;
+}
+
+bool WavWriter::write_silence(qint64 frameCount)
+{
+    if (frameCount <= 0)
+    {
+        return true;
+    }
+
+    const qint64 blockFrames = std::min(frameCount, kReadBlockFrames);
+    const std::vector<char> zeros(static_cast<size_t>(blockFrames * format_.bytes_per_frame()), 0);
+    qint64 remaining = frameCount;
+    while (remaining > 0)
+    {
+        const qint64 frames = std::min(remaining, blockFrames);
+        const qint64 bytes = frames * format_.bytes_per_frame();
+        if (file_.write(zeros.data(), bytes) != bytes)
+        {
+            return false;
+        }
+        remaining -= frames;
+    }
+
+    framesWritten_ += frameCount;
+    return true;
+}
+
+bool WavWriter::commit()
+{
+    const qint64 dataBytes = framesWritten_ * format_.bytes_per_frame();
+    if (!file_.seek(0) || !write_header(dataBytes))
+    {
+        file_.cancelWriting();
+        return false;
+    }
+    return file_.commit();
+}
+
+void WavWriter::cancel()
+{
+    // An uncommitted QSaveFile discards its temporary file.
+    file_.cancelWriting();
+}
+
+bool WavFile::read(const QString &path, WavFormat *format, std::vector<float> *samples)
+{
+    WavReader reader;
+    if (!reader.open(path) || !samples)
+    {
+        return false;
+    }
+
+    const qint64 frames = reader.frame_count();
+    samples->resize(static_cast<size_t>(frames * reader.format().channels));
+    const qint64 got = reader.read(samples->data(), frames);
+    samples->resize(static_cast<size_t>(got * reader.format().channels));
+    if (format)
+    {
+        *format = reader.format();
+    }
+    return got == frames;
+}
+
+bool WavFile::write(const QString &path, const WavFormat &format, const std::vector<float> &samples)
+{
+    WavWriter writer;
+    if (!writer.open(path, format))
+    {
+        return false;
+    }
+
+    const qint64 frames = static_cast<qint64>(samples.size()) / std::max(1, format.channels);
+    if (!writer.write(samples.data(), frames))
+    {
+        writer.cancel();
+        return false;
+    }
+    return writer.commit();
+}
+
+bool WavFile::is_wav(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const QByteArray head = file.read(12);
+    return head.size() == 12 && head.startsWith("RIFF") && head.mid(8, 4) == "WAVE";
+}
+
+QByteArray WavFile::pcm16_header(const WavFormat &format, qint64 dataBytes)
+{
+    QByteArray header(kHeaderSize, '\0');
+    char *p = header.data();
+    const int frameBytes = format.channels * 2;
+    std::memcpy(p, "RIFF", 4);
+    putLittleEndian32(p + 4, static_cast<quint32>(std::min<qint64>(36 + dataBytes, 0xFFFFFFFFLL)));
+    std::memcpy(p + 8, "WAVE", 4);
+    std::memcpy(p + 12, "fmt ", 4);
+    putLittleEndian32(p + 16, 16);
+    putLittleEndian16(p + 20, kFormatPcm);
+    putLittleEndian16(p + 22, static_cast<quint16>(format.channels));
+    putLittleEndian32(p + 24, static_cast<quint32>(format.sampleRate));
+    putLittleEndian32(p + 28, static_cast<quint32>(format.sampleRate * frameBytes));
+    putLittleEndian16(p + 32, static_cast<quint16>(frameBytes));
+    putLittleEndian16(p + 34, 16);
+    std::memcpy(p + 36, "data", 4);
+    putLittleEndian32(p + 40, static_cast<quint32>(std::min<qint64>(dataBytes, 0xFFFFFFFFLL)));
+    return header;
+}
@@ -0,0 +1,99 @@
+#include "text_index.h"
+
+#include <QtTest>
+
+// The index narrows a regex search to rows holding the pattern's literals,
+// so a literal taken from inside an escape loses matches silently.
+class TextIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void required_literals_data();
+    void required_literals();
+    void escapes_do_not_lose_matches_data();
+    void escapes_do_not_lose_matches();
+};
+
+void TextIndexTest::required_literals_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QStringList>("literals");
+
+    QTest::newRow("plain") << QStringLiteral("hello") << QStringList{QStringLiteral("hello")};
+    QTest::newRow("wildcard") << QStringLiteral("hello.*world") << QStringList{QStringLiteral("hello"), QStringLiteral("world")};
+    QTest::newRow("optional") << QStringLiteral("colou?r") << QStringList{QStringLiteral("colo")};
+    QTest::newRow("escaped punctuation") << QStringLiteral("\\.txt") << QStringList{QStringLiteral(".txt")};
+    QTest::newRow("class escape") << QStringLiteral("abc\\d+def") << QStringList{QStringLiteral("abc"), QStringLiteral("def")};
+    QTest::newRow("alternation") << QStringLiteral("abc|def") << QStringList();
+
+    QTest::newRow("property") << QStringLiteral("\\p{Lu}") << QStringList();
+    QTest::newRow("property between") << QStringLiteral("abc\\p{Lu}def") << QStringList{QStringLiteral("abc"), QStringLiteral("def")};
+    QTest::newRow("negated property") << QStringLiteral("\\P{Greek}xyz") << QStringList{QStringLiteral("xyz")};
+    QTest::newRow("short property") << QStringLiteral("\\pLxyz") << QStringList{QStringLiteral("xyz")};
+    QTest::newRow("hex") << QStringLiteral("\\x41BC") << QStringList();
+    QTest::newRow("hex then literal") << QStringLiteral("\\x41BCD") << QStringList{QStringLiteral("BCD")};
+    QTest::newRow("braced hex") << QStringLiteral("\\x{263a}smile") << QStringList{QStringLiteral("smile")};
+    QTest::newRow("named reference") << QStringLiteral("abc\\k<name>") << QStringList{QStringLiteral("abc")};
+    QTest::newRow("braced reference") << QStringLiteral("\\k{name}xyz") << QStringList{QStringLiteral("xyz")};
+    QTest::newRow("relative reference") << QStringLiteral("\\g{-1}xyz") << QStringList{QStringLiteral("xyz")};
+    QTest::newRow("numbered reference") << QStringLiteral("\\g12xyz") << QStringList{QStringLiteral("xyz")};
+    QTest::newRow("control") << QStringLiteral("\\cAxyz") << QStringList{QStringLiteral("xyz")};
+    QTest::newRow("octal") << QStringLiteral("\\0123abc") << QStringList{QStringLiteral("3abc")};
+    QTest::newRow("back reference") << QStringLiteral("\\12abc") << QStringList{QStringLiteral("abc")};
+    QTest::newRow("quoted") << QStringLiteral("\\Qa.b\\E") << QStringList();
+    QTest::newRow("escape in group") << QStringLiteral("(\\p{L})xyz") << QStringList{QStringLiteral("xyz")};
+}
+
+void TextIndexTest::required_literals()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QStringList, literals);
+
+    QCOMPARE(TextIndex::required_literals(pattern), literals);
+}
+
+void TextIndexTest::escapes_do_not_lose_matches_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("property") << QStringLiteral("\\p{Lu}orld");
+    QTest::newRow("hex") << QStringLiteral("\\x57orld");
+    QTest::newRow("braced hex") << QStringLiteral("\\x{57}orld");
+    QTest::newRow("control") << QStringLiteral("Hello\\cIWorld");
+    QTest::newRow("octal") << QStringLiteral("Hello\\011World");
+}
+
+void TextIndexTest::escapes_do_not_lose_matches()
+{
+    QFETCH(QString, pattern);
+
+    const QStringList texts{QStringLiteral("Hello World"),
+                            QStringLiteral("Hello\tWorld"),
+                            QStringLiteral("{Lu}orld and x57orld"),
+                            QStringLiteral("nothing here")};
+    TextIndex index;
+    index.reset(texts);
+
+    TextIndex::Query query;
+    query.pattern = pattern;
+    query.mode = TextIndex::Mode::Regex;
+    query.caseSensitive = true;
+    const TextIndex::Matcher matcher(query);
+    QVERIFY2(matcher.is_valid(), qPrintable(matcher.error()));
+
+    // Whatever the index returns must be exactly what a full scan finds.
+    QVector<int> expected;
+    for (int row = 0; row < texts.size(); ++row)
+    {
+        if (matcher.matches(texts.at(row)))
+        {
+            expected.push_back(row);
+        }
+    }
+    QVERIFY(!expected.isEmpty());
+    QCOMPARE(index.find(matcher), expected);
+}
+
+QTEST_GUILESS_MAIN(TextIndexTest)
+#include "text_index_test.moc"